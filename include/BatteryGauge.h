@@ -0,0 +1,85 @@
+#ifndef BATTERY_GAUGE_H
+#define BATTERY_GAUGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Config.h"
+
+/**
+ * Battery Gauge
+ *
+ * Decodes a MAX17048 register snapshot and filters the charge shown on the
+ * panel. PowerManager reads the registers from VCELL to CRATE in one I2C
+ * burst per wake; the gauge keeps tracking in hibernate during deep sleep,
+ * so the values are current without a reset or a settling delay.
+ *
+ * The gauge's percentage moves with the load and temperature by a percent
+ * or so between wakes. The shown percentage follows an exponentially
+ * weighted average kept across wakes, and only once the average has moved
+ * BATTERY_HYSTERESIS_PCT away from it, so the icon and the red low battery
+ * indicator do not flap around a threshold. A jump larger than
+ * BATTERY_RESEED_PCT (battery swapped or charged) restarts the average.
+ *
+ * make sim-battery decodes sample register bursts and replays two weeks
+ * of readings through the filter.
+ */
+class BatteryGauge {
+public:
+    /**
+     * Registers used (16-bit, MSB first)
+     */
+    enum Register : uint8_t {
+        REG_VCELL = 0x02,
+        REG_SOC = 0x04,
+        REG_VERSION = 0x08,
+        REG_HIBRT = 0x0a,
+        REG_CONFIG = 0x0c,
+        REG_CRATE = 0x16
+    };
+    
+    static const uint8_t FIRST_REGISTER = REG_VCELL;
+    static const size_t BURST_BYTES = 22;           // VCELL to CRATE
+    static const uint16_t CONFIG_SLEEP = 0x0080;    // Sleep mode: no measurements
+    static const uint16_t HIBRT_ALWAYS = 0xffff;    // Hibernate at any load (deep sleep)
+    static const uint16_t HIBRT_DEFAULT = 0x8030;   // Power-on value: hibernate only when idle
+    
+    /**
+     * Readings of one wake
+     */
+    struct Snapshot {
+        bool present;           // Gauge answered with a MAX17048/9 version
+        bool sleeping;          // Gauge left in sleep mode: readings are stale
+        float voltage;          // Cell voltage (V)
+        float rawPercent;       // Gauge state of charge, unfiltered
+        float chargeRate;       // %/h, negative while discharging
+        uint16_t config;        // CONFIG register
+    };
+    
+    /**
+     * Filter state, persisted by the caller across wakes
+     */
+    struct History {
+        float smoothed;         // Weighted average of the gauge percentage
+        uint8_t shown;          // Percentage shown, moves with hysteresis
+        uint8_t primed;         // Average holds at least one reading
+        uint16_t reserved;
+    };
+    
+    /**
+     * Decode a burst of BURST_BYTES bytes read from FIRST_REGISTER
+     */
+    static Snapshot decode(const uint8_t* burst);
+    
+    /**
+     * Start over without readings
+     */
+    static void reset(History& history);
+    
+    /**
+     * Add this wake's reading
+     * @return Percentage to show (0-100)
+     */
+    static int filter(History& history, float rawPercent);
+};
+
+#endif // BATTERY_GAUGE_H
@@ -7,18 +7,27 @@
 #define EPD_RST  16
 #define EPD_BUSY 13
 
-// Display Dimensions
-#define SCREEN_W 400
-#define SCREEN_H 300
+// Display panel is selected at build time, see DisplayPanel.h
 
 // Grid Layout
-#define GAUGE_COLS 3
-#define GAUGE_ROWS 2
+#define MAX_PLANTS        24  // Plants kept from the payload (rotated over pages)
+#define MAX_PAGE_CELLS    24  // Widgets on one page
+#define MIN_GAUGE_RADIUS  30  // Below this gauge radius, switch to compact bars
+#define BAR_COLUMNS       2   // Columns of compact bars
+#define BAR_ROW_HEIGHT    24  // Minimum height of a compact bar row
+
+// Dashboard Model
+#define PLANT_NAME_LEN    24  // Plant name buffer, longer names are truncated
+#define UPDATE_DATE_LEN   24  // Update date buffer
 
 // Thresholds
 #define MOISTURE_LOW_THRESHOLD 35  // Below this value is critical (RED)
 #define BATTERY_LOW_THRESHOLD  10  // Below this value battery icon turns RED
 
+// Refresh Policy
+#define FULL_REFRESH_INTERVAL  12  // Force a full refresh after this many partial refreshes (limits ghosting)
+#define FULL_REFRESH_AREA_PCT  60  // Dirty area above this share of the screen forces a full refresh
+
 // Deep Sleep Configuration
 #define DEEPSLEEP_DISABLE_PIN  4   // GPIO4 - When LOW, deep sleep is disabled (for config)
 
@@ -29,6 +38,100 @@
 #define MQTT_BUFFER_SIZE       1024
 #define WIFI_CONNECT_TIMEOUT   30000   // 30 seconds
 #define MQTT_CONNECT_TIMEOUT   10000   // 10 seconds
+#define MQTT_RETRY_MS          500     // Pause between MQTT connect attempts
+#define NET_POLL_MS            50      // Longest wait on the MQTT socket before servicing keepalives
+#define NET_TASK_STACK_SIZE    6144
+#define WAKE_TASK_STACK_SIZE   4096    // Wake pipeline jobs (sensor, display, WiFi bring-up)
+#define WAKE_JOIN_TIMEOUT      10000   // Longest wait for a sensor/display job (ms)
+#define DISPLAY_TASK_STACK_SIZE 8192
+#define DISPLAY_QUEUE_LENGTH   4
+#define DISPLAY_COMMAND_TIMEOUT 30000  // Longest panel operation incl. BUSY waits (ms)
+
+// Payload Ingestion
+#define PAYLOAD_STREAM_BUFFER  512     // Bytes in flight between MQTT and the parser task
+#define PAYLOAD_STREAM_TIMEOUT 1000    // Parser wait for the next payload byte (ms)
+#define PAYLOAD_PARSE_TIMEOUT  5000    // Wait for the parser after the message arrived (ms)
+#define PARSER_TASK_STACK_SIZE 4096
+#define AGGREGATE_WINDOW_MS    10000   // Wildcard topics: maximum time collecting sensor messages
+#define AGGREGATE_IDLE_MS      500     // Wildcard topics: collection ends after this quiet period
+
+// Always-On Mode (mains powered, MQTT session kept open)
+#define LIVE_COALESCE_MS       2000    // Changes arriving within this window share one render
+#define LIVE_MIN_INTERVAL_MS   10000   // Minimum time between renders
+#define LIVE_BATTERY_POLL_MS   60000   // Fuel gauge polling interval
+#define LIVE_TELEMETRY_MS      300000  // Status (LWT topic) publishing interval
+#define LIVE_MQTT_BUFFER_SIZE  4096    // Largest payload merged while listening (not streamed)
+#define LIVE_LOOP_MS           50      // Loop task period
+
+// Diagnostics
+#define TRACE_MAX_RECORDS      32        // Phase records kept per wake (RTC memory, PHASE_TRACE builds)
+#define TRACE_TOPIC_SUFFIX     "/trace"  // Previous wake's phase trace: displays/<node_name>/trace
+#define MEMORY_PROBE_SAMPLES   24        // Per-phase memory samples kept per wake
+#define MEMORY_PROBE_TASKS     8         // Tasks whose stack headroom is tracked
+#define TELEMETRY_RING_SIZE    16        // Per-wake metrics kept in RTC memory
+#define TELEMETRY_BATCH_WAKES  6         // Publish the batch (and the retained LWT) every N wakes
+#define TELEMETRY_TOPIC_SUFFIX "/telemetry"  // Batched per-wake metrics: displays/<node_name>/telemetry
+
+// Logging (level: -D LOG_LEVEL in platformio.ini)
+#define LOG_RING_SLOTS         32      // Lines queued for the log task (power of two)
+#define LOG_LINE_MAX           128     // Longer lines are truncated
+#define LOG_TASK_STACK_SIZE    3072
+#define LOG_FLUSH_TIMEOUT_MS   1000    // Longest wait for queued lines before sleep or restart
+#define LOG_CRASH_TAIL_LINES   8       // Lines kept in RTC memory for a crash report (LOG_CRASH_TAIL builds)
+#define LOG_CRASH_TOPIC_SUFFIX "/crash"  // Last lines before a crash: displays/<node_name>/crash
+
+// Energy Model (ESP32 DevKit + 4.2" panel; the scale is calibrated against the fuel gauge)
+#define ENERGY_BATTERY_MAH     2000    // Battery capacity
+#define ENERGY_CPU_MA          45.0f   // Awake, CPU running
+#define ENERGY_RADIO_MA        75.0f   // Added while WiFi is on (average incl. TX bursts)
+#define ENERGY_PANEL_MA        8.0f    // Added during panel transfer and refresh
+#define ENERGY_LIGHT_SLEEP_MA  0.8f    // Light sleep
+#define ENERGY_DEEP_SLEEP_MA   0.15f   // Deep sleep: regulator, fuel gauge, hibernated panel
+#define ENERGY_BOOT_MS         300     // ROM and bootloader before millis() starts
+#define ENERGY_AVERAGE_WEIGHT  0.2f    // Weight of the last cycle in the average current
+#define ENERGY_CALIBRATION_PCT 5       // Gauge drop that triggers a calibration step
+#define ENERGY_CALIBRATION_WEIGHT 0.3f // Weight of a calibration step in the scale
+
+// Sleep Scheduling (interval: sleep_hours; bounds and quiet hours: settings, defaults below)
+#define SLEEP_MIN_MINUTES      15      // Shortest sleep (sleep_min)
+#define SLEEP_MAX_MINUTES      1440    // Longest sleep (sleep_max)
+#define SLEEP_QUIET_START      -1      // Hour of day quiet hours begin, -1 for none (quiet_start)
+#define SLEEP_QUIET_END        -1      // Hour of day quiet hours end (quiet_end)
+#define SLEEP_UNCHANGED_WAKES  3       // Wakes without a data change per stretch step of the interval
+#define SLEEP_MAX_STRETCH      4       // Longest stretched sleep, times the interval
+#define SLEEP_CHANGING_WAKES   3       // Data changes within the last 4 wakes that halve the interval
+#define SLEEP_LOW_BATTERY_PCT  20      // Double the interval at or below
+#define SLEEP_CRITICAL_BATTERY_PCT 10  // Sleep the longest at or below
+#define SLEEP_CHARGING_RATE    0.5f    // Charge rate (%/h) that counts as charging: halve the interval
+
+// Wall Clock (publisher interval: publish_period; timezone: settings, defaults below)
+#define CLOCK_VALID_AFTER      1600000000  // Earlier Unix times mean the clock was never set
+#define CLOCK_NTP_SERVER       "pool.ntp.org"
+#define CLOCK_TIMEZONE         "UTC0"  // POSIX TZ string for quiet hours (timezone)
+#define CLOCK_RESYNC_HOURS     24      // SNTP sync this often once the drift has settled
+#define CLOCK_DRIFT_MIN_S      1800    // Shortest time between syncs that measures the drift
+#define CLOCK_DRIFT_WEIGHT     0.5f    // Share of a measured drift error applied to the estimate
+#define CLOCK_DRIFT_MAX        0.05f   // Largest plausible drift (5%)
+#define CLOCK_DRIFT_SETTLED    0.001f  // Drift error below which SNTP syncs drop to CLOCK_RESYNC_HOURS
+#define CLOCK_PUBLISH_PERIOD_MIN 60    // Publisher interval in minutes, 0 to not align (publish_period)
+#define CLOCK_PUBLISH_DELAY_S  60      // Wake this long after a publish slot
+
+// Wake Jitter (per-node offset into the wake slot, see WakeJitter.h)
+#define JITTER_WINDOW_S        120     // Offset range after a publish slot (not aligned: the sleep interval)
+#define JITTER_MAX_WINDOW_S    600     // Widest range after slow connects
+#define JITTER_SLOW_CONNECT_MS 3000    // Smoothed connect latency that widens the range
+#define JITTER_HOLD_WAKES      4       // Wakes between range changes
+#define JITTER_CALM_WAKES      24      // Wakes below half the slow latency that narrow it back
+
+// RTC State (records kept across deep sleep, see RtcStore.h)
+#define RTC_NVS_WRITE_WAKES    24      // Changed seals before a record with an NVS key is copied to flash
+
+// Battery Gauge (MAX17048 on GPIO21/22, see BatteryGauge.h)
+#define BATTERY_I2C_ADDRESS    0x36
+#define BATTERY_I2C_HZ         400000  // Fast mode, supported by the gauge: shorter bursts
+#define BATTERY_SMOOTHING      0.3f    // Weight of this wake's reading in the shown percentage
+#define BATTERY_HYSTERESIS_PCT 1.0f    // Change of the average before the shown percentage follows
+#define BATTERY_RESEED_PCT     15.0f   // Jump that restarts the average (battery swapped or charged)
 
 // Settings Namespace
 #define SETTINGS_NAMESPACE     "epaper"
@@ -41,6 +144,10 @@
 #define OTA_WIFI_TIMEOUT       15000   // 15 seconds for WiFi connection during OTA
 #define OTA_HTTP_TIMEOUT       30000   // 30 seconds for HTTP operations
 #define OTA_CONNECT_TIMEOUT    15000   // 15 seconds for HTTP connection
+#define OTA_TASK_STACK_SIZE    32768   // HTTPS download task (TLS); see stack_free in the LWT
 #define OTA_RX_TOPIC_SUFFIX    "/rx"   // Suffix for OTA receive topic: displays/<node_name>/rx
 
+// Dashboard Sync
+#define RESYNC_TOPIC_SUFFIX    "/resync"  // Snapshot request when a delta does not apply: displays/<node_name>/resync
+
 #endif // CONFIG_H
@@ -0,0 +1,26 @@
+#ifndef DASHBOARD_CACHE_H
+#define DASHBOARD_CACHE_H
+
+#include "DashboardModel.h"
+
+/**
+ * Dashboard Cache
+ *
+ * Keeps the last applied dashboard across deep sleep so delta payloads
+ * (see DashboardModel::applyUpdate) can be merged into it on the next wake.
+ * Kept in RTC memory, with a copy in NVS for power loss (see RtcStore.h).
+ */
+
+/**
+ * Load the cached dashboard
+ * @param model Filled with the cached dashboard, cleared if there is none
+ * @return true if a cached dashboard was found
+ */
+bool dashboard_cache_load(DashboardModel& model);
+
+/**
+ * Store the dashboard in RTC memory (copied to NVS by rtc_store_seal)
+ */
+void dashboard_cache_save(const DashboardModel& model);
+
+#endif // DASHBOARD_CACHE_H
@@ -0,0 +1,64 @@
+#ifndef DASHBOARD_LAYOUT_H
+#define DASHBOARD_LAYOUT_H
+
+#include <stdint.h>
+
+/**
+ * Dashboard Layout
+ *
+ * Arranges the plant widgets in the area below the header. Grid dimensions
+ * and gauge size follow the plant count; past a density threshold gauges
+ * become compact bars, and when even bars do not fit the plants are split
+ * into pages that rotate across consecutive wakes.
+ *
+ * Computed once per frame, and on the host by make probe-memory and
+ * make sim-framebuffer.
+ */
+class DashboardLayout {
+public:
+    /**
+     * Screen rectangle
+     */
+    struct Rect {
+        int x, y, w, h;
+    };
+
+    int originY;        // Top of the widget area (header height)
+    int cellW;          // Widget cell width
+    int cellH;          // Widget cell height
+    uint8_t cols;
+    uint8_t rows;
+    bool compact;       // Bars instead of gauges
+    uint8_t pageCount;
+    uint8_t page;       // Page shown in this frame
+    uint8_t first;      // Index of the first plant on this page
+    uint8_t count;      // Plants on this page
+
+    /**
+     * Compute the layout for a frame
+     * @param plantCount Number of plants to show
+     * @param width Screen width
+     * @param height Screen height
+     * @param headerHeight Height used by the header
+     * @param page Requested page (wrapped to the page count)
+     */
+    static DashboardLayout compute(int plantCount, int width, int height, int headerHeight, int page);
+
+    /**
+     * Gauge radius that fits a cell, as drawn by the renderer
+     */
+    static int gaugeRadius(int w, int h);
+
+    /**
+     * Screen rectangle of a cell on the current page
+     * @param slot Cell index relative to the page (0..cols*rows-1)
+     */
+    Rect cell(int slot) const;
+
+    /**
+     * Number of cells on a page
+     */
+    int capacity() const { return cols * rows; }
+};
+
+#endif // DASHBOARD_LAYOUT_H
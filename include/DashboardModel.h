@@ -0,0 +1,70 @@
+#ifndef DASHBOARD_MODEL_H
+#define DASHBOARD_MODEL_H
+
+#include <stdint.h>
+#include "Config.h"
+
+/**
+ * Dashboard Model
+ *
+ * Plain data shown on the dashboard: update date and plant readings in
+ * fixed-size buffers. Filled by the payload parser or directly for status
+ * screens, and copied as a whole (no heap, no JSON).
+ *
+ * Payloads may carry a sequence number. A delta payload also carries the
+ * sequence number of the state it applies to (base) and only the plants
+ * that changed; applyUpdate() merges it into the cached dashboard. The
+ * publish time (timestamp) lets the display wake in step with the publisher.
+ *
+ * Plain data without Arduino types: the host tools (bench-parse,
+ * probe-memory, sim-aggregator) fill it like the firmware does.
+ */
+struct DashboardModel {
+    struct Plant {
+        char name[PLANT_NAME_LEN];
+        uint8_t moisture;  // 0-100%
+    };
+
+    char updateDate[UPDATE_DATE_LEN];
+    uint8_t plantCount;
+    uint8_t delta;      // Payload is a delta against base
+    uint32_t seq;       // Sequence number (0 = unsequenced)
+    uint32_t base;      // Sequence number a delta applies to
+    uint32_t timestamp; // Publish time, Unix seconds (0 = not sent)
+    Plant plants[MAX_PLANTS];
+
+    /**
+     * Remove the update date and all plants
+     */
+    void clear();
+
+    /**
+     * Set the update date (truncated to the buffer)
+     */
+    void setUpdateDate(const char* date);
+
+    /**
+     * Append a plant (name truncated, moisture clamped to 0-100)
+     * @return false if the model already holds MAX_PLANTS plants
+     */
+    bool addPlant(const char* name, int moisture);
+
+    /**
+     * Replace the content with a status screen: a title in place of the
+     * update date and a single message widget
+     */
+    void setStatus(const char* title, const char* message);
+
+    /**
+     * Apply a received payload to this (cached) dashboard
+     * Snapshots replace it. Deltas update matching plants by name and add
+     * new ones, but only when their base is this dashboard's sequence
+     * number; removing plants needs a snapshot. A delta without an update
+     * date or timestamp keeps the cached ones. A payload with the current
+     * sequence number (retained message seen again) is a no-op.
+     * @return false if the delta does not apply (a snapshot is needed)
+     */
+    bool applyUpdate(const DashboardModel& update);
+};
+
+#endif // DASHBOARD_MODEL_H
@@ -0,0 +1,306 @@
+#ifndef DASHBOARD_MSGPACK_H
+#define DASHBOARD_MSGPACK_H
+
+#include <stdint.h>
+#include <string.h>
+#include "DashboardModel.h"
+
+/**
+ * Compact Binary Dashboard Payload (MessagePack)
+ *
+ * Positional schema, no keys repeated per plant:
+ *
+ *   [1, "2025-10-03 22:30", [["Plant Name", 85], ["Other", 42], ...], seq, base, ts]
+ *
+ * Element 0 is the schema version. seq, base and ts (publish time, Unix
+ * seconds) are optional: base is present (not nil) only in delta payloads,
+ * see DashboardModel.h. Elements past the ones listed here, in the
+ * top-level array or in a plant, are skipped so the schema can grow.
+ * Moisture may be any MessagePack integer or float.
+ *
+ * The decoder reads bytes straight into the DashboardModel, without an
+ * intermediate document. Source is anything with int read() returning the
+ * next byte or -1 at the end (an Arduino Stream, or a buffer on the host).
+ */
+
+#define DASHBOARD_MSGPACK_VERSION 1
+
+/**
+ * Whether a payload starting with this byte is a MessagePack array
+ * (JSON payloads start with '{' or whitespace)
+ */
+inline bool dashboard_is_msgpack(int firstByte)
+{
+    return (firstByte >= 0x90 && firstByte <= 0x9f) || firstByte == 0xdc || firstByte == 0xdd;
+}
+
+namespace msgpack_detail {
+    const int MAX_SKIP_DEPTH = 8;
+
+    template <typename Source>
+    bool readBytes(Source& source, uint8_t* out, int count)
+    {
+        for (int i = 0; i < count; i++) {
+            int c = source.read();
+            if (c < 0) {
+                return false;
+            }
+            out[i] = c;
+        }
+        return true;
+    }
+
+    /**
+     * Big-endian unsigned integer of 1, 2 or 4 bytes
+     */
+    template <typename Source>
+    bool readBE(Source& source, int count, uint32_t& value)
+    {
+        uint8_t bytes[4];
+        if (!readBytes(source, bytes, count)) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < count; i++) {
+            value = (value << 8) | bytes[i];
+        }
+        return true;
+    }
+
+    /**
+     * Array header: element count
+     */
+    template <typename Source>
+    bool readArray(Source& source, uint32_t& count)
+    {
+        int c = source.read();
+        if (c >= 0x90 && c <= 0x9f) {
+            count = c & 0x0f;
+            return true;
+        }
+        if (c == 0xdc) return readBE(source, 2, count);
+        if (c == 0xdd) return readBE(source, 4, count);
+        return false;
+    }
+
+    /**
+     * Skip bytes of a string/binary body
+     */
+    template <typename Source>
+    bool skipBytes(Source& source, uint32_t count)
+    {
+        while (count-- > 0) {
+            if (source.read() < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * String into a fixed buffer (truncated, nil reads as empty)
+     */
+    template <typename Source>
+    bool readString(Source& source, char* buffer, size_t size)
+    {
+        int c = source.read();
+        uint32_t length;
+        if (c >= 0xa0 && c <= 0xbf) {
+            length = c & 0x1f;
+        } else if (c == 0xd9) {
+            if (!readBE(source, 1, length)) return false;
+        } else if (c == 0xda) {
+            if (!readBE(source, 2, length)) return false;
+        } else if (c == 0xdb) {
+            if (!readBE(source, 4, length)) return false;
+        } else if (c == 0xc0) {
+            length = 0;
+        } else {
+            return false;
+        }
+        
+        uint32_t kept = length < size - 1 ? length : size - 1;
+        if (!readBytes(source, reinterpret_cast<uint8_t*>(buffer), kept)) {
+            return false;
+        }
+        buffer[kept] = '\0';
+        return skipBytes(source, length - kept);
+    }
+
+    /**
+     * Any integer or float, as int (floats truncated)
+     * @param isNil If given, nil is accepted and reported here
+     */
+    template <typename Source>
+    bool readNumber(Source& source, int& value, bool* isNil = nullptr)
+    {
+        int c = source.read();
+        uint32_t raw;
+        if (isNil) {
+            *isNil = c == 0xc0;
+            if (*isNil) {
+                value = 0;
+                return true;
+            }
+        }
+        if (c < 0) {
+            return false;
+        } else if (c <= 0x7f) {
+            value = c;
+        } else if (c >= 0xe0) {
+            value = (int8_t)c;
+        } else if (c == 0xcc || c == 0xcd || c == 0xce) {
+            if (!readBE(source, 1 << (c - 0xcc), raw)) return false;
+            value = raw > 0x7fffffff ? 0x7fffffff : (int)raw;
+        } else if (c == 0xd0) {
+            if (!readBE(source, 1, raw)) return false;
+            value = (int8_t)raw;
+        } else if (c == 0xd1) {
+            if (!readBE(source, 2, raw)) return false;
+            value = (int16_t)raw;
+        } else if (c == 0xd2) {
+            if (!readBE(source, 4, raw)) return false;
+            value = (int32_t)raw;
+        } else if (c == 0xca) {
+            float f;
+            if (!readBE(source, 4, raw)) return false;
+            memcpy(&f, &raw, sizeof(f));
+            value = (int)f;
+        } else if (c == 0xcb) {
+            uint32_t high, low;
+            if (!readBE(source, 4, high) || !readBE(source, 4, low)) return false;
+            uint64_t bits = ((uint64_t)high << 32) | low;
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            value = (int)d;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Skip one value of any type (unknown trailing elements)
+     */
+    template <typename Source>
+    bool skipValue(Source& source, int depth = 0)
+    {
+        int c = source.read();
+        uint32_t count = 0;
+        uint32_t elements = 0;
+        if (c < 0 || depth > MAX_SKIP_DEPTH) {
+            return false;
+        }
+        if (c <= 0x7f || c >= 0xe0 || c == 0xc0 || c == 0xc2 || c == 0xc3) {
+            return true;                                      // fixint, nil, bool
+        } else if (c >= 0xa0 && c <= 0xbf) {
+            return skipBytes(source, c & 0x1f);               // fixstr
+        } else if (c >= 0x90 && c <= 0x9f) {
+            elements = c & 0x0f;                              // fixarray
+        } else if (c >= 0x80 && c <= 0x8f) {
+            elements = (c & 0x0f) * 2;                        // fixmap
+        } else if (c == 0xcc || c == 0xd0) {
+            return skipBytes(source, 1);
+        } else if (c == 0xcd || c == 0xd1) {
+            return skipBytes(source, 2);
+        } else if (c == 0xce || c == 0xd2 || c == 0xca) {
+            return skipBytes(source, 4);
+        } else if (c == 0xcf || c == 0xd3 || c == 0xcb) {
+            return skipBytes(source, 8);
+        } else if (c == 0xc4 || c == 0xd9) {
+            return readBE(source, 1, count) && skipBytes(source, count);   // bin8, str8
+        } else if (c == 0xc5 || c == 0xda) {
+            return readBE(source, 2, count) && skipBytes(source, count);   // bin16, str16
+        } else if (c == 0xc6 || c == 0xdb) {
+            return readBE(source, 4, count) && skipBytes(source, count);   // bin32, str32
+        } else if (c == 0xdc || c == 0xdd) {
+            if (!readBE(source, c == 0xdc ? 2 : 4, elements)) return false;
+        } else if (c == 0xde || c == 0xdf) {
+            if (!readBE(source, c == 0xde ? 2 : 4, elements)) return false;
+            elements *= 2;
+        } else {
+            return false;                                     // ext types are not used
+        }
+        
+        while (elements-- > 0) {
+            if (!skipValue(source, depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+/**
+ * Decode a MessagePack dashboard payload into the model
+ * @param source Byte source (int read(), -1 at the end)
+ * @param model Model to fill (cleared first)
+ * @param totalPlants Set to the number of plants in the payload, which may
+ *                    exceed MAX_PLANTS
+ * @return true on success, false on malformed input or unknown schema version
+ */
+template <typename Source>
+bool dashboard_decode_msgpack(Source& source, DashboardModel& model, uint32_t& totalPlants)
+{
+    using namespace msgpack_detail;
+    
+    model.clear();
+    totalPlants = 0;
+    
+    uint32_t fields;
+    int version;
+    if (!readArray(source, fields) || fields < 3 || !readNumber(source, version) ||
+        version != DASHBOARD_MSGPACK_VERSION) {
+        return false;
+    }
+    if (!readString(source, model.updateDate, sizeof(model.updateDate)) ||
+        !readArray(source, totalPlants)) {
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < totalPlants; i++) {
+        uint32_t plantFields;
+        char name[PLANT_NAME_LEN];
+        int moisture;
+        if (!readArray(source, plantFields) || plantFields < 2 ||
+            !readString(source, name, sizeof(name)) || !readNumber(source, moisture)) {
+            return false;
+        }
+        for (uint32_t f = 2; f < plantFields; f++) {
+            if (!skipValue(source)) {
+                return false;
+            }
+        }
+        model.addPlant(name, moisture);  // Plants past MAX_PLANTS are dropped
+    }
+    
+    // Optional sequence numbers and publish time
+    int seq = 0;
+    int base = 0;
+    int timestamp = 0;
+    bool seqNil = true;
+    bool baseNil = true;
+    bool timestampNil = true;
+    if (fields > 3 && !readNumber(source, seq, &seqNil)) {
+        return false;
+    }
+    if (fields > 4 && !readNumber(source, base, &baseNil)) {
+        return false;
+    }
+    if (fields > 5 && !readNumber(source, timestamp, &timestampNil)) {
+        return false;
+    }
+    model.seq = seq;
+    model.base = base;
+    model.delta = !baseNil;
+    model.timestamp = timestamp > 0 ? (uint32_t)timestamp : 0;
+    
+    for (uint32_t f = 6; f < fields; f++) {
+        if (!skipValue(source)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // DASHBOARD_MSGPACK_H
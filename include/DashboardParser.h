@@ -0,0 +1,134 @@
+#ifndef DASHBOARD_PARSER_H
+#define DASHBOARD_PARSER_H
+
+#include <ArduinoJson.h>
+#include "DashboardModel.h"
+
+class Stream;
+
+/**
+ * Parse buffer for the filtered payload (heap, freed after parsing): the
+ * top-level fields, a fleet section and MAX_PLANTS plants with names of
+ * PLANT_NAME_LEN bytes. More plants or longer names fill it; the plants
+ * that fit are kept.
+ */
+#define DASHBOARD_JSON_CAPACITY (JSON_OBJECT_SIZE(6) + JSON_OBJECT_SIZE(1) + JSON_OBJECT_SIZE(2) + \
+                                 JSON_ARRAY_SIZE(MAX_PLANTS) + MAX_PLANTS * (JSON_OBJECT_SIZE(2) + PLANT_NAME_LEN) + 256)
+
+/**
+ * Dashboard Payload Parser
+ *
+ * Fills a DashboardModel from the plant data payload. Only the fields used
+ * by the dashboard are kept while parsing, in a heap buffer released on
+ * return, so neither the payload size nor unknown fields grow the memory
+ * needed. The payload can be parsed from memory or consumed from a stream
+ * as it arrives (see PayloadIngest.h).
+ *
+ * Payloads are JSON or, more compactly, MessagePack (see DashboardMsgPack.h),
+ * told apart by their first byte.
+ *
+ * JSON format:
+ * {
+ *   "seq": 42,                         (optional)
+ *   "base": 41,                        (delta payloads only)
+ *   "ts": 1759530600,                  (optional, publish time in Unix seconds)
+ *   "updateDate": "2025-10-03 22:30",
+ *   "plants": [
+ *     {"name": "Plant Name", "moisture": 85},
+ *     ...
+ *   ]
+ * }
+ *
+ * Fleet format: one document for many displays, with a section per
+ * node_name. Each display keeps only its own section while deserializing
+ * (the filter is built from its node name), so RAM does not grow with the
+ * fleet. seq/base/ts and a shared updateDate stay at the top level.
+ * {
+ *   "seq": 42,
+ *   "updateDate": "2025-10-03 22:30",
+ *   "fleet": {
+ *     "kitchen-display": {"plants": [...]},
+ *     "office-display": {"updateDate": "...", "plants": [...]}
+ *   }
+ * }
+ */
+
+/**
+ * Parse a JSON payload into the model
+ * @param payload Payload bytes (need not be null terminated)
+ * @param length Payload length
+ * @param nodeName Section to extract from fleet payloads
+ * @param model Model to fill (cleared first)
+ * @return true on success, false if the payload is not valid JSON or is a
+ *         fleet payload without a section for this node. A payload larger
+ *         than DASHBOARD_JSON_CAPACITY keeps the plants parsed before the
+ *         buffer filled.
+ */
+bool dashboard_parse_json(const char* payload, size_t length, const char* nodeName, DashboardModel& model);
+
+/**
+ * Parse a JSON payload read incrementally from a stream
+ * Returns once the top-level object is complete or the stream times out.
+ * @param input Stream delivering the payload
+ * @param nodeName Section to extract from fleet payloads
+ * @param model Model to fill (cleared first)
+ * @return true on success, false if the payload is not valid JSON or is a
+ *         fleet payload without a section for this node
+ */
+bool dashboard_parse_json(Stream& input, const char* nodeName, DashboardModel& model);
+
+/**
+ * Parse a MessagePack payload read incrementally from a stream
+ * Decoded straight into the model, no JsonDocument involved.
+ * @param input Stream delivering the payload
+ * @param model Model to fill (cleared first)
+ * @return true on success, false on malformed input
+ */
+bool dashboard_parse_msgpack(Stream& input, DashboardModel& model);
+
+/**
+ * Parse a JSON or MessagePack payload from a stream (format detected from
+ * the first byte)
+ * @param input Stream delivering the payload
+ * @param nodeName Section to extract from fleet payloads (JSON only)
+ * @param model Model to fill (cleared first)
+ * @return true on success
+ */
+bool dashboard_parse_payload(Stream& input, const char* nodeName, DashboardModel& model);
+
+/**
+ * Parse a complete JSON or MessagePack payload held in memory
+ * @param payload Payload bytes
+ * @param length Payload length
+ * @param nodeName Section to extract from fleet payloads (JSON only)
+ * @param model Model to fill (cleared first)
+ * @return true on success
+ */
+bool dashboard_parse_payload(const uint8_t* payload, size_t length, const char* nodeName, DashboardModel& model);
+
+/**
+ * Deserialize only the dashboard fields of a payload, and of a fleet
+ * payload only the section of this node
+ * Takes any ArduinoJson input (buffer and length, Stream, std::istream),
+ * which keeps it usable from host tools.
+ */
+template <typename... Input>
+DeserializationError dashboard_deserialize(JsonDocument& doc, const char* nodeName, Input&&... input)
+{
+    StaticJsonDocument<384> filter;
+    filter["seq"] = true;
+    filter["base"] = true;
+    filter["ts"] = true;
+    filter["updateDate"] = true;
+    filter["plants"][0]["name"] = true;
+    filter["plants"][0]["moisture"] = true;
+    
+    JsonObject section = filter["fleet"].createNestedObject(nodeName);
+    section["updateDate"] = true;
+    section["plants"][0]["name"] = true;
+    section["plants"][0]["moisture"] = true;
+    
+    return deserializeJson(doc, input..., DeserializationOption::Filter(filter));
+}
+
+#endif // DASHBOARD_PARSER_H
@@ -0,0 +1,427 @@
+#ifndef DASHBOARD_RENDERER_H
+#define DASHBOARD_RENDERER_H
+
+#include <Arduino.h>
+#include <qrcode.h>
+#include "Config.h"
+#include "DashboardLayout.h"
+#include "DisplayPanel.h"
+#include "DisplayUtils.h"
+#include "fonts.h"
+
+/**
+ * Dashboard Renderer
+ *
+ * Layout and drawing code for every screen, written once for any display
+ * type with the GxEPD2 drawing interface (GxEPD2_3C, GxEPD2_BW, Framebuffer).
+ * Draws into the active window; the caller owns paging and refresh.
+ *
+ * @tparam Display Display type
+ * @tparam W Screen width in pixels
+ * @tparam H Screen height in pixels
+ */
+template <typename Display,
+          int W = PanelTraits<Display>::WIDTH,
+          int H = PanelTraits<Display>::HEIGHT>
+class DashboardRenderer {
+public:
+    static const int WIDTH = W;
+    static const int HEIGHT = H;
+    static const uint16_t ALERT_COLOR = PanelTraits<Display>::ALERT_COLOR;
+
+    /**
+     * Constructor
+     * @param display Display to draw on
+     */
+    explicit DashboardRenderer(Display& display) : display(display) {}
+
+    /**
+     * Draw header with title, update date, and battery
+     * @param page Page shown (0-based), only labelled when pageCount > 1
+     * @return Total height used by the header in pixels
+     */
+    int drawHeader(const char* updateDate, int batteryPercent, int page = 0, int pageCount = 1)
+    {
+        display.setFont(&DejaVu_Sans_Bold_11);
+        display.setTextColor(GxEPD_BLACK);
+        
+        int16_t tbx, tby;
+        uint16_t tbw, tbh;
+        int currentY = 0;
+        
+        // Title - use larger text size, with page number when paginated
+        String title = headerTitle(page, pageCount);
+        display.setTextSize(2);
+        display.getTextBounds(title.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
+        currentY = tbh + 4;  // Add small padding
+        display.setCursor(W / 2 - tbw / 2, currentY);
+        display.print(title);
+        
+        // Date and Battery line - normal font size
+        currentY += 4;  // Small gap
+        display.setTextSize(1);
+        
+        // Draw "Updated:" and date
+        String updateLine = "Updated: " + String(updateDate) + " Battery: ";
+        display.getTextBounds(updateLine.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
+        currentY += tbh;
+        
+        // Calculate full line width including battery icon and version
+        String batteryStr = String(batteryPercent) + "%";
+        
+        // Format version as vX.X.X from FIRMWARE_VERSION (e.g., 101 -> v1.0.1)
+        int version = FIRMWARE_VERSION;
+        int major = version / 100;
+        int minor = (version / 10) % 10;
+        int patch = version % 10;
+        String versionStr = " v" + String(major) + "." + String(minor) + "." + String(patch);
+        
+        int16_t btbx, btby;
+        uint16_t btbw, btbh;
+        display.getTextBounds(batteryStr.c_str(), 0, 0, &btbx, &btby, &btbw, &btbh);
+        uint16_t versionW, versionH;
+        display.getTextBounds(versionStr.c_str(), 0, 0, &btbx, &btby, &versionW, &versionH);
+        
+        int batteryIconWidth = 20;  // Icon width
+        int totalWidth = tbw + batteryIconWidth + 4 + btbw + versionW;  // Text + icon + gap + percentage + version
+        
+        int startX = W / 2 - totalWidth / 2;
+        display.setCursor(startX, currentY);
+        display.print(updateLine);
+        
+        // Draw battery icon
+        int iconX = startX + tbw;
+        drawBatteryIcon(display, iconX, currentY - tbh + 2, batteryPercent);
+        
+        // Draw battery percentage
+        uint16_t batteryColor = (batteryPercent < BATTERY_LOW_THRESHOLD) ? ALERT_COLOR : GxEPD_BLACK;
+        display.setTextColor(batteryColor);
+        display.setCursor(iconX + batteryIconWidth + 4, currentY);
+        display.print(batteryStr);
+        display.setTextColor(GxEPD_BLACK);  // Reset color
+        
+        // Draw version
+        display.setCursor(iconX + batteryIconWidth + 4 + btbw, currentY);
+        display.print(versionStr);
+        
+        // Separator line - thicker (3 pixels)
+        currentY += 4;  // Small gap before line
+        display.drawLine(10, currentY, W - 10, currentY, GxEPD_BLACK);
+        display.drawLine(10, currentY + 1, W - 10, currentY + 1, GxEPD_BLACK);
+        display.drawLine(10, currentY + 2, W - 10, currentY + 2, GxEPD_BLACK);
+        currentY += 3;  // Account for line thickness
+        
+        return currentY;  // Return total header height
+    }
+
+    /**
+     * Measure header height without drawing (mirrors drawHeader)
+     * @param page Page shown (0-based), only labelled when pageCount > 1
+     */
+    int measureHeader(const char* updateDate, int page = 0, int pageCount = 1)
+    {
+        display.setFont(&DejaVu_Sans_Bold_11);
+        
+        int16_t tbx, tby;
+        uint16_t tbw, tbh;
+        
+        display.setTextSize(2);
+        display.getTextBounds(headerTitle(page, pageCount).c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
+        int height = tbh + 4 + 4;  // Title, padding and gap
+        
+        display.setTextSize(1);
+        String updateLine = "Updated: " + String(updateDate) + " Battery: ";
+        display.getTextBounds(updateLine.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
+        height += tbh + 4 + 3;  // Date line, gap and separator
+        
+        return height;
+    }
+
+    /**
+     * Draw a single plant moisture gauge
+     */
+    void drawGauge(int x, int y, int w, int h, const char* name, int moisture)
+    {
+        const int centerX = x + w / 2;
+        
+        // Calculate gauge radius based on available height and width
+        int topPadding = h * 0.10;
+        
+        const int radius = DashboardLayout::gaugeRadius(w, h);
+        const int centerY = y + topPadding + radius;     // Position gauge
+        
+        // Determine color based on moisture level
+        uint16_t valueColor = (moisture < MOISTURE_LOW_THRESHOLD) ? ALERT_COLOR : GxEPD_BLACK;
+        
+        int16_t tbx, tby;
+        uint16_t tbw, tbh;
+        
+        // Draw gauge background arc (180 degrees) - thick and smooth
+        int arcThickness = max(6, radius / 8);  // Scale thickness with radius
+        for (int r = radius - arcThickness; r <= radius; r++) {
+            drawSmoothArc(display, centerX, centerY, r, 180, 360, GxEPD_BLACK);
+        }
+        
+        // Draw moisture level arc - very thick and smooth
+        if (moisture > 0) {
+            int endAngle = 180 + (moisture * 180 / 100);
+            int valueThickness = max(8, radius / 6);
+            for (int r = radius - arcThickness - valueThickness; r <= radius - arcThickness - 1; r++) {
+                drawSmoothArc(display, centerX, centerY, r, 180, endAngle, valueColor);
+            }
+        }
+        
+        // NO TICK MARKS - cleaner look!
+        
+        // Draw percentage value below gauge
+        int percentY = centerY + 5;  // Just below the gauge
+        display.setFont(&DejaVu_Sans_Bold_11);
+        display.setTextSize(2);
+        display.setTextColor(valueColor);
+        
+        String percentStr = String(moisture) + "%";
+        display.getTextBounds(percentStr.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
+        percentY += tbh;
+        display.setCursor(centerX - tbw / 2, percentY);
+        display.print(percentStr);
+        
+        // Draw status indicator
+        if (moisture < MOISTURE_LOW_THRESHOLD) {
+            display.setTextSize(1);
+            display.setTextColor(ALERT_COLOR);
+            display.getTextBounds("LOW!", 0, 0, &tbx, &tby, &tbw, &tbh);
+            percentY += tbh + 2;
+            display.setCursor(centerX - tbw / 2, percentY);
+            display.print("LOW!");
+        }
+        
+        // Draw plant name at bottom of allocated space
+        display.setFont(&DejaVu_Sans_Bold_11);
+        display.setTextSize(1);
+        display.setTextColor(GxEPD_BLACK);
+        
+        String displayName = name;
+        display.getTextBounds(displayName.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
+        
+        // Smart abbreviation if needed
+        if (tbw > w - 4) {
+            if (displayName.indexOf(" ") > 0) {
+                int spacePos = displayName.indexOf(" ");
+                String firstName = displayName.substring(0, spacePos);
+                String lastName = displayName.substring(spacePos + 1);
+                displayName = firstName + " " + lastName.substring(0, 1) + ".";
+                display.getTextBounds(displayName.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
+        
+                if (tbw > w - 4) {
+                    displayName = firstName;
+                    display.getTextBounds(displayName.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
+                }
+            }
+        }
+        
+        int nameY = y + h - 5;  // 5px from bottom
+        display.setCursor(centerX - tbw / 2, nameY);
+        display.print(displayName);
+    }
+
+    /**
+     * Draw a single plant as a compact horizontal bar
+     */
+    void drawBar(int x, int y, int w, int h, const char* name, int moisture)
+    {
+        uint16_t valueColor = (moisture < MOISTURE_LOW_THRESHOLD) ? ALERT_COLOR : GxEPD_BLACK;
+        
+        int16_t tbx, tby;
+        uint16_t tbw, tbh;
+        
+        display.setFont(&DejaVu_Sans_Bold_11);
+        display.setTextSize(1);
+        
+        // Reserve room for the widest percentage
+        display.getTextBounds("100%", 0, 0, &tbx, &tby, &tbw, &tbh);
+        int percentW = tbw;
+        int baseline = y + (h + tbh) / 2;
+        
+        // Percentage on the right
+        String percentStr = String(moisture) + "%";
+        display.getTextBounds(percentStr.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
+        display.setTextColor(valueColor);
+        display.setCursor(x + w - 4 - tbw, baseline);
+        display.print(percentStr);
+        
+        // Name on the left, truncated to 40% of the cell
+        int nameW = w * 2 / 5;
+        String displayName = name;
+        display.getTextBounds(displayName.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
+        while (tbw > nameW - 6 && displayName.length() > 1) {
+            displayName = displayName.substring(0, displayName.length() - 1);
+            display.getTextBounds(displayName.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
+        }
+        display.setTextColor(GxEPD_BLACK);
+        display.setCursor(x + 4, baseline);
+        display.print(displayName);
+        
+        // Bar between name and percentage
+        int barX = x + nameW;
+        int barW = w - nameW - percentW - 12;
+        int barH = max(6, h / 3);
+        int barY = y + (h - barH) / 2;
+        display.drawRect(barX, barY, barW, barH, GxEPD_BLACK);
+        
+        int fillW = (barW - 4) * constrain(moisture, 0, 100) / 100;
+        if (fillW > 0) {
+            display.fillRect(barX + 2, barY + 2, fillW, barH - 4, valueColor);
+        }
+    }
+
+    /**
+     * Draw firmware upgrade screen
+     */
+    void drawUpgradeScreen()
+    {
+        display.fillScreen(GxEPD_WHITE);
+        display.setTextColor(GxEPD_BLACK);
+        display.setFont(&DejaVu_Sans_Bold_11);
+        display.setTextSize(2);
+        
+        int16_t tbx, tby;
+        uint16_t tbw, tbh;
+        
+        // "Firmware Upgrade" text
+        const char* msg1 = "Firmware Upgrade";
+        display.getTextBounds(msg1, 0, 0, &tbx, &tby, &tbw, &tbh);
+        int x = (W - tbw) / 2;
+        int y = (H / 2) - 20;
+        display.setCursor(x, y);
+        display.print(msg1);
+        
+        // "In Progress..." text
+        const char* msg2 = "In Progress...";
+        display.getTextBounds(msg2, 0, 0, &tbx, &tby, &tbw, &tbh);
+        x = (W - tbw) / 2;
+        y += tbh + 20;
+        display.setCursor(x, y);
+        display.print(msg2);
+    }
+
+    /**
+     * Draw WiFi configuration screen with AP credentials and QR code
+     */
+    void drawConfigScreen(const char* ssid, const char* password)
+    {
+        display.fillScreen(GxEPD_WHITE);
+        display.setTextColor(GxEPD_BLACK);
+        
+        int16_t tbx, tby;
+        uint16_t tbw, tbh;
+        int currentY = 20;
+        
+        // Title - "Configuration Required"
+        display.setFont(&DejaVu_Sans_Bold_11);
+        display.setTextSize(2);
+        const char* title = "Configuration Required";
+        display.getTextBounds(title, 0, 0, &tbx, &tby, &tbw, &tbh);
+        currentY += tbh;
+        display.setCursor((W - tbw) / 2, currentY);
+        display.print(title);
+        
+        currentY += 10;
+        
+        // Instructions
+        display.setTextSize(1);
+        const char* instruction = "Connect to WiFi network:";
+        display.getTextBounds(instruction, 0, 0, &tbx, &tby, &tbw, &tbh);
+        currentY += tbh + 10;
+        display.setCursor((W - tbw) / 2, currentY);
+        display.print(instruction);
+        
+        // SSID
+        display.setTextSize(1);
+        currentY += tbh + 15;
+        display.getTextBounds("SSID:", 0, 0, &tbx, &tby, &tbw, &tbh);
+        display.setCursor(40, currentY);
+        display.print("SSID:");
+        
+        display.setFont(&DejaVu_Sans_Bold_11);
+        display.setCursor(100, currentY);
+        display.print(ssid);
+        
+        // Password
+        display.setFont(&DejaVu_Sans_Bold_11);
+        currentY += tbh + 10;
+        display.setCursor(40, currentY);
+        display.print("Pass:");
+        
+        display.setFont(&DejaVu_Sans_Bold_11);
+        display.setCursor(100, currentY);
+        display.print(password);
+        
+        // Generate QR code for WiFi connection
+        // WiFi QR code format: WIFI:T:WPA;S:<SSID>;P:<PASSWORD>;;
+        String qrData = "WIFI:T:WPA;S:";
+        qrData += ssid;
+        qrData += ";P:";
+        qrData += password;
+        qrData += ";;";
+        
+        // Create QR code - use version 5 for better compatibility
+        QRCode qrcode;
+        uint8_t qrcodeData[qrcode_getBufferSize(5)];
+        qrcode_initText(&qrcode, qrcodeData, 5, ECC_MEDIUM, qrData.c_str());
+        
+        // Draw QR code centered below the text
+        int qrSize = qrcode.size;
+        int scale = 4;  // Increase scale factor for better scanning
+        int qrPixelSize = qrSize * scale;
+        int qrX = (W - qrPixelSize) / 2;
+        int qrY = currentY + 20;
+        
+        // Draw white background first
+        int border = scale * 4;  // Larger white border for better scanning
+        display.fillRect(qrX - border, qrY - border, qrPixelSize + border * 2, qrPixelSize + border * 2, GxEPD_WHITE);
+        
+        for (uint8_t y = 0; y < qrSize; y++) {
+            for (uint8_t x = 0; x < qrSize; x++) {
+                if (qrcode_getModule(&qrcode, x, y)) {
+                    display.fillRect(qrX + x * scale, qrY + y * scale, scale, scale, GxEPD_BLACK);
+                } else {
+                    display.fillRect(qrX + x * scale, qrY + y * scale, scale, scale, GxEPD_WHITE);
+                }
+            }
+        }
+        
+        // Instructions at bottom
+        display.setFont(&DejaVu_Sans_Bold_11);
+        display.setTextSize(1);
+        currentY = qrY + qrPixelSize + 20;
+        const char* scanMsg = "Scan QR code to connect";
+        display.getTextBounds(scanMsg, 0, 0, &tbx, &tby, &tbw, &tbh);
+        currentY += tbh;
+        display.setCursor((W - tbw) / 2, currentY);
+        display.print(scanMsg);
+        
+        currentY += tbh + 5;
+        const char* urlMsg = "Then open: 192.168.4.1";
+        display.getTextBounds(urlMsg, 0, 0, &tbx, &tby, &tbw, &tbh);
+        currentY += tbh;
+        display.setCursor((W - tbw) / 2, currentY);
+        display.print(urlMsg);
+    }
+
+private:
+    Display& display;
+
+    /**
+     * Header title, with the page number when paginated
+     */
+    static String headerTitle(int page, int pageCount)
+    {
+        String title = "PLANT MOISTURE";
+        if (pageCount > 1) {
+            title += " " + String(page + 1) + "/" + String(pageCount);
+        }
+        return title;
+    }
+};
+
+#endif // DASHBOARD_RENDERER_H
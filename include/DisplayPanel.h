@@ -0,0 +1,90 @@
+#ifndef DISPLAY_PANEL_H
+#define DISPLAY_PANEL_H
+
+#include <GxEPD2.h>
+#include "Config.h"
+
+/**
+ * Display Panel Selection
+ *
+ * The panel is a build-time choice (see platformio.ini):
+ *   (default)                  GDEY042Z98  4.2" black/white/red, full refresh only
+ *   -D EPD_PANEL_GDEY042T81    GDEY042T81  4.2" black/white, sub-second partial refresh
+ *   -D EPD_PANEL_FRAMEBUFFER   In-memory framebuffer, no hardware
+ *
+ * PanelTraits describe each display type so the rendering code is written
+ * once as templates over the display and its dimensions.
+ */
+template <typename Display>
+struct PanelTraits;
+
+#if defined(EPD_PANEL_GDEY042T81)
+
+#include <GxEPD2_BW.h>
+#include <gdey/GxEPD2_420_GDEY042T81.h>
+typedef GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT> PanelDisplay;
+
+/**
+ * Black/white panels: alerts fall back to black, partial and whole-screen
+ * fast refreshes use the differential waveform
+ */
+template <typename Driver, uint16_t PageHeight>
+struct PanelTraits<GxEPD2_BW<Driver, PageHeight>> {
+    typedef Driver DriverType;
+    static const int WIDTH = Driver::WIDTH;
+    static const int HEIGHT = Driver::HEIGHT;
+    static const uint16_t ALERT_COLOR = GxEPD_BLACK;
+    static const bool PARTIAL = Driver::hasFastPartialUpdate;
+    static const bool MONO = Driver::hasFastPartialUpdate;
+    static const uint16_t FULL_MS = Driver::full_refresh_time;
+    static const uint16_t PARTIAL_MS = Driver::partial_refresh_time;
+    static const uint8_t PLANES = 1;
+};
+
+#elif defined(EPD_PANEL_FRAMEBUFFER)
+
+#include "Framebuffer.h"
+typedef Framebuffer<400, 300> PanelDisplay;
+
+/**
+ * Native framebuffer: behaves like a tri-color panel with instant refresh
+ */
+template <int W, int H>
+struct PanelTraits<Framebuffer<W, H>> {
+    typedef FramebufferDriver DriverType;
+    static const int WIDTH = W;
+    static const int HEIGHT = H;
+    static const uint16_t ALERT_COLOR = GxEPD_RED;
+    static const bool PARTIAL = true;
+    static const bool MONO = true;
+    static const uint16_t FULL_MS = 0;
+    static const uint16_t PARTIAL_MS = 0;
+    static const uint8_t PLANES = 2;
+};
+
+#else
+
+#include <GxEPD2_3C.h>
+#include <gdey3c/GxEPD2_420c_GDEY042Z98.h>
+typedef GxEPD2_3C<GxEPD2_420c_GDEY042Z98, GxEPD2_420c_GDEY042Z98::HEIGHT> PanelDisplay;
+
+/**
+ * Tri-color panels: red is available, every refresh runs the tri-color
+ * waveform, and image data is sent as a black and a red plane
+ */
+template <typename Driver, uint16_t PageHeight>
+struct PanelTraits<GxEPD2_3C<Driver, PageHeight>> {
+    typedef Driver DriverType;
+    static const int WIDTH = Driver::WIDTH;
+    static const int HEIGHT = Driver::HEIGHT;
+    static const uint16_t ALERT_COLOR = GxEPD_RED;
+    static const bool PARTIAL = Driver::hasPartialUpdate;
+    static const bool MONO = false;
+    static const uint16_t FULL_MS = Driver::full_refresh_time;
+    static const uint16_t PARTIAL_MS = Driver::partial_refresh_time;
+    static const uint8_t PLANES = 2;
+};
+
+#endif
+
+#endif // DISPLAY_PANEL_H
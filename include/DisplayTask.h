@@ -0,0 +1,118 @@
+#ifndef DISPLAY_TASK_H
+#define DISPLAY_TASK_H
+
+#include <stdint.h>
+#include "DashboardModel.h"
+
+#if defined(ARDUINO)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#else
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#endif
+
+/**
+ * Display commands
+ */
+enum DisplayCommandType : uint8_t {
+    DISPLAY_INIT,           // Reset and initialize the panel
+    DISPLAY_PRERENDER,      // Draw the expected header into the frame buffer
+    DISPLAY_RENDER,         // Draw the frame and refresh the panel
+    DISPLAY_UPGRADE_SCREEN, // Show the firmware upgrade screen
+    DISPLAY_HIBERNATE       // Put the panel into deep sleep
+};
+
+/**
+ * Command for the display task
+ */
+struct DisplayCommand {
+    DisplayCommandType type;
+    const DashboardModel* model;    // DISPLAY_RENDER: content (must stay valid until done)
+    int batteryPercent;             // DISPLAY_PRERENDER, DISPLAY_RENDER
+    int phase;                      // Wake phase traced for the command, -1 for none
+};
+
+/**
+ * Display Task
+ *
+ * Runs the e-paper driver in its own task so SPI transfers and panel BUSY
+ * waits no longer block the caller: commands are queued and executed in
+ * order by an executor (PlantMonitor glue in main.cpp), and each post()
+ * returns a ticket the caller can wait() on when it needs the result.
+ *
+ * On the device the task is a FreeRTOS task fed by a queue, and completion
+ * is signalled with a task notification to the posting task (which must
+ * not use its notification value for anything else). Native builds get the
+ * same interface on a std::thread, checked by make sim-display-task.
+ */
+class DisplayTask {
+public:
+    /**
+     * Executes one command on the display task
+     */
+    typedef void (*Executor)(const DisplayCommand& command, void* context);
+
+    DisplayTask();
+    ~DisplayTask();
+
+    /**
+     * Start the task
+     * @return false if the task or its queue could not be created
+     */
+    bool begin(Executor executor, void* context);
+
+    /**
+     * Queue a command
+     * @return Ticket for wait(), 0 if the command could not be queued
+     */
+    uint32_t post(const DisplayCommand& command);
+
+    /**
+     * Wait until a command and all commands queued before it are done
+     * Must be called from the task that posted the command.
+     * @param ticket Ticket returned by post()
+     * @param timeoutMs Timeout in milliseconds
+     * @return true if done
+     */
+    bool wait(uint32_t ticket, unsigned long timeoutMs);
+
+    /**
+     * Whether a command is done
+     */
+    bool done(uint32_t ticket) const;
+
+private:
+    struct Entry {
+        DisplayCommand command;
+        uint32_t ticket;
+#if defined(ARDUINO)
+        TaskHandle_t requester;
+#endif
+    };
+
+    Executor executor;
+    void* context;
+    uint32_t nextTicket;
+    volatile uint32_t completed;
+
+#if defined(ARDUINO)
+    TaskHandle_t task;
+    QueueHandle_t queue;
+
+    static void taskMain(void* param);
+#else
+    std::thread worker;
+    mutable std::mutex lock;
+    std::condition_variable changed;
+    std::deque<Entry> queue;
+    bool stopping;
+
+    void run();
+#endif
+};
+
+#endif // DISPLAY_TASK_H
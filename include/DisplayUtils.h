@@ -1,8 +1,9 @@
 #ifndef DISPLAY_UTILS_H
 #define DISPLAY_UTILS_H
 
-#include <GxEPD2_3C.h>
-#include <gdey3c/GxEPD2_420c_GDEY042Z98.h>
+#include <Arduino.h>
+#include "Config.h"
+#include "DisplayPanel.h"
 
 /**
  * Draw a smooth arc using line segments for better quality
@@ -15,8 +16,25 @@
  * @param endAngle End angle in degrees (0-360)
  * @param color Color to draw (GxEPD_BLACK, GxEPD_RED, GxEPD_WHITE)
  */
-void drawSmoothArc(GxEPD2_3C<GxEPD2_420c_GDEY042Z98, GxEPD2_420c_GDEY042Z98::HEIGHT>& display,
-                   int cx, int cy, int radius, int startAngle, int endAngle, uint16_t color);
+template <typename Display>
+void drawSmoothArc(Display& display, int cx, int cy, int radius, int startAngle, int endAngle, uint16_t color)
+{
+    float prevX = cx + radius * cos(startAngle * PI / 180.0);
+    float prevY = cy + radius * sin(startAngle * PI / 180.0);
+    
+    // Draw arc with 1-degree increments for smoothness
+    for (int angle = startAngle + 1; angle <= endAngle; angle++) {
+        float rad = angle * PI / 180.0;
+        float newX = cx + radius * cos(rad);
+        float newY = cy + radius * sin(rad);
+        
+        // Draw line segment from previous point to current point
+        display.drawLine((int)prevX, (int)prevY, (int)newX, (int)newY, color);
+        
+        prevX = newX;
+        prevY = newY;
+    }
+}
 
 /**
  * Draw a battery icon with fill level indicator
@@ -26,7 +44,26 @@ void drawSmoothArc(GxEPD2_3C<GxEPD2_420c_GDEY042Z98, GxEPD2_420c_GDEY042Z98::HEI
  * @param y Top-left Y coordinate
  * @param batteryPercent Battery percentage (0-100)
  */
-void drawBatteryIcon(GxEPD2_3C<GxEPD2_420c_GDEY042Z98, GxEPD2_420c_GDEY042Z98::HEIGHT>& display,
-                     int x, int y, int batteryPercent);
+template <typename Display>
+void drawBatteryIcon(Display& display, int x, int y, int batteryPercent)
+{
+    uint16_t batteryColor = (batteryPercent < BATTERY_LOW_THRESHOLD) ? PanelTraits<Display>::ALERT_COLOR : GxEPD_BLACK;
+    
+    // Battery body (16x8 pixels)
+    int bodyWidth = 16;
+    int bodyHeight = 8;
+    
+    // Draw battery outline
+    display.drawRect(x, y, bodyWidth, bodyHeight, batteryColor);
+    
+    // Draw battery terminal (small nub on right side)
+    display.fillRect(x + bodyWidth, y + 2, 2, 4, batteryColor);
+    
+    // Draw battery fill level
+    int fillWidth = (bodyWidth - 4) * batteryPercent / 100;
+    if (fillWidth > 0) {
+        display.fillRect(x + 2, y + 2, fillWidth, bodyHeight - 4, batteryColor);
+    }
+}
 
 #endif // DISPLAY_UTILS_H
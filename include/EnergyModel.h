@@ -0,0 +1,123 @@
+#ifndef ENERGY_MODEL_H
+#define ENERGY_MODEL_H
+
+#include <stdint.h>
+#include "Config.h"
+
+/**
+ * Energy Model
+ *
+ * Estimates the charge of a wake/sleep cycle from how long the device
+ * spent in each power state, times a current per state (ENERGY_* in
+ * Config.h). The estimate is scaled by a calibration factor learnt from
+ * the fuel gauge: once the gauge has dropped ENERGY_CALIBRATION_PCT since
+ * the last calibration point, the charge it reports is compared with the
+ * charge the model accumulated over the same cycles.
+ *
+ * The model has no Arduino dependencies; tools/energy_model.cpp runs it
+ * over recorded phase traces. The firmware keeps its state in RTC memory
+ * (energy_* functions below).
+ */
+
+/**
+ * Current drawn in each power state
+ */
+struct EnergyCoefficients {
+    float cpuMa;            // Awake, CPU running
+    float radioMa;          // Added while WiFi is on
+    float panelMa;          // Added during panel transfer and refresh
+    float lightSleepMa;     // Awake time spent in light sleep (instead of cpuMa)
+    float deepSleepMa;      // Whole board in deep sleep
+};
+
+/**
+ * Time spent in each power state during one cycle
+ * Radio, panel and light sleep time are parts of the awake time.
+ */
+struct EnergyPhases {
+    uint32_t awakeMs;
+    uint32_t radioMs;
+    uint32_t panelMs;
+    uint32_t lightSleepMs;
+    uint32_t deepSleepS;
+};
+
+/**
+ * Accounting kept across cycles
+ */
+struct EnergyState {
+    float scale;            // Gauge-measured / modelled charge
+    float averageMa;        // Modelled average current over recent cycles (uncalibrated)
+    float cycleMah;         // Last cycle (uncalibrated)
+    float anchorPercent;    // Gauge reading at the calibration point, < 0 if none
+    float anchorMah;        // Modelled charge since the calibration point
+    uint32_t cycles;        // Cycles accounted
+    uint32_t calibrations;  // Calibration steps taken
+};
+
+class EnergyModel {
+public:
+    explicit EnergyModel(const EnergyCoefficients& coefficients = defaultCoefficients());
+    
+    /**
+     * Coefficients from Config.h
+     */
+    static EnergyCoefficients defaultCoefficients();
+    
+    /**
+     * Fresh state: no calibration, no history
+     */
+    static void reset(EnergyState& state);
+    
+    /**
+     * Modelled charge of one cycle in mAh (uncalibrated)
+     */
+    float cycleMah(const EnergyPhases& phases) const;
+    
+    /**
+     * Add a finished cycle to the state
+     */
+    void account(EnergyState& state, const EnergyPhases& phases) const;
+    
+    /**
+     * Compare the model with the fuel gauge
+     * Charging (the reading rising) moves the calibration point instead.
+     * @return true if a calibration step was taken
+     */
+    static bool calibrate(EnergyState& state, float batteryPercent, float capacityMah);
+    
+    /**
+     * Calibrated average current in mA, 0 without history
+     */
+    static float averageMa(const EnergyState& state);
+    
+    /**
+     * Days until the battery is empty at the calibrated average current
+     * @return 0 without history
+     */
+    static float projectedDays(const EnergyState& state, float batteryPercent, float capacityMah);
+
+private:
+    EnergyCoefficients k;
+};
+
+#if defined(ARDUINO)
+/**
+ * Validate the state kept in RTC memory and calibrate against the gauge
+ * Call once per wake after the fuel gauge was read.
+ * @param gaugePresent Without a gauge only the model is used
+ */
+void energy_begin(float batteryPercent, bool gaugePresent);
+
+/**
+ * Account this wake and the deep sleep that follows
+ */
+void energy_account(const EnergyPhases& phases);
+
+/**
+ * Accounting kept in RTC memory
+ */
+const EnergyState& energy_state();
+#endif
+
+#endif // ENERGY_MODEL_H
@@ -0,0 +1,148 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <Adafruit_GFX.h>
+#include <GxEPD2.h>
+#include <string.h>
+
+/**
+ * Dummy driver so Framebuffer is constructed like a GxEPD2 display
+ */
+struct FramebufferDriver {
+    FramebufferDriver(int16_t cs, int16_t dc, int16_t rst, int16_t busy) {}
+};
+
+/**
+ * Native Framebuffer
+ *
+ * In-memory tri-color framebuffer exposing the subset of the GxEPD2 display
+ * interface used by the rendering code. Selecting it as the panel renders
+ * the exact same layout without hardware, e.g. for screenshots or host runs
+ * (make sim-framebuffer). Drawing follows the GFX rotation like GxEPD2: the
+ * planes always hold the unrotated W x H panel image.
+ *
+ * @tparam W Width in pixels (multiple of 8)
+ * @tparam H Height in pixels
+ */
+template <int W, int H>
+class Framebuffer : public Adafruit_GFX {
+public:
+    static const int WIDTH = W;
+    static const int HEIGHT = H;
+
+    explicit Framebuffer(const FramebufferDriver&)
+        : Adafruit_GFX(W, H), winX(0), winY(0), winW(W), winH(H), refreshes(0)
+    {
+        memset(black, 0, sizeof(black));
+        memset(red, 0, sizeof(red));
+    }
+
+    void init(uint32_t serialDiagBitrate, bool initial, uint16_t resetDuration, bool pulldownRstMode) {}
+    void hibernate() {}
+
+    void setFullWindow()
+    {
+        winX = 0;
+        winY = 0;
+        winW = W;
+        winH = H;
+    }
+
+    /**
+     * Restrict drawing to a window given in rotated coordinates
+     */
+    void setPartialWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+    {
+        int16_t rx = x, ry = y, rw = w, rh = h;
+        rotate(rx, ry, rw, rh);
+        winX = rx;
+        winY = ry;
+        winW = rw;
+        winH = rh;
+    }
+
+    void firstPage() {}
+
+    bool nextPage()
+    {
+        refreshes++;
+        return false;  // Single page covering the whole buffer
+    }
+
+    uint16_t pages() const { return 1; }
+
+    /**
+     * Show the buffer (whole screen or a window of it)
+     */
+    void display(bool partialUpdateMode = false) { refreshes++; }
+    void displayWindow(int16_t x, int16_t y, int16_t w, int16_t h) { refreshes++; }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override
+    {
+        if (x < 0 || y < 0 || x >= width() || y >= height()) {
+            return;
+        }
+        int16_t one = 1;
+        rotate(x, y, one, one);
+        if (x < winX || y < winY || x >= winX + winW || y >= winY + winH) {
+            return;
+        }
+        uint32_t i = x / 8 + y * (W / 8);
+        uint8_t bit = 0x80 >> (x % 8);
+        black[i] &= ~bit;
+        red[i] &= ~bit;
+        if (color == GxEPD_BLACK) {
+            black[i] |= bit;
+        } else if (color == GxEPD_RED) {
+            red[i] |= bit;
+        }
+    }
+
+    /**
+     * Color of a buffer pixel, unrotated (GxEPD_WHITE, GxEPD_BLACK or GxEPD_RED)
+     */
+    uint16_t getPixel(int16_t x, int16_t y) const
+    {
+        uint32_t i = x / 8 + y * (W / 8);
+        uint8_t bit = 0x80 >> (x % 8);
+        if (red[i] & bit) return GxEPD_RED;
+        if (black[i] & bit) return GxEPD_BLACK;
+        return GxEPD_WHITE;
+    }
+
+    const uint8_t* blackPlane() const { return black; }
+    const uint8_t* redPlane() const { return red; }
+    uint32_t refreshCount() const { return refreshes; }
+
+private:
+    uint8_t black[W / 8 * H];
+    uint8_t red[W / 8 * H];
+    int16_t winX, winY, winW, winH;
+    uint32_t refreshes;
+
+    /**
+     * Map a rectangle from rotated to buffer coordinates (GxEPD2 _rotate)
+     */
+    void rotate(int16_t& x, int16_t& y, int16_t& w, int16_t& h) const
+    {
+        int16_t t;
+        switch (getRotation()) {
+            case 1:
+                t = x; x = y; y = t;
+                t = w; w = h; h = t;
+                x = W - x - w;
+                break;
+            case 2:
+                x = W - x - w;
+                y = H - y - h;
+                break;
+            case 3:
+                t = x; x = y; y = t;
+                t = w; w = h; h = t;
+                y = H - y - h;
+                break;
+        }
+    }
+};
+
+#endif // FRAMEBUFFER_H
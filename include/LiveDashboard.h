@@ -0,0 +1,86 @@
+#ifndef LIVE_DASHBOARD_H
+#define LIVE_DASHBOARD_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "DashboardModel.h"
+#include "TopicAggregator.h"
+
+/**
+ * Live Dashboard
+ *
+ * Dashboard state of the always-on (mains powered) mode: the MQTT session
+ * stays open and every plant message is merged as it arrives, on the
+ * network task. The loop task renders when due(): changes are coalesced
+ * for LIVE_COALESCE_MS after the first one and renders are at least
+ * LIVE_MIN_INTERVAL_MS apart. Identical messages (e.g. retained messages
+ * sent again after a reconnect) do not trigger a render.
+ */
+class LiveDashboard {
+public:
+    /**
+     * Constructor
+     * @param dashboard Current dashboard (initially the one shown at wake)
+     * @param scratch Model used to parse incoming payloads
+     */
+    LiveDashboard(DashboardModel& dashboard, DashboardModel& scratch);
+
+    /**
+     * Start merging messages
+     * @param nodeName Section to extract from fleet payloads
+     * @param aggregator Per-sensor table in wildcard topic mode, else nullptr
+     */
+    bool begin(const char* nodeName, TopicAggregator* aggregator);
+
+    /**
+     * Message handler for NetworkManager::listen() (network task)
+     */
+    static void onMessage(const char* topic, const uint8_t* payload, unsigned int length, void* context);
+
+    /**
+     * Force a render at the next due() check (e.g. battery level changed)
+     */
+    void invalidate(unsigned long now);
+
+    /**
+     * Whether a render is due
+     */
+    bool due(unsigned long now) const;
+
+    /**
+     * Copy the dashboard to render and clear the pending change
+     * @param now Current time, starts the rate limit interval
+     */
+    void take(DashboardModel& out, unsigned long now);
+
+    /**
+     * Sequence number to request a snapshot from, when a delta did not apply
+     * @return true once per failed delta
+     */
+    bool takeResync(uint32_t& seq);
+
+    uint32_t messages;    // Messages received
+    uint32_t renders;     // Renders taken
+
+private:
+    DashboardModel& dashboard;
+    DashboardModel& scratch;
+    TopicAggregator* aggregator;
+    const char* nodeName;
+    SemaphoreHandle_t lock;
+
+    bool pending;               // Dashboard changed since the last take()
+    unsigned long changedAt;    // First change since the last take()
+    unsigned long renderedAt;   // Last take()
+    bool rendered;              // take() happened at least once
+    bool resyncNeeded;
+
+    /**
+     * Merge a message (lock held)
+     * @return true if the dashboard changed
+     */
+    bool merge(const char* topic, const uint8_t* payload, unsigned int length);
+};
+
+#endif // LIVE_DASHBOARD_H
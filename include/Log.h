@@ -0,0 +1,110 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stddef.h>
+
+/**
+ * Logging
+ *
+ * LOGE/LOGW/LOGI/LOGD/LOGV format a line into a lock-free ring buffer
+ * and return; a low-priority task writes the lines to Serial. Callers no
+ * longer wait for the UART (115200 baud is ~87 µs per byte), and lines
+ * from different tasks come out whole.
+ *
+ * The level is chosen at build time with -D LOG_LEVEL=<0..5>: calls above
+ * it are still type-checked but sit in dead code, so their arguments are
+ * never evaluated and their format strings are not in the image. With
+ * -D LOG_CRASH_TAIL=1 the last lines are also kept in RTC memory and
+ * reported after a panic, watchdog or brownout reset.
+ *
+ * Lines are written without a line ending (it is added on output) and
+ * truncated to LOG_LINE_MAX. When the ring is full new lines are dropped
+ * and counted.
+ */
+#define LOG_LEVEL_NONE    0
+#define LOG_LEVEL_ERROR   1   // Failures the firmware cannot recover from in this wake
+#define LOG_LEVEL_WARN    2   // Fallbacks, timeouts, dropped data
+#define LOG_LEVEL_INFO    3   // Progress of a wake (release builds)
+#define LOG_LEVEL_DEBUG   4   // Per-item details, sizes and timings
+#define LOG_LEVEL_VERBOSE 5   // Payloads, signatures, keys
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#ifndef LOG_CRASH_TAIL
+#define LOG_CRASH_TAIL 0
+#endif
+
+/**
+ * Start the log task and collect the crash tail of the previous boot
+ * Call right after Serial.begin(), before anything is logged.
+ */
+void log_init();
+
+/**
+ * Queue one line (use the LOG macros)
+ */
+void log_write(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * Wait until the queued lines have been written
+ * Call before deep sleep and restarts.
+ */
+void log_flush(unsigned long timeoutMs);
+
+#if LOG_CRASH_TAIL
+#include <Arduino.h>
+
+/**
+ * Last lines before a panic, watchdog or brownout reset as compact JSON
+ * {"reason":"panic","lines":["...",...]}
+ * @return false if the previous boot did not crash
+ */
+bool log_crash_tail(String& out);
+#endif
+
+#if !defined(ARDUINO)
+/**
+ * Receives each line (native builds; default: stdout)
+ */
+typedef void (*LogSink)(const char* line, size_t length);
+
+/**
+ * Replace the output (native builds)
+ * @param synchronous Write from the caller instead of the log task
+ */
+void log_set_sink(LogSink sink, bool synchronous);
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOGE(...) log_write(__VA_ARGS__)
+#else
+#define LOGE(...) do { if (0) log_write(__VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOGW(...) log_write(__VA_ARGS__)
+#else
+#define LOGW(...) do { if (0) log_write(__VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOGI(...) log_write(__VA_ARGS__)
+#else
+#define LOGI(...) do { if (0) log_write(__VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOGD(...) log_write(__VA_ARGS__)
+#else
+#define LOGD(...) do { if (0) log_write(__VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_VERBOSE
+#define LOGV(...) log_write(__VA_ARGS__)
+#else
+#define LOGV(...) do { if (0) log_write(__VA_ARGS__); } while (0)
+#endif
+
+#endif // LOG_H
@@ -0,0 +1,67 @@
+#ifndef MEMORY_PROBE_H
+#define MEMORY_PROBE_H
+
+#include <stdint.h>
+#include "Config.h"
+
+/**
+ * Memory Probe
+ *
+ * Samples free heap, the allocator's minimum-ever free heap, the largest
+ * free block and the stack high-water mark of the calling task at phase
+ * boundaries (wake scheduler phases, network states, parser and OTA
+ * tasks). The lowest values of a wake are reported in the LWT, the per
+ * phase table on Serial.
+ *
+ * Native builds sample the same way: the heap is modelled as
+ * MEMORY_PROBE_HOST_HEAP bytes minus what malloc has handed out, and the
+ * stack high-water mark is found in threads whose stack was painted with
+ * memory_probe_paint() (see tools/memory_probe.cpp).
+ */
+
+/**
+ * Lowest stack headroom of one task
+ */
+struct MemoryProbeStack {
+    char task[16];
+    uint32_t size;      // Stack size in bytes, 0 if unknown
+    uint32_t minFree;   // High-water mark: fewest free bytes seen
+};
+
+/**
+ * Lowest values seen so far
+ */
+struct MemoryProbeReport {
+    uint32_t heapMin;           // Lowest free heap at a sample
+    const char* heapMinPhase;   // Phase of that sample
+    uint32_t heapMinEver;       // Allocator's minimum-ever free heap
+    uint32_t blockMin;          // Smallest largest-free-block at a sample
+    int stackCount;
+    MemoryProbeStack stacks[MEMORY_PROBE_TASKS];
+};
+
+/**
+ * Sample heap and the calling task's stack
+ * @param phase Phase that just ended (static string)
+ */
+void memory_probe_sample(const char* phase);
+
+/**
+ * Lowest values seen so far
+ */
+const MemoryProbeReport& memory_probe_report();
+
+/**
+ * Print the per-phase samples and stack headroom
+ */
+void memory_probe_print();
+
+#if !defined(ARDUINO)
+/**
+ * Fill a thread stack with the pattern the high-water mark is searched for
+ * (native builds, before the thread starts)
+ */
+void memory_probe_paint(void* stack, uint32_t size);
+#endif
+
+#endif // MEMORY_PROBE_H
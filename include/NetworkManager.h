@@ -5,14 +5,30 @@
 #include <WiFiManager.h>
 #include <PubSubClient.h>
 #include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "NetworkStateMachine.h"
 
 /**
  * Network Manager
  * 
  * Handles WiFi configuration portal and MQTT communication.
+ *
+ * Connections are driven by NetworkStateMachine in a dedicated task: WiFi
+ * events and socket readiness wake the task instead of polling loops, and
+ * progress is published as event group bits (NET_BIT_*) so the caller can
+ * start the connection, do other work, and wait only when it needs the
+ * network. PubSubClient calls are serialized with a mutex.
  */
-class NetworkManager {
+class NetworkManager : private NetworkTransport {
 public:
+    /**
+     * Handler for collected messages
+     */
+    typedef void (*MessageHandler)(const char* topic, const uint8_t* payload, unsigned int length, void* context);
+
     /**
      * Constructor
      */
@@ -38,20 +54,29 @@ public:
     bool startConfigPortal(const char* portalName, const char* password = NULL, int timeoutSeconds = 300);
 
     /**
-     * Connect to WiFi using saved credentials
-     * @return true if connected successfully
+     * Start connecting to WiFi using saved credentials (non-blocking)
+     * Wait for NET_BIT_WIFI to know the result.
      */
-    bool connectWiFi();
+    void startWiFi();
 
     /**
-     * Connect to MQTT broker using saved credentials
+     * Request the MQTT connection using saved broker settings (non-blocking)
+     * The broker is connected as soon as WiFi is up; wait for NET_BIT_MQTT.
      * @param clientId MQTT client ID
-     * @return true if connected successfully
+     * @return false if no broker is configured
+     */
+    bool startMQTT(const char* clientId);
+
+    /**
+     * Wait until all of the given status bits are set
+     * @param bits NET_BIT_* mask
+     * @param timeoutMs Timeout in milliseconds
+     * @return false on timeout or when the connection attempt failed
      */
-    bool connectMQTT(const char* clientId);
+    bool waitFor(uint32_t bits, unsigned long timeoutMs);
 
     /**
-     * Set MQTT Last Will and Testament (must be called before connectMQTT)
+     * Set MQTT Last Will and Testament (must be called before startMQTT)
      * @param topic LWT topic
      * @param payload LWT payload
      */
@@ -64,6 +89,13 @@ public:
      */
     bool subscribeMQTT(const char* topic);
 
+    /**
+     * Unsubscribe from MQTT topic
+     * @param topic Topic to unsubscribe from
+     * @return true if the request was sent
+     */
+    bool unsubscribeMQTT(const char* topic);
+
     /**
      * Get last retained message from subscribed topic
      * Waits for message with timeout
@@ -72,6 +104,46 @@ public:
      */
     String getLastRetainedMessage(unsigned long timeoutMs = 5000);
 
+    /**
+     * Wait for the retained message of a topic, streaming its payload
+     * Payload bytes are written to sink as they arrive instead of being
+     * buffered, so the message may exceed MQTT_BUFFER_SIZE. The client
+     * writes before the topic is known: topic must be the only subscription.
+     * @param topic Topic the message is expected on
+     * @param sink Stream receiving the payload
+     * @param timeoutMs Timeout in milliseconds
+     * @return true if the message was received
+     */
+    bool streamRetainedMessage(const char* topic, Stream& sink, unsigned long timeoutMs = 5000);
+
+    /**
+     * Collect the retained messages of all subscribed topics
+     * Returns once no message arrived for idleMs (the broker sends retained
+     * messages in a burst right after subscribing) or after timeoutMs.
+     * @param handler Called for every message
+     * @param context Passed to the handler
+     * @param timeoutMs Maximum collection time in milliseconds
+     * @param idleMs Quiet period ending the collection
+     * @return Number of messages received
+     */
+    int collectRetainedMessages(MessageHandler handler, void* context,
+                                unsigned long timeoutMs, unsigned long idleMs);
+
+    /**
+     * Pass every incoming message to a handler until disconnected (always-on mode)
+     * Messages are buffered, so payloads larger than LIVE_MQTT_BUFFER_SIZE
+     * are dropped. The handler runs on the network task and must not call
+     * back into NetworkManager.
+     * @param handler Called for every message
+     * @param context Passed to the handler
+     */
+    void listen(MessageHandler handler, void* context);
+
+    /**
+     * Current status bits (NET_BIT_*)
+     */
+    uint32_t status() const;
+
     /**
      * Publish MQTT message
      * @param topic Topic to publish to
@@ -104,6 +176,10 @@ private:
     WiFiManagerParameter* paramMqttPassword;
     WiFiManagerParameter* paramMqttTopic;
     WiFiManagerParameter* paramSleepHours;
+    WiFiManagerParameter* paramAlwaysOn;
+    WiFiManagerParameter* paramQuietHours;
+    WiFiManagerParameter* paramTimezone;
+    WiFiManagerParameter* paramPublishPeriod;
 
     // Storage for parameter values
     char nodeNameStr[64];
@@ -113,10 +189,56 @@ private:
     char mqttPasswordStr[64];
     char mqttTopicStr[128];
     char sleepHoursStr[16];
+    char alwaysOnStr[4];
+    char quietHoursStr[8];
+    char timezoneStr[48];
+    char publishPeriodStr[8];
 
+    // Network task and its state machine
+    NetworkStateMachine machine;
+    TaskHandle_t netTask;
+    QueueHandle_t netEvents;
+    EventGroupHandle_t netBits;
+    SemaphoreHandle_t mqttLock;
+    
+    // Broker settings used by connect attempts
+    String clientId;
+    String brokerUser;
+    String brokerPassword;
+    
     // Last received message
     String lastMessage;
-    bool messageReceived;
+    
+    // Streamed message (payload goes to the stream, not lastMessage)
+    Stream* payloadSink;
+    String streamTopic;
+    
+    /**
+     * Stream that counts and discards the payload bytes PubSubClient copies
+     * to it. PubSubClient cannot clear a stream once set, and with one set it
+     * delivers oversized messages cut to its buffer instead of dropping them;
+     * installed for live mode, the count tells them apart.
+     */
+    class PayloadCounter : public Stream {
+    public:
+        size_t bytes = 0;
+        
+        size_t write(uint8_t c) override;
+        int available() override;
+        int read() override;
+        int peek() override;
+    };
+    PayloadCounter liveCounter;
+    
+    // Collected messages (passed to the handler, not stored)
+    MessageHandler messageHandler;
+    void* handlerContext;
+    int messageCount;
+    
+    // Incoming packets are only read while a caller waits for a delivery
+    // or a listener is installed
+    bool deliveryArmed;
+    bool listening;
     
     // Last Will Testament
     String lwtTopic;
@@ -127,6 +249,43 @@ private:
      */
     void loadSettings();
 
+    /**
+     * Create the network task and its queue, event group and mutex
+     */
+    void startTask();
+
+    /**
+     * Queue an event for the network task
+     */
+    void post(NetEvent event);
+
+    /**
+     * Wait for a message delivery (NET_BIT_DELIVERED)
+     */
+    bool waitDelivered(unsigned long timeoutMs);
+
+    /**
+     * Network task body
+     */
+    static void netTaskMain(void* param);
+
+    /**
+     * Wait until the MQTT socket is readable or timeoutMs elapsed
+     */
+    void waitReadable(uint32_t timeoutMs);
+
+    // NetworkTransport
+    void wifiBegin() override;
+    void wifiEnd() override;
+    bool mqttConnect() override;
+    void mqttDisconnect() override;
+    bool mqttPoll() override;
+
+    /**
+     * WiFi event handler (runs in the WiFi event task)
+     */
+    static void onWiFiEvent(arduino_event_id_t event, WiFiEventInfo_t info);
+
     /**
      * Save settings callback (static for WiFiManager)
      */
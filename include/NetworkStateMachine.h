@@ -0,0 +1,144 @@
+#ifndef NETWORK_STATE_MACHINE_H
+#define NETWORK_STATE_MACHINE_H
+
+#include <stdint.h>
+
+/**
+ * Network connection states
+ */
+enum NetState : uint8_t {
+    NET_IDLE,               // Nothing started
+    NET_WIFI_CONNECTING,    // Waiting for an IP address
+    NET_WIFI_READY,         // WiFi up, MQTT not requested yet
+    NET_MQTT_CONNECTING,    // MQTT connect attempt due
+    NET_MQTT_RETRY,         // Waiting before the next connect attempt
+    NET_ONLINE,             // Broker connected, incoming packets processed
+    NET_FAILED,             // Gave up (timeout)
+    NET_STOPPED             // Disconnected on request
+};
+
+/**
+ * Inputs of the state machine
+ */
+enum NetEvent : uint8_t {
+    NET_EV_START_WIFI,      // Caller: start WiFi
+    NET_EV_START_MQTT,      // Caller: connect to the broker once WiFi is up
+    NET_EV_WIFI_UP,         // WiFi stack: got IP
+    NET_EV_WIFI_DOWN,       // WiFi stack: disconnected
+    NET_EV_STOP             // Caller: disconnect everything
+};
+
+/**
+ * Status bits, mirrored into a FreeRTOS event group by NetworkManager
+ */
+#define NET_BIT_WIFI        (1 << 0)
+#define NET_BIT_MQTT        (1 << 1)
+#define NET_BIT_SUBSCRIBED  (1 << 2)
+#define NET_BIT_DELIVERED   (1 << 3)
+#define NET_BIT_FAILED      (1 << 4)
+#define NET_BIT_STOPPED     (1 << 5)
+
+/**
+ * Side effects of the state machine, implemented over WiFi/PubSubClient on
+ * the device and by a fake on the host
+ */
+class NetworkTransport {
+public:
+    virtual ~NetworkTransport() {}
+
+    /**
+     * Start WiFi association (result arrives as NET_EV_WIFI_UP)
+     */
+    virtual void wifiBegin() = 0;
+
+    /**
+     * Disconnect WiFi
+     */
+    virtual void wifiEnd() = 0;
+
+    /**
+     * One MQTT connect attempt
+     * @return true if the broker accepted the connection
+     */
+    virtual bool mqttConnect() = 0;
+
+    /**
+     * Disconnect from the broker
+     */
+    virtual void mqttDisconnect() = 0;
+
+    /**
+     * Process pending incoming packets
+     * @return false if the broker connection was lost
+     */
+    virtual bool mqttPoll() = 0;
+};
+
+/**
+ * Network State Machine
+ *
+ * Connection logic of NetworkManager without any I/O of its own: events and
+ * the current time go in, transport calls and status bits come out. Runs in
+ * the network task on the device; has no Arduino dependencies so the
+ * transitions can be driven on the host with a fake transport.
+ */
+class NetworkStateMachine {
+public:
+    /**
+     * Constructor
+     * @param transport Side effects
+     * @param wifiTimeoutMs Give up if WiFi is not up after this long
+     * @param mqttTimeoutMs Give up if the broker is not connected after this long
+     * @param retryMs Pause between MQTT connect attempts
+     */
+    NetworkStateMachine(NetworkTransport& transport, uint32_t wifiTimeoutMs,
+                        uint32_t mqttTimeoutMs, uint32_t retryMs);
+
+    /**
+     * Handle an event
+     */
+    void handle(NetEvent event, uint32_t now);
+
+    /**
+     * Run due work (connect attempts, timeouts, polling)
+     * @return Milliseconds until step() needs to run again without events
+     */
+    uint32_t step(uint32_t now);
+
+    NetState state() const { return current; }
+    uint32_t bits() const { return status; }
+
+    /**
+     * Readable name of a state
+     */
+    static const char* stateName(NetState state);
+
+private:
+    NetworkTransport& transport;
+    uint32_t wifiTimeoutMs;
+    uint32_t mqttTimeoutMs;
+    uint32_t retryMs;
+
+    NetState current;
+    uint32_t status;
+    bool mqttRequested;
+    uint32_t deadline;    // Timeout of the current connect phase
+    uint32_t retryAt;     // Next MQTT connect attempt
+
+    /**
+     * Enter a state
+     */
+    void enter(NetState next, uint32_t now);
+
+    /**
+     * WiFi is up: connect to the broker if requested
+     */
+    void wifiReady(uint32_t now);
+
+    /**
+     * Whether a time has been reached (wrap-safe)
+     */
+    static bool reached(uint32_t now, uint32_t time) { return (int32_t)(now - time) >= 0; }
+};
+
+#endif // NETWORK_STATE_MACHINE_H
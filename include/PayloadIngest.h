@@ -0,0 +1,82 @@
+#ifndef PAYLOAD_INGEST_H
+#define PAYLOAD_INGEST_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/stream_buffer.h>
+#include <freertos/task.h>
+#include "DashboardModel.h"
+
+/**
+ * Streaming Payload Ingestion
+ *
+ * Stream handed to the MQTT client: payload bytes are written into a small
+ * FreeRTOS stream buffer as they come off the socket, and a parser task
+ * consumes them concurrently (JSON or MessagePack, see DashboardParser.h),
+ * keeping only the dashboard fields. Memory use
+ * is PAYLOAD_STREAM_BUFFER plus the filtered document, independent of the
+ * payload size, so payloads far larger than MQTT_BUFFER_SIZE are accepted.
+ *
+ * The parser task starts with the first payload byte; finish() signals the
+ * end of the payload and waits for the result. Bytes written after finish()
+ * are dropped. The model belongs to the parser task until finish() returns,
+ * also on a timeout: the parse is then aborted and the task waited for.
+ */
+class PayloadIngest : public Stream {
+public:
+    /**
+     * Constructor
+     * @param model Model filled by the parser task
+     */
+    explicit PayloadIngest(DashboardModel& model);
+
+    /**
+     * Allocate the stream buffer
+     * @param nodeName Section to extract from fleet payloads
+     * @return true if ready to receive
+     */
+    bool begin(const char* nodeName);
+
+    /**
+     * End of payload: wait for the parser task to complete
+     * On a timeout the parse is aborted and the task waited for until it exits.
+     * @param timeoutMs Maximum wait in milliseconds before aborting
+     * @return true if a payload was received and parsed into the model
+     */
+    bool finish(unsigned long timeoutMs = PAYLOAD_PARSE_TIMEOUT);
+
+    /**
+     * Payload bytes received so far
+     */
+    uint32_t receivedBytes() const { return received; }
+
+    // Producer side (MQTT client)
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t length) override;
+
+    // Consumer side (parser task)
+    int available() override;
+    int read() override;
+    int peek() override;
+
+private:
+    DashboardModel& model;
+    const char* nodeName;
+    StreamBufferHandle_t buffer;
+    SemaphoreHandle_t done;
+    TaskHandle_t task;
+    volatile bool ended;    // No more payload bytes will be written
+    volatile bool parsed;   // Parser returned, further bytes are dropped
+    volatile bool aborted;  // Parse timed out, read() reports the end
+    bool result;
+    int peeked;
+    uint32_t received;
+
+    /**
+     * Parser task entry point
+     */
+    static void parserTask(void* param);
+};
+
+#endif // PAYLOAD_INGEST_H
@@ -0,0 +1,99 @@
+#ifndef PHASE_TRACE_H
+#define PHASE_TRACE_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+/**
+ * Wake Phase Trace
+ *
+ * Scoped timers for the phases of a wake, timed with esp_timer (µs since
+ * boot). Records go into a fixed table in RTC slow memory, so the trace of
+ * a wake survives deep sleep including its sleep preparation; the next
+ * wake publishes it as a compact JSON record on displays/<node>/trace.
+ *
+ * Built only with -D PHASE_TRACE=1; otherwise the macros expand to nothing
+ * and no RTC memory is used.
+ */
+enum TracePhase : uint8_t {
+    TRACE_SETTINGS,         // Settings (NVS) init
+    TRACE_BATTERY,          // Fuel gauge snapshot
+    TRACE_WIFI,             // WiFi association
+    TRACE_DHCP,             // Association until IP address
+    TRACE_MQTT_CONNECT,     // One broker connect attempt
+    TRACE_RETAINED_WAIT,    // One wait for retained messages
+    TRACE_PARSE,            // Payload parse / sensor table build
+    TRACE_RENDER,           // Whole panel update
+    TRACE_DRAW,             // Drawing into the frame buffer
+    TRACE_PANEL,            // SPI transfer and panel refresh
+    TRACE_SLEEP_PREP,       // Peripheral shutdown before deep sleep
+    TRACE_PHASE_COUNT
+};
+
+#ifndef PHASE_TRACE
+#define PHASE_TRACE 0
+#endif
+
+#if PHASE_TRACE
+
+/**
+ * Start this wake's trace, keeping the previous one for publishing
+ * Call first thing in setup().
+ */
+void trace_init();
+
+/**
+ * Open a phase that ends in another scope or task
+ */
+void trace_begin(TracePhase phase);
+
+/**
+ * Close a phase opened with trace_begin() (ignored if not open)
+ */
+void trace_end(TracePhase phase);
+
+/**
+ * Record a finished phase
+ */
+void trace_record(TracePhase phase, int64_t startUs, int64_t endUs);
+
+/**
+ * Trace of the previous wake as compact JSON
+ * {"wake":N,"dropped":N,"phases":[["name",start_us,duration_us],...]}
+ * @return false if there is none (cold boot)
+ */
+bool trace_previous_json(String& out);
+
+/**
+ * Phase name used in the published record
+ */
+const char* trace_phase_name(TracePhase phase);
+
+/**
+ * Records a phase for the lifetime of the object
+ */
+class TraceScope {
+public:
+    explicit TraceScope(TracePhase phase) : phase(phase), startUs(esp_timer_get_time()) {}
+    ~TraceScope() { trace_record(phase, startUs, esp_timer_get_time()); }
+
+private:
+    TracePhase phase;
+    int64_t startUs;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(phase) TraceScope TRACE_CONCAT(traceScope, __LINE__)(phase)
+#define TRACE_BEGIN(phase) trace_begin(phase)
+#define TRACE_END(phase) trace_end(phase)
+
+#else
+
+#define TRACE_SCOPE(phase) ((void)0)
+#define TRACE_BEGIN(phase) ((void)0)
+#define TRACE_END(phase) ((void)0)
+
+#endif // PHASE_TRACE
+
+#endif // PHASE_TRACE_H
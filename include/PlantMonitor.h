@@ -2,10 +2,12 @@
 #define PLANT_MONITOR_H
 
 #include <Arduino.h>
-#include <ArduinoJson.h>
-#include <GxEPD2_3C.h>
-#include <gdey3c/GxEPD2_420c_GDEY042Z98.h>
 #include "Config.h"
+#include "DashboardLayout.h"
+#include "DashboardModel.h"
+#include "DisplayPanel.h"
+#include "RefreshPolicy.h"
+#include "RtcStore.h"
 
 /**
  * Plant Moisture Monitor Display Manager
@@ -27,20 +29,27 @@ public:
     void init();
 
     /**
-     * Main entry point - updates display from JSON data and battery level
+     * Main entry point - updates display from the dashboard model and battery level
      * 
-     * @param jsonDoc JSON document containing plant data and update date
-     *                Expected format:
-     *                {
-     *                  "updateDate": "2025-10-03 22:30",
-     *                  "plants": [
-     *                    {"name": "Plant Name", "moisture": 85},
-     *                    ...
-     *                  ]
-     *                }
+     * @param model Plant data and update date (see DashboardParser.h)
      * @param batteryPercent Battery level percentage (0-100)
      */
-    void updateDisplay(const JsonDocument& jsonDoc, int batteryPercent);
+    void updateDisplay(const DashboardModel& model, int batteryPercent);
+
+    /**
+     * Set the content expected for this wake (e.g. the cached dashboard)
+     * before the real data arrives, for prerender()
+     */
+    void expect(const DashboardModel& model);
+
+    /**
+     * Speculatively draw the header of the expected content into the frame
+     * buffer, e.g. while the network is busy. updateDisplay() then only
+     * draws the widget area when the actual header turned out identical.
+     * No-op for paged displays (no full frame buffer to keep it in).
+     * @param batteryPercent Battery level percentage (0-100)
+     */
+    void prerender(int batteryPercent);
 
     /**
      * Put display into deep sleep mode (low power)
@@ -64,49 +73,101 @@ public:
      */
     void showConfigScreen(const char* ssid, const char* password);
 
-private:
-    // Plant data structure
-    struct PlantData {
-        String name;
-        int moisture;  // 0-100%
+    /**
+     * Statistics of the last panel update, reported in the LWT
+     */
+    struct RefreshStats {
+        const char* mode;    // "full", "mono", "partial" or "skip"
+        uint32_t spiBytes;   // Bytes written to the controller RAM
+        uint32_t refreshMs;  // Time spent transferring and refreshing
     };
 
-    // Display instance
-    GxEPD2_3C<GxEPD2_420c_GDEY042Z98, GxEPD2_420c_GDEY042Z98::HEIGHT> display;
+    /**
+     * Get statistics of the last updateDisplay() call
+     */
+    const RefreshStats& getRefreshStats() const { return refreshStats; }
 
-    // Plant data storage
-    PlantData plants[6];
-    int plantCount;
+private:
+    typedef PanelTraits<PanelDisplay> Panel;
 
-    // Display metadata
-    String updateDate;
+    // Display instance (panel selected at build time)
+    PanelDisplay display;
+
+    // Dashboard content
+    DashboardModel model;
     int batteryPercent;
 
-    // Dynamic layout variables (calculated after header)
-    int headerHeight;
-    int gaugeW;
-    int gaugeH;
+    // Layout of the current frame (computed once per render)
+    DashboardLayout layout;
+
+    // Widget fingerprints, page rotation and refresh history persisted across deep sleep
+    struct FrameState {
+        uint8_t version;
+        uint8_t panelKnown;    // Panel shows the frame described by the fingerprints
+        uint8_t plantCount;
+        uint8_t page;          // Page to show on the next wake
+        uint32_t header;
+        uint32_t cells[MAX_PAGE_CELLS];
+        RefreshPolicy::History history;
+    };
+
+    // RTC memory, copied to NVS when sealed often enough (see RtcStore.h)
+    static RtcRecord<FrameState> frameRecord;
+
+    FrameState frameState;
+    RefreshPolicy refreshPolicy;
+    RefreshStats refreshStats;
+
+    // Header fingerprint already drawn into the frame buffer (0 = none)
+    uint32_t prerenderedHeader;
 
     /**
-     * Draw header with title, update date, and battery
-     * @return Total height used by the header in pixels
+     * Compute the layout of the current frame
      */
-    int drawHeader();
+    void computeLayout();
 
     /**
-     * Draw a single plant moisture gauge
+     * Draw header and all widgets of the page (clipped to the active window)
      */
-    void drawGauge(int x, int y, int w, int h, const char* name, int moisture);
+    void drawFrame();
 
     /**
-     * Render the complete display
+     * Draw the widgets of the page
      */
-    void render();
+    void drawWidgets();
+
+    /**
+     * Draw the frame into the full frame buffer, reusing a pre-rendered header
+     * @param header Fingerprint of the header of this frame
+     * @return true if the pre-rendered header was reused
+     */
+    bool drawBuffered(uint32_t header);
+
+    /**
+     * Compute content fingerprints for the header and every widget cell
+     */
+    void computeFingerprints(FrameState& state);
+
+    /**
+     * Whether the frame uses red (critical plants or low battery)
+     */
+    bool frameHasRed() const;
 
     /**
-     * Parse JSON data and populate internal plant array
+     * Load/store widget fingerprints from the RTC record
      */
-    void parseJsonData(const JsonDocument& jsonDoc);
+    void loadFrameState();
+    void saveFrameState();
+
+    /**
+     * Forget stored fingerprints so the next render is a full refresh
+     */
+    void invalidateFrameState();
+
+    /**
+     * Render the complete display
+     */
+    void render();
 };
 
 #endif // PLANT_MONITOR_H
@@ -3,7 +3,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
-#include <Adafruit_MAX1704X.h>
+#include "BatteryGauge.h"
 
 /**
  * Power Management
@@ -18,34 +18,50 @@ public:
     PowerManager();
 
     /**
-     * Initialize battery sensor (call this after Serial is ready)
+     * Read the battery gauge: one I2C burst, percentage filtered with the
+     * history kept in RTC memory (see BatteryGauge.h)
+     * Call once per wake, or per poll in always-on mode; the getters below
+     * return this snapshot without touching the bus.
      */
-    void initBatterySensor();
+    const BatteryGauge::Snapshot& readBattery();
+
+    /**
+     * Take the battery gauge out of forced hibernate (always-on mode)
+     * Deep sleep leaves it hibernating, which samples far less often; the
+     * power-on thresholds let it measure at full rate under load.
+     */
+    void keepGaugeAwake();
 
     /**
      * Get battery voltage in volts
-     * @return Battery voltage (placeholder: returns 3.9V)
+     * @return Battery voltage from the snapshot (placeholder: returns 3.9V)
      */
     float getBatteryVoltage();
 
     /**
      * Get battery percentage (0-100%)
-     * @return Battery percentage from MAX1704X or placeholder value
+     * @return Filtered battery percentage, or placeholder value
      */
     int getBatteryPercentage();
 
     /**
      * Get battery charge rate
-     * @return Charge rate from MAX1704X in %/hr, or 0 if sensor not available
+     * @return Charge rate from the snapshot in %/hr, or 0 if sensor not available
      */
     float getChargeRate();
 
     /**
-     * Check if battery sensor (MAX1704X) is present and working
-     * @return true if MAX1704X sensor is detected and functional
+     * Check if battery sensor (MAX17048) is present and working
+     * @return true if the gauge answered the last snapshot
      */
     bool isBatterySensorPresent();
 
+    /**
+     * I2C bus time since boot
+     * @return Microseconds spent in gauge transactions
+     */
+    uint32_t getI2cMicros();
+
     /**
      * Check if deep sleep is disabled via GPIO pin
      * @return true if GPIO pin is LOW (deep sleep disabled)
@@ -53,18 +69,30 @@ public:
     bool isDeepSleepDisabled();
 
     /**
-     * Enter deep sleep mode for specified hours
-     * @param hours Number of hours to sleep
+     * Enter deep sleep mode for specified seconds
+     * @param seconds Number of seconds to sleep (sleep timer time)
      */
-    void enterDeepSleep(int hours);
+    void enterDeepSleep(uint32_t seconds);
 
 private:
     // Deep sleep disable pin
     int deepSleepDisablePin;
     
-    // MAX1704X battery fuel gauge
-    Adafruit_MAX17048 maxlipo;
-    bool maxLipoFound;
+    /**
+     * Read BURST_BYTES from the gauge's first register
+     */
+    bool readGauge(uint8_t* burst);
+    
+    /**
+     * Write one gauge register
+     */
+    bool writeGauge(uint8_t reg, uint16_t value);
+    
+    // MAX17048 battery fuel gauge
+    bool busStarted;
+    BatteryGauge::Snapshot battery;
+    int batteryPercent;
+    uint32_t i2cMicros;
 };
 
 #endif // POWER_MANAGER_H
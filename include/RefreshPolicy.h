@@ -0,0 +1,104 @@
+#ifndef REFRESH_POLICY_H
+#define REFRESH_POLICY_H
+
+#include <stdint.h>
+
+/**
+ * Panel refresh modes, ordered from cheapest to most expensive
+ */
+enum RefreshMode : uint8_t {
+    REFRESH_SKIP = 0,   // Panel already shows the frame
+    REFRESH_PARTIAL,    // Refresh only the changed window
+    REFRESH_MONO,       // Whole screen with the fast black/white waveform
+    REFRESH_FULL,       // Whole screen with the full (tri-color) waveform
+    REFRESH_MODE_COUNT
+};
+
+/**
+ * Refresh Policy
+ *
+ * Sits between PlantMonitor and the panel driver and decides how each frame
+ * is pushed to the panel, based on frame content, panel capabilities and a
+ * refresh history that the caller keeps across deep sleep.
+ *
+ * make sim-refresh checks its decisions for each panel type.
+ */
+class RefreshPolicy {
+public:
+    /**
+     * Panel driver capabilities
+     */
+    struct PanelCaps {
+        bool partial;           // Supports partial window refresh
+        bool mono;              // Black/white-only refresh is faster than a full one
+        bool red;               // Has a red plane (tri-color)
+        uint16_t fullMs;        // Nominal full refresh time
+        uint16_t partialMs;     // Nominal partial/mono refresh time
+    };
+
+    /**
+     * Description of the frame about to be displayed
+     */
+    struct Frame {
+        bool panelKnown;        // Panel content matches the stored history
+        bool changed;           // At least one widget differs from the panel
+        uint32_t dirtyArea;     // Pixels covered by the changed region
+        uint32_t screenArea;    // Total pixels on the panel
+        bool hasRed;            // Frame uses red (critical plants or low battery)
+    };
+
+    /**
+     * Refresh history, persisted by the caller across wakes
+     */
+    struct History {
+        uint8_t ghosting;       // Fast refreshes since the last full refresh
+        uint8_t redOnPanel;     // Panel currently shows red pixels
+        uint8_t lastMode;       // RefreshMode of the last wake
+        uint8_t reserved;
+        uint16_t costMs[REFRESH_MODE_COUNT];  // Smoothed measured time per mode
+    };
+
+    /**
+     * Result of decide()
+     */
+    struct Decision {
+        RefreshMode mode;
+        const char* reason;
+        uint32_t estimatedMs;
+    };
+
+    /**
+     * Constructor
+     * @param caps Capabilities of the panel driver in use
+     */
+    explicit RefreshPolicy(const PanelCaps& caps);
+
+    /**
+     * Reset history to the state of a panel with unknown content
+     */
+    void reset(History& history) const;
+
+    /**
+     * Decide how to push a frame to the panel
+     */
+    Decision decide(const Frame& frame, const History& history) const;
+
+    /**
+     * Update history after the refresh has been performed
+     * @param measuredMs Measured time spent on the refresh
+     * @param hasRed Whether the displayed frame contains red
+     */
+    void record(History& history, const Decision& decision, uint32_t measuredMs, bool hasRed) const;
+
+    /**
+     * Human readable name of a refresh mode
+     */
+    static const char* modeName(RefreshMode mode);
+
+private:
+    PanelCaps caps;
+
+    Decision make(RefreshMode mode, const char* reason, const History& history) const;
+};
+
+#endif // REFRESH_POLICY_H
@@ -0,0 +1,119 @@
+#ifndef RTC_STORE_H
+#define RTC_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Config.h"
+
+/**
+ * RTC State Store
+ *
+ * State kept across deep sleep lives in RTC slow memory, which stays
+ * powered in deep sleep (about 5 uA more than with it off, see README
+ * Power Management) and is lost on power-on and brownout. Each record carries
+ * a header with an identifier, a layout version, its size and a CRC32 of
+ * its data, so a record left by other firmware, a changed layout or memory
+ * garbled by a brownout is discarded instead of trusted.
+ *
+ * Records are opened on first use each wake, changed in place while awake
+ * and sealed (CRC computed) right before deep sleep; a record not sealed is
+ * not trusted on the next wake. The bootloader reloads RTC memory on every
+ * reset other than a deep sleep wake, so after a restart only the NVS copy
+ * is left.
+ *
+ * Records given an NVS key also survive a power loss: sealing copies them
+ * to flash, but only once RTC_NVS_WRITE_WAKES seals have changed them (or
+ * when flushing, e.g. on a critical battery), so a record changing every
+ * wake costs one flash write per RTC_NVS_WRITE_WAKES wakes. After a power
+ * loss the copy may be that many wakes old.
+ *
+ * The record checks and the NVS write coalescing (RtcStore) are plain C++,
+ * checked on the host by make sim-rtc.
+ */
+
+/**
+ * Header in front of each record
+ * Aligned to 8 bytes, so the data of any record follows it directly.
+ */
+struct alignas(8) RtcHeader {
+    uint32_t magic;         // Record identifier
+    uint16_t version;       // Layout version, bumped when the record changes
+    uint16_t size;          // Data size in bytes
+    uint32_t crc;           // CRC32 of the data, set when sealed
+    uint32_t nvsCrc;        // CRC32 of the data last copied to NVS
+    uint16_t pending;       // Seals since then that changed the data
+    uint16_t reserved;
+};
+
+/**
+ * A record: header directly followed by its data (checked in rtc_store_open)
+ */
+template <typename T>
+struct RtcRecord {
+    RtcHeader header;
+    T data;
+};
+
+class RtcStore {
+public:
+    /**
+     * CRC32 (IEEE 802.3)
+     */
+    static uint32_t crc32(const void* data, size_t length, uint32_t crc = 0);
+    
+    /**
+     * Whether a header and its data form an intact record of this layout
+     */
+    static bool valid(const RtcHeader& header, uint32_t magic, uint16_t version, size_t size);
+    
+    /**
+     * Fresh header for a record of this layout (data not sealed yet)
+     */
+    static void init(RtcHeader& header, uint32_t magic, uint16_t version, size_t size);
+    
+    /**
+     * Seal the record: set the CRC of its data
+     * @return Whether the NVS copy is due (changed data, RTC_NVS_WRITE_WAKES
+     *         seals since the last copy, or flush)
+     */
+    static bool seal(RtcHeader& header, bool flush);
+    
+    /**
+     * Record that the sealed data was copied to NVS
+     */
+    static void markCopied(RtcHeader& header);
+};
+
+#if defined(ARDUINO)
+/**
+ * Open a record on its first use this wake
+ * Restores it from NVS (if it has a key) when the RTC copy is not intact.
+ * Later calls in the same wake return true without checking.
+ * @return false if the record has to be reset by the caller
+ */
+bool rtc_store_open(RtcHeader& header, uint32_t magic, uint16_t version, size_t size, const char* nvsKey = nullptr);
+
+template <typename T>
+bool rtc_store_open(RtcRecord<T>& record, uint32_t magic, uint16_t version, const char* nvsKey = nullptr)
+{
+    // The CRC and the NVS copy cover the size bytes after the header
+    static_assert(offsetof(RtcRecord<T>, data) == sizeof(RtcHeader), "record data must follow the header");
+    return rtc_store_open(record.header, magic, version, sizeof(T), nvsKey);
+}
+
+/**
+ * Whether a record opened this wake came from its NVS copy
+ * Its data may be up to RTC_NVS_WRITE_WAKES wakes old and the time asleep
+ * is unknown.
+ */
+bool rtc_store_restored(const RtcHeader& header);
+
+/**
+ * Seal the records opened this wake; copy them to NVS when due
+ * Call right before deep sleep.
+ * @param flush Copy changed records to NVS now (power loss likely)
+ */
+void rtc_store_seal(bool flush);
+#endif
+
+#endif // RTC_STORE_H
@@ -17,8 +17,12 @@
  * - mqtt_port: MQTT broker port
  * - mqtt_user: MQTT username
  * - mqtt_password: MQTT password
- * - mqtt_topic: MQTT topic to subscribe to
+ * - mqtt_topic: MQTT topic to subscribe to (wildcard filter for per-sensor topics)
  * - sleep_hours: Hours to sleep between updates
+ * - sleep_min, sleep_max: Bounds of the adjusted sleep in minutes (not in the portal)
+ * - quiet_start, quiet_end: Hours of the day without wakes (-1 = none)
+ * - timezone: POSIX TZ string for local time (quiet hours)
+ * - publish_period: Publisher interval in minutes that wakes align to (0 = none)
  * - wifi_tested_ok: Whether WiFi connection was tested successfully
  */
 
@@ -66,6 +70,17 @@ bool settings_get_bool(const char* key, bool default_value = false);
  */
 void settings_put_bool(const char* key, bool value);
 
+/**
+ * Get a binary blob from settings
+ * Returns false if key doesn't exist or its stored size differs from length
+ */
+bool settings_get_bytes(const char* key, void* buffer, size_t length);
+
+/**
+ * Store a binary blob in settings
+ */
+void settings_put_bytes(const char* key, const void* buffer, size_t length);
+
 /**
  * Clear all settings (factory reset)
  */
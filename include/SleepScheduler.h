@@ -0,0 +1,109 @@
+#ifndef SLEEP_SCHEDULER_H
+#define SLEEP_SCHEDULER_H
+
+#include <stdint.h>
+#include "Config.h"
+#include "DashboardModel.h"
+
+/**
+ * Sleep Scheduler
+ *
+ * Chooses the deep sleep duration of each wake, in minutes, starting from
+ * the configured interval (sleep_hours):
+ * - data unchanged for SLEEP_UNCHANGED_WAKES wakes: sleep longer, up to
+ *   SLEEP_MAX_STRETCH times the interval
+ * - data changed in most recent wakes: sleep half as long
+ * - charging: sleep half as long
+ * - battery low: sleep twice as long; critical: the maximum
+ * The result is kept within the configured bounds, and a wake that would
+ * fall into the quiet hours is moved to their end (if the bounds allow).
+ *
+ * Data changes are detected from a fingerprint of the plant readings, kept
+ * in a history the caller persists across deep sleep.
+ *
+ * make sim-sleep runs it against synthetic battery and data histories.
+ */
+class SleepScheduler {
+public:
+    /**
+     * Configured interval and limits
+     */
+    struct Bounds {
+        uint16_t baseMinutes;   // Interval without adjustments
+        uint16_t minMinutes;
+        uint16_t maxMinutes;
+        int8_t quietStart;      // Hour of day quiet hours begin, -1 for none
+        int8_t quietEnd;        // Hour of day quiet hours end
+    };
+    
+    /**
+     * State of this wake
+     */
+    struct Inputs {
+        int batteryPercent;
+        bool gaugePresent;      // Without a fuel gauge battery rules are skipped
+        float chargeRate;       // %/h, positive while charging
+        int minuteOfDay;        // Local time, -1 if the clock is not set
+    };
+    
+    /**
+     * Data change history, persisted by the caller across wakes
+     */
+    struct History {
+        uint32_t fingerprint;   // Plant readings of the last recorded wake
+        uint8_t known;          // fingerprint is set
+        uint8_t changes;        // One bit per comparison (newest in bit 0): data changed
+        uint8_t compared;       // Valid bits in changes, up to 8
+        uint8_t unchanged;      // Consecutive wakes without a change (saturating)
+    };
+    
+    /**
+     * Result of decide()
+     */
+    struct Decision {
+        uint16_t minutes;
+        const char* reason;     // Rule that set the duration
+    };
+    
+    explicit SleepScheduler(const Bounds& bounds);
+    
+    /**
+     * Reset history to a device without data yet
+     */
+    static void reset(History& history);
+    
+    /**
+     * Fingerprint of the plant readings (the update date is ignored)
+     */
+    static uint32_t fingerprint(const DashboardModel& model);
+    
+    /**
+     * Add the data received this wake to the history
+     */
+    static void record(History& history, uint32_t fingerprint);
+    
+    /**
+     * Sleep duration after this wake
+     */
+    Decision decide(const Inputs& inputs, const History& history) const;
+
+private:
+    Bounds bounds;
+    
+    bool quiet(int minuteOfDay) const;
+};
+
+#if defined(ARDUINO)
+/**
+ * Add the dashboard shown this wake to the history kept in RTC memory
+ * Call only for received data, not for status screens.
+ */
+void sleep_schedule_record(const DashboardModel& model);
+
+/**
+ * Sleep duration after this wake, from the history kept in RTC memory
+ */
+SleepScheduler::Decision sleep_schedule_next(const SleepScheduler::Bounds& bounds, const SleepScheduler::Inputs& inputs);
+#endif
+
+#endif // SLEEP_SCHEDULER_H
@@ -0,0 +1,55 @@
+#ifndef TELEMETRY_RING_H
+#define TELEMETRY_RING_H
+
+#include <Arduino.h>
+
+/**
+ * Telemetry Ring
+ *
+ * Per-wake metrics kept in RTC slow memory across deep sleep, in a ring of
+ * TELEMETRY_RING_SIZE entries. Instead of a retained status message every
+ * wake, the ring is published as one batched message on
+ * displays/<node>/telemetry every TELEMETRY_BATCH_WAKES wakes, when it is
+ * full, and on the first wake after a reset. If a flush fails the entries
+ * stay queued (the oldest are overwritten once the ring is full). The ring
+ * is started over when the firmware or the entry layout changes.
+ */
+
+/**
+ * Metrics of one wake
+ */
+struct TelemetrySample {
+    float batteryVoltage;   // V
+    int batteryPercent;     // %
+    float chargeRate;       // %/h
+    int rssi;               // dBm
+    uint32_t wakeMs;        // Time awake until the status was recorded
+    uint32_t freeHeap;      // Bytes
+    const char* refresh;    // Refresh mode name ("full", "partial", ...)
+    uint16_t sleepMinutes;  // Sleep chosen after this wake
+    uint32_t i2cUs;         // Fuel gauge bus time
+};
+
+/**
+ * Append the metrics of this wake
+ */
+void telemetry_record(const TelemetrySample& sample);
+
+/**
+ * Whether this wake should publish the batch
+ */
+bool telemetry_due();
+
+/**
+ * Queued entries as one compact JSON message, oldest first
+ * {"wake":N,"n":N,"mv":[..],"pct":[..],"rate":[..],"rssi":[..],"ms":[..],"heap":[..],"sleep":[..],"i2c":[..],"refresh":"fpps"}
+ * @return false if the ring is empty
+ */
+bool telemetry_batch_json(String& out);
+
+/**
+ * Drop the published entries
+ */
+void telemetry_flushed();
+
+#endif // TELEMETRY_RING_H
@@ -0,0 +1,74 @@
+#ifndef TOPIC_AGGREGATOR_H
+#define TOPIC_AGGREGATOR_H
+
+#include <stdint.h>
+#include "Config.h"
+#include "DashboardModel.h"
+
+/**
+ * Topic Aggregator
+ *
+ * Builds the dashboard from one retained message per sensor when the
+ * configured topic is a wildcard filter (e.g. "plants/+/state"), instead of
+ * a single pre-aggregated document. Entries live in a fixed table of
+ * MAX_PLANTS slots keyed by a hash of the topic; a sensor publishing again
+ * updates its slot, sensors beyond the table are counted as dropped.
+ *
+ * Sensor payloads are either a bare number ("67", "67.5") or a small JSON
+ * object: {"moisture": 67, "name": "Ficus Lyrata", "updateDate": "..."}.
+ * Without a name, the topic level matched by the first wildcard is used
+ * ("plants/ficus_lyrata/state" shows as "Ficus Lyrata"). Values that are
+ * not finite numbers ("nan", "unavailable") count as invalid.
+ *
+ * make sim-aggregator checks the topic matching, payload parsing and table
+ * limits on the host.
+ */
+class TopicAggregator {
+public:
+    /**
+     * Constructor
+     */
+    TopicAggregator();
+
+    /**
+     * Whether a topic filter contains MQTT wildcards ('+' or '#')
+     */
+    static bool isWildcard(const char* filter);
+
+    /**
+     * MQTT topic filter match ('+' one level, '#' all remaining levels)
+     */
+    static bool matches(const char* filter, const char* topic);
+
+    /**
+     * Start a new collection window for a topic filter
+     */
+    void begin(const char* filter);
+
+    /**
+     * Add a sensor message
+     * @return true if stored, false if ignored (no match, invalid or table full)
+     */
+    bool add(const char* topic, const uint8_t* payload, unsigned int length);
+
+    /**
+     * Fill the dashboard with the collected sensors, sorted by name
+     */
+    void build(DashboardModel& model) const;
+
+    uint16_t received;    // Messages matching the filter
+    uint16_t dropped;     // New sensors that did not fit in the table
+    uint16_t invalid;     // Payloads without a usable moisture value
+
+private:
+    const char* filter;
+    DashboardModel table;            // Entries in arrival order
+    uint32_t keys[MAX_PLANTS];       // Topic hash of each entry
+
+    /**
+     * Plant name from the topic level matched by the first wildcard
+     */
+    void nameFromTopic(const char* topic, char* name, unsigned int size) const;
+};
+
+#endif // TOPIC_AGGREGATOR_H
@@ -0,0 +1,88 @@
+#ifndef WAKE_JITTER_H
+#define WAKE_JITTER_H
+
+#include <stdint.h>
+#include "Config.h"
+
+/**
+ * Wake Jitter
+ *
+ * Spreads the wakes of a fleet so displays flashed and powered on together
+ * do not reach the access point and the broker in the same second. Each
+ * node gets a fixed position in a window from a hash of its efuse MAC and
+ * node_name: the same every wake, different between nodes.
+ *
+ * Aligned to the publisher, the window starts after the publish slot and
+ * is JITTER_WINDOW_S wide, so the data stays fresh. Without a publisher
+ * interval it spans the whole sleep interval. The window adapts to the
+ * connect latency the node sees (WiFi start to CONNACK, smoothed): slow
+ * connects double it, up to JITTER_MAX_WINDOW_S, and a long run of fast
+ * ones halves it back. The offset is a fraction of the window, so nodes
+ * keep their order while it changes.
+ *
+ * make sim-fleet runs it for a simulated fleet sharing one access point
+ * and broker.
+ */
+class WakeJitter {
+public:
+    /**
+     * Latency history, persisted by the caller across wakes
+     */
+    struct State {
+        uint16_t connectMs;     // Smoothed connect latency, 0 if none yet
+        uint8_t widen;          // Window doublings
+        uint8_t hold;           // Wakes before the window may change again
+        uint8_t calm;           // Consecutive wakes well below the slow latency
+    };
+    
+    /**
+     * Reset to the base window without latency history
+     */
+    static void reset(State& state);
+    
+    /**
+     * Hash placing a node in the window
+     * @param mac Efuse MAC (0 if none)
+     */
+    static uint32_t nodeHash(uint64_t mac, const char* nodeName);
+    
+    /**
+     * Add the connect latency of this wake and adapt the window
+     */
+    static void observe(State& state, uint32_t connectMs);
+    
+    /**
+     * Current window: baseS doubled per widen step, at most maxS
+     */
+    static uint32_t window(const State& state, uint32_t baseS, uint32_t maxS);
+    
+    /**
+     * Offset of a node in [0, windowS)
+     */
+    static uint32_t offset(uint32_t hash, uint32_t windowS);
+};
+
+#if defined(ARDUINO)
+/**
+ * Add the connect latency of this wake to the history kept in RTC memory
+ */
+void jitter_observe(uint32_t connectMs);
+
+/**
+ * Window after the publish slot, adapted to the connect latency
+ * @param periodS Publisher interval, caps the window
+ */
+uint32_t jitter_window(uint32_t periodS);
+
+/**
+ * Offset of this node (efuse MAC and node name) in a window
+ */
+uint32_t jitter_offset(const char* nodeName, uint32_t windowS);
+
+/**
+ * History kept in RTC memory
+ */
+const WakeJitter::State& jitter_state();
+#endif
+
+#endif // WAKE_JITTER_H
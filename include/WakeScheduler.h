@@ -0,0 +1,134 @@
+#ifndef WAKE_SCHEDULER_H
+#define WAKE_SCHEDULER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
+
+/**
+ * Wake Scheduler
+ *
+ * Runs the hardware bring-up of a wake as a small dependency graph. Jobs
+ * (WiFi association, fuel gauge init, panel reset...) start together in
+ * their own tasks, each once the phases it depends on are done, and the
+ * loop task joins a job only where it needs the result. Work done on the
+ * loop task itself is tracked as inline phases between begin() and end(),
+ * and work handed to other tasks as tracked phases (track()).
+ *
+ * report() prints when every phase ran and the critical path through the
+ * graph, i.e. the chain of phases that determined the wake latency.
+ */
+class WakeScheduler {
+public:
+    /**
+     * Job run in its own task
+     * @return true on success (reported by join())
+     */
+    typedef bool (*Job)(void* context);
+
+    static const int MAX_PHASES = 12;
+
+    WakeScheduler();
+
+    /**
+     * Dependency mask of a phase
+     */
+    static uint32_t bit(int id) { return 1u << id; }
+
+    /**
+     * Add a job, started by start()
+     * @param name Phase name for the report
+     * @param job Function run in a new task
+     * @param context Passed to the job
+     * @param dependsOn Mask of phases (bit(id)) that must be done first
+     * @param core Core to pin the job task to (default: any)
+     * @return Phase id, or -1 if the table is full
+     */
+    int add(const char* name, Job job, void* context, uint32_t dependsOn = 0, BaseType_t core = tskNO_AFFINITY);
+
+    /**
+     * Start all added jobs
+     * @return false if a job task could not be created (it runs inline instead)
+     */
+    bool start();
+
+    /**
+     * Wait for a phase to finish
+     * @param id Phase id
+     * @param timeoutMs Timeout in milliseconds
+     * @return true if the phase finished successfully
+     */
+    bool join(int id, unsigned long timeoutMs);
+
+    /**
+     * Begin a phase run on the calling task
+     * Waits for dependsOn; follows the previous inline phase implicitly.
+     * @return Phase id, or -1 if the table is full
+     */
+    int begin(const char* name, uint32_t dependsOn = 0);
+
+    /**
+     * Add a phase run elsewhere (e.g. by another task)
+     * Its owner calls enter() when it starts and end() when it is done.
+     * @return Phase id, or -1 if the table is full
+     */
+    int track(const char* name, uint32_t dependsOn = 0);
+
+    /**
+     * Mark a tracked phase as started
+     */
+    void enter(int id);
+
+    /**
+     * End an inline or tracked phase (from any task)
+     */
+    void end(int id, bool ok = true);
+
+    /**
+     * Print the phase timeline and the critical path
+     */
+    void report() const;
+
+    /**
+     * End time of the critical path (ms since boot), 0 before report data exists
+     */
+    unsigned long criticalPathMs() const;
+
+    /**
+     * Start time of a phase (ms since boot), 0 if it has not started
+     */
+    unsigned long startedAt(int id) const { return phases[id].startMs; }
+
+private:
+    struct Phase {
+        const char* name;
+        Job job;
+        void* context;
+        uint32_t dependsOn;
+        BaseType_t core;
+        unsigned long startMs;
+        unsigned long endMs;
+        unsigned long joinMs;   // Time the loop task spent blocked in join()
+        bool ok;
+        bool started;
+        bool done;
+        WakeScheduler* owner;
+    };
+
+    Phase phases[MAX_PHASES];
+    int count;
+    int lastInline;
+    EventGroupHandle_t doneBits;
+
+    int addPhase(const char* name, Job job, void* context, uint32_t dependsOn);
+    void run(Phase& phase);
+    static void jobTask(void* param);
+
+    /**
+     * Dependency of a phase that finished last, -1 for none
+     */
+    int latestDependency(int id) const;
+};
+
+#endif // WAKE_SCHEDULER_H
@@ -0,0 +1,165 @@
+#ifndef WALL_CLOCK_H
+#define WALL_CLOCK_H
+
+#include <stdint.h>
+#include "Config.h"
+
+/**
+ * Wall Clock
+ *
+ * Keeps Unix time across deep sleep and plans wakes on the publisher's
+ * cadence. The time comes from SNTP (started while WiFi is up) or, until
+ * SNTP has answered once, from the publish time ("ts") in the payload.
+ *
+ * The ESP32 keeps counting time in deep sleep on its RC slow clock, which
+ * may run a few percent off. Each sync compares the clock with the server
+ * and refines the estimated rate error (drift); after a wake the time
+ * slept is corrected by it, and sleep timer requests are shortened or
+ * lengthened so the wake lands when planned. SNTP syncs happen every wake
+ * (at most hourly) until the estimate has settled, then once every
+ * CLOCK_RESYNC_HOURS. A publish time only tells that the time is at least
+ * that late; it sets a clock that reads earlier but does not measure drift.
+ * Such a clock is behind by the data age it was set with, so wakes are
+ * planned on it only once SNTP has answered. Until then sleeps run free,
+ * and the first one after a reset is delayed by the node's offset: a fleet
+ * powered on together keeps that spread from then on.
+ *
+ * With the publisher's interval known (publish_period), the wake is moved
+ * to shortly after the publish slot nearest the chosen sleep, using the
+ * publish time of the last payload as the phase, plus the node's offset
+ * (WakeJitter.h). Without it, wakes fall on a grid of the sleep interval
+ * shifted by the offset, so a fleet started together spreads out.
+ *
+ * make sim-clock runs WallClock over a simulated week on the host; the
+ * clock_* functions run it on the device.
+ */
+
+/**
+ * Where the current time came from
+ */
+enum ClockSource : uint8_t {
+    CLOCK_UNSET = 0,        // Not set since power-on
+    CLOCK_PAYLOAD,          // Publish time of a payload (lower bound)
+    CLOCK_SNTP              // Time server
+};
+
+/**
+ * Clock state kept across deep sleep
+ */
+struct ClockState {
+    int64_t syncedAt;       // Unix time of the last SNTP sync, 0 if none
+    int64_t sleptAt;        // Clock reading when deep sleep began, 0 while awake
+    int64_t lastPublish;    // Publish time of the last payload carrying one, 0 if none
+    int64_t nextWake;       // Planned wake (Unix time), 0 if not planned
+    float drift;            // Rate error in deep sleep: true / measured time - 1
+    uint16_t syncs;         // Clock settings (SNTP or payload) since power-on
+    uint8_t source;         // ClockSource
+    uint8_t settled;        // Last measured drift error below CLOCK_DRIFT_SETTLED
+    uint8_t shifted;        // Node's offset applied to a free-running sleep since the reset
+};
+
+/**
+ * Publisher cadence and sleep limits used to place a wake
+ */
+struct WakeCadence {
+    uint32_t periodS;       // Publisher interval, 0 if unknown (grid of the sleep)
+    uint32_t delayS;        // Wake this long after a publish slot
+    uint32_t offsetS;       // Node's offset into the slot (on top of the delay)
+    uint32_t minS;          // Shortest sleep
+    uint32_t maxS;          // Longest sleep
+};
+
+class WallClock {
+public:
+    /**
+     * Fresh state: clock not set, no drift estimate
+     */
+    static void reset(ClockState& state);
+    
+    /**
+     * Seconds to add to the clock after a deep sleep
+     * @param now Clock reading after the wake
+     */
+    static int64_t sleepCorrection(const ClockState& state, int64_t now);
+    
+    /**
+     * Record a time reference and refine the drift estimate
+     * A payload publish time (CLOCK_PAYLOAD) is a lower bound: it is only
+     * used while the clock reads earlier, and never once SNTP has answered.
+     * @param measured Clock reading just before the sync
+     * @param actual Time from the server or the payload
+     * @return Whether the clock is to be set to actual
+     */
+    static bool sync(ClockState& state, int64_t measured, int64_t actual, ClockSource source);
+    
+    /**
+     * Whether to start an SNTP sync this wake
+     */
+    static bool syncDue(const ClockState& state, int64_t now);
+    
+    /**
+     * Sleep until the wake slot nearest now + sleepS, within the limits
+     * Without SNTP time the sleep runs free: sleepS, plus the node's offset
+     * until a sleep has been shifted by it (state.shifted).
+     */
+    static uint32_t alignedSleep(const ClockState& state, int64_t now, uint32_t sleepS, const WakeCadence& cadence);
+    
+    /**
+     * Sleep timer request for a sleep of sleepS seconds of true time
+     */
+    static uint32_t timerSleep(const ClockState& state, uint32_t sleepS);
+    
+    /**
+     * Name of a clock source
+     */
+    static const char* sourceName(uint8_t source);
+};
+
+#if defined(ARDUINO)
+/**
+ * Restore the state kept in RTC memory and correct the time slept
+ * Call early in setup(), after the settings are available.
+ * @param timezone POSIX TZ string for local time (quiet hours)
+ */
+void clock_begin(const char* timezone);
+
+/**
+ * Start an SNTP sync if the clock is unset or due for one (WiFi must be up)
+ */
+void clock_start_sync();
+
+/**
+ * Publish time of the received payload (Unix seconds, 0 if not sent)
+ */
+void clock_from_payload(uint32_t timestamp);
+
+/**
+ * Fold a completed SNTP sync into the state
+ */
+void clock_update();
+
+/**
+ * Local time of day in minutes, -1 while the clock is not set
+ */
+int clock_minute_of_day();
+
+/**
+ * Align the chosen sleep to the publisher
+ * @return Seconds until the planned wake
+ */
+uint32_t clock_plan_sleep(uint32_t sleepS, const WakeCadence& cadence);
+
+/**
+ * Sleep timer request for the planned wake; remembers when sleep began
+ * Call right before deep sleep.
+ * @param sleepS Result of clock_plan_sleep(), used while the clock is not set
+ */
+uint32_t clock_sleep_timer(uint32_t sleepS);
+
+/**
+ * State kept in RTC memory
+ */
+const ClockState& clock_state();
+#endif
+
+#endif // WALL_CLOCK_H
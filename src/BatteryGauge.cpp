@@ -0,0 +1,62 @@
+#include "BatteryGauge.h"
+#include <string.h>
+#include <math.h>
+
+namespace {
+    uint16_t word(const uint8_t* burst, uint8_t reg)
+    {
+        const uint8_t* bytes = burst + (reg - BatteryGauge::FIRST_REGISTER);
+        return (uint16_t)((bytes[0] << 8) | bytes[1]);
+    }
+    
+    float clampPercent(float percent)
+    {
+        return percent < 0 ? 0 : (percent > 100 ? 100 : percent);
+    }
+}
+
+/**
+ * Decode a burst of BURST_BYTES bytes read from FIRST_REGISTER
+ */
+BatteryGauge::Snapshot BatteryGauge::decode(const uint8_t* burst)
+{
+    Snapshot snapshot;
+    snapshot.voltage = word(burst, REG_VCELL) * 78.125e-6f;
+    snapshot.rawPercent = word(burst, REG_SOC) / 256.0f;
+    snapshot.chargeRate = (int16_t)word(burst, REG_CRATE) * 0.208f;
+    snapshot.config = word(burst, REG_CONFIG);
+    snapshot.sleeping = (snapshot.config & CONFIG_SLEEP) != 0;
+    
+    // A bus without the gauge reads all ones (or zeros)
+    snapshot.present = (word(burst, REG_VERSION) & 0xfff0) == 0x0010 && snapshot.voltage > 0 &&
+                       snapshot.voltage < 5.0f;
+    return snapshot;
+}
+
+/**
+ * Start over without readings
+ */
+void BatteryGauge::reset(History& history)
+{
+    memset(&history, 0, sizeof(history));
+}
+
+/**
+ * Add this wake's reading
+ */
+int BatteryGauge::filter(History& history, float rawPercent)
+{
+    rawPercent = clampPercent(rawPercent);
+    if (!history.primed || fabsf(rawPercent - history.smoothed) > BATTERY_RESEED_PCT) {
+        history.smoothed = rawPercent;
+        history.shown = (uint8_t)lroundf(rawPercent);
+        history.primed = 1;
+        return history.shown;
+    }
+    
+    history.smoothed += BATTERY_SMOOTHING * (rawPercent - history.smoothed);
+    if (fabsf(history.smoothed - history.shown) >= BATTERY_HYSTERESIS_PCT) {
+        history.shown = (uint8_t)lroundf(history.smoothed);
+    }
+    return history.shown;
+}
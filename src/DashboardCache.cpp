@@ -0,0 +1,38 @@
+#include "DashboardCache.h"
+#include <Arduino.h>
+#include "RtcStore.h"
+#include "Log.h"
+
+namespace {
+    const uint32_t DASHBOARD_CACHE_MAGIC = 0x44534831;  // "DSH1"
+    const uint16_t DASHBOARD_CACHE_VERSION = 3;
+    const char* DASHBOARD_CACHE_KEY = "dashboard";
+    
+    // RTC memory, copied to NVS when sealed often enough (see RtcStore.h)
+    RTC_DATA_ATTR RtcRecord<DashboardModel> cache;
+}
+
+/**
+ * Load the cached dashboard
+ */
+bool dashboard_cache_load(DashboardModel& model)
+{
+    if (!rtc_store_open(cache, DASHBOARD_CACHE_MAGIC, DASHBOARD_CACHE_VERSION, DASHBOARD_CACHE_KEY)) {
+        cache.data.clear();
+        model.clear();
+        return false;
+    }
+    
+    model = cache.data;
+    LOGD("Cached dashboard: seq %lu, %d plants", (unsigned long)model.seq, model.plantCount);
+    return true;
+}
+
+/**
+ * Store the dashboard
+ */
+void dashboard_cache_save(const DashboardModel& model)
+{
+    rtc_store_open(cache, DASHBOARD_CACHE_MAGIC, DASHBOARD_CACHE_VERSION, DASHBOARD_CACHE_KEY);
+    cache.data = model;
+}
@@ -0,0 +1,79 @@
+#include "DashboardLayout.h"
+#include "Config.h"
+
+/**
+ * Compute the layout for a frame
+ */
+DashboardLayout DashboardLayout::compute(int plantCount, int width, int height, int headerHeight, int page)
+{
+    DashboardLayout layout;
+    layout.originY = headerHeight;
+    layout.compact = false;
+    layout.pageCount = 1;
+    layout.page = 0;
+    layout.first = 0;
+
+    int areaH = height - headerHeight;
+    int n = plantCount > 0 ? plantCount : 1;
+
+    // Gauge grid: pick the column count giving the largest gauge, and
+    // among equal gauges the one leaving the fewest empty cells
+    int bestRadius = -1;
+    int bestWaste = 0;
+    for (int cols = 1; cols <= n; cols++) {
+        int rows = (n + cols - 1) / cols;
+        int radius = gaugeRadius(width / cols, areaH / rows);
+        int waste = cols * rows - n;
+        if (radius > bestRadius || (radius == bestRadius && waste < bestWaste)) {
+            bestRadius = radius;
+            bestWaste = waste;
+            layout.cols = cols;
+            layout.rows = rows;
+        }
+    }
+
+    if (bestRadius < MIN_GAUGE_RADIUS) {
+        // Too dense for gauges: bars, as many rows as fit, split into pages
+        layout.compact = true;
+        layout.cols = BAR_COLUMNS;
+        int maxRows = areaH / BAR_ROW_HEIGHT;
+        int rowsNeeded = (n + BAR_COLUMNS - 1) / BAR_COLUMNS;
+        layout.rows = rowsNeeded < maxRows ? rowsNeeded : maxRows;
+        if (layout.rows > MAX_PAGE_CELLS / BAR_COLUMNS) {
+            layout.rows = MAX_PAGE_CELLS / BAR_COLUMNS;
+        }
+
+        int perPage = layout.capacity();
+        layout.pageCount = (n + perPage - 1) / perPage;
+        layout.page = page % layout.pageCount;
+        layout.first = layout.page * perPage;
+    }
+
+    layout.cellW = width / layout.cols;
+    layout.cellH = areaH / layout.rows;
+
+    int remaining = plantCount - layout.first;
+    layout.count = remaining < layout.capacity() ? remaining : layout.capacity();
+    return layout;
+}
+
+/**
+ * Gauge radius that fits a cell
+ * Reserve space: 10% top padding, 30% for percentage+LOW, 20% for name, 40% for gauge
+ */
+int DashboardLayout::gaugeRadius(int w, int h)
+{
+    int gaugeSpace = h * 0.40;
+    int widthLimit = w / 2 - 10;
+    return gaugeSpace < widthLimit ? gaugeSpace : widthLimit;
+}
+
+/**
+ * Screen rectangle of a cell on the current page
+ */
+DashboardLayout::Rect DashboardLayout::cell(int slot) const
+{
+    int row = slot / cols;
+    int col = slot % cols;
+    return {col * cellW, originY + row * cellH, cellW, cellH};
+}
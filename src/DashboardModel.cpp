@@ -0,0 +1,99 @@
+#include "DashboardModel.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+    /**
+     * Copy a string into a fixed-size buffer, always terminated
+     */
+    void copyString(char* dest, size_t size, const char* src)
+    {
+        if (src == nullptr) {
+            src = "";
+        }
+        snprintf(dest, size, "%s", src);
+    }
+}
+
+/**
+ * Remove the update date and all plants
+ */
+void DashboardModel::clear()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+/**
+ * Set the update date
+ */
+void DashboardModel::setUpdateDate(const char* date)
+{
+    copyString(updateDate, sizeof(updateDate), date);
+}
+
+/**
+ * Append a plant
+ */
+bool DashboardModel::addPlant(const char* name, int moisture)
+{
+    if (plantCount >= MAX_PLANTS) {
+        return false;
+    }
+    
+    Plant& plant = plants[plantCount++];
+    copyString(plant.name, sizeof(plant.name), name);
+    plant.moisture = moisture < 0 ? 0 : (moisture > 100 ? 100 : moisture);
+    return true;
+}
+
+/**
+ * Replace the content with a status screen
+ */
+void DashboardModel::setStatus(const char* title, const char* message)
+{
+    clear();
+    setUpdateDate(title);
+    addPlant(message, 0);
+}
+
+/**
+ * Apply a received payload to this dashboard
+ */
+bool DashboardModel::applyUpdate(const DashboardModel& update)
+{
+    if (update.seq != 0 && update.seq == seq) {
+        return true;  // Already applied
+    }
+    
+    if (!update.delta) {
+        *this = update;
+        return true;
+    }
+    
+    if (seq == 0 || update.base != seq) {
+        return false;
+    }
+    
+    for (int i = 0; i < update.plantCount; i++) {
+        const Plant& changed = update.plants[i];
+        int match = 0;
+        while (match < plantCount && strcmp(plants[match].name, changed.name) != 0) {
+            match++;
+        }
+        if (match < plantCount) {
+            plants[match].moisture = changed.moisture;
+        } else {
+            addPlant(changed.name, changed.moisture);
+        }
+    }
+    
+    // A delta may leave out the date and timestamp, keep the cached ones then
+    if (update.updateDate[0] != '\0') {
+        setUpdateDate(update.updateDate);
+    }
+    if (update.timestamp != 0) {
+        timestamp = update.timestamp;
+    }
+    seq = update.seq;
+    return true;
+}
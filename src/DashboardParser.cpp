@@ -0,0 +1,148 @@
+#include "DashboardParser.h"
+#include "DashboardMsgPack.h"
+#include "Log.h"
+#include <Arduino.h>
+
+namespace {
+    /**
+     * Byte source over a buffer for the MessagePack decoder
+     */
+    struct BufferSource {
+        const uint8_t* pos;
+        const uint8_t* end;
+        
+        int read() { return pos < end ? *pos++ : -1; }
+    };
+    
+    /**
+     * Log the parsed plants
+     */
+    void logModel(const DashboardModel& model, uint32_t totalPlants)
+    {
+        if (totalPlants > MAX_PLANTS) {
+            LOGW("Payload has %lu plants, showing first %d", (unsigned long)totalPlants, MAX_PLANTS);
+        }
+        for (int i = 0; i < model.plantCount; i++) {
+            LOGD("Plant %d: %s = %d%%", i + 1, model.plants[i].name, model.plants[i].moisture);
+        }
+    }
+    
+    /**
+     * Copy the deserialized dashboard fields into the model
+     */
+    bool fillModel(DeserializationError error, const JsonDocument& doc, const char* nodeName, DashboardModel& model)
+    {
+        // A full buffer leaves the document parsed so far: keep its plants
+        bool truncated = error == DeserializationError::NoMemory && !doc.isNull();
+        if (truncated) {
+            LOGW("Payload exceeds the parse buffer (%u bytes), keeping the plants that fit",
+                 (unsigned)DASHBOARD_JSON_CAPACITY);
+        } else if (error) {
+            LOGE("JSON parse error: %s", error.c_str());
+            return false;
+        }
+        
+        // Fleet payloads: this node's section, the rest was filtered out
+        JsonVariantConst section = doc.as<JsonVariantConst>();
+        if (doc.containsKey("fleet")) {
+            section = doc["fleet"][nodeName];
+            if (section.isNull()) {
+                LOGW("Fleet payload has no section for %s", nodeName);
+                return false;
+            }
+        }
+        
+        model.setUpdateDate(section["updateDate"] | (doc["updateDate"] | ""));
+        model.seq = doc["seq"] | 0;
+        model.base = doc["base"] | 0;
+        model.delta = doc.containsKey("base");
+        model.timestamp = doc["ts"] | 0;
+        
+        JsonArrayConst plantsArray = section["plants"].as<JsonArrayConst>();
+        for (JsonObjectConst plant : plantsArray) {
+            // The last plant of a truncated document may be incomplete
+            if (truncated && !plant.containsKey("moisture")) {
+                break;
+            }
+            if (!model.addPlant(plant["name"] | "", plant["moisture"] | 0)) {
+                break;
+            }
+        }
+        
+        logModel(model, plantsArray.size());
+        LOGI("Total plants: %d (parse buffer %u/%u bytes)", model.plantCount,
+             (unsigned)doc.memoryUsage(), (unsigned)DASHBOARD_JSON_CAPACITY);
+        
+        return true;
+    }
+    
+    /**
+     * Decode a MessagePack payload from any byte source
+     */
+    template <typename Source>
+    bool parseMsgPack(Source& source, DashboardModel& model)
+    {
+        uint32_t totalPlants;
+        if (!dashboard_decode_msgpack(source, model, totalPlants)) {
+            LOGE("MessagePack decode error (malformed payload or unknown schema version)");
+            return false;
+        }
+        
+        logModel(model, totalPlants);
+        LOGI("Total plants: %d (MessagePack)", model.plantCount);
+        return true;
+    }
+}
+
+/**
+ * Parse a JSON payload into the model
+ */
+bool dashboard_parse_json(const char* payload, size_t length, const char* nodeName, DashboardModel& model)
+{
+    model.clear();
+    
+    DynamicJsonDocument doc(DASHBOARD_JSON_CAPACITY);
+    return fillModel(dashboard_deserialize(doc, nodeName, payload, length), doc, nodeName, model);
+}
+
+/**
+ * Parse a JSON payload read incrementally from a stream
+ */
+bool dashboard_parse_json(Stream& input, const char* nodeName, DashboardModel& model)
+{
+    model.clear();
+    
+    DynamicJsonDocument doc(DASHBOARD_JSON_CAPACITY);
+    return fillModel(dashboard_deserialize(doc, nodeName, input), doc, nodeName, model);
+}
+
+/**
+ * Parse a MessagePack payload read incrementally from a stream
+ */
+bool dashboard_parse_msgpack(Stream& input, DashboardModel& model)
+{
+    return parseMsgPack(input, model);
+}
+
+/**
+ * Parse a payload from a stream, detecting the format from its first byte
+ */
+bool dashboard_parse_payload(Stream& input, const char* nodeName, DashboardModel& model)
+{
+    if (dashboard_is_msgpack(input.peek())) {
+        return dashboard_parse_msgpack(input, model);
+    }
+    return dashboard_parse_json(input, nodeName, model);
+}
+
+/**
+ * Parse a payload held in memory, detecting the format from its first byte
+ */
+bool dashboard_parse_payload(const uint8_t* payload, size_t length, const char* nodeName, DashboardModel& model)
+{
+    if (length > 0 && dashboard_is_msgpack(payload[0])) {
+        BufferSource source = {payload, payload + length};
+        return parseMsgPack(source, model);
+    }
+    return dashboard_parse_json(reinterpret_cast<const char*>(payload), length, nodeName, model);
+}
@@ -0,0 +1,205 @@
+#include "DisplayTask.h"
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include "Config.h"
+#else
+#include <chrono>
+#endif
+
+/**
+ * Constructor
+ */
+DisplayTask::DisplayTask()
+    : executor(nullptr),
+      context(nullptr),
+      nextTicket(1),
+      completed(0),
+#if defined(ARDUINO)
+      task(nullptr),
+      queue(nullptr)
+#else
+      stopping(false)
+#endif
+{
+}
+
+#if defined(ARDUINO)
+
+/**
+ * Destructor (the task runs until deep sleep)
+ */
+DisplayTask::~DisplayTask()
+{
+}
+
+/**
+ * Start the task
+ */
+bool DisplayTask::begin(Executor executor, void* context)
+{
+    if (task) {
+        return true;
+    }
+    this->executor = executor;
+    this->context = context;
+    
+    queue = xQueueCreate(DISPLAY_QUEUE_LENGTH, sizeof(Entry));
+    if (!queue) {
+        return false;
+    }
+    if (xTaskCreate(taskMain, "display", DISPLAY_TASK_STACK_SIZE, this, 1, &task) != pdPASS) {
+        vQueueDelete(queue);
+        queue = nullptr;
+        task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Queue a command
+ */
+uint32_t DisplayTask::post(const DisplayCommand& command)
+{
+    if (!queue) {
+        return 0;
+    }
+    
+    Entry entry;
+    entry.command = command;
+    entry.ticket = nextTicket;
+    entry.requester = xTaskGetCurrentTaskHandle();
+    if (xQueueSend(queue, &entry, pdMS_TO_TICKS(DISPLAY_COMMAND_TIMEOUT)) != pdTRUE) {
+        return 0;
+    }
+    return nextTicket++;
+}
+
+/**
+ * Wait until a command is done
+ */
+bool DisplayTask::wait(uint32_t ticket, unsigned long timeoutMs)
+{
+    unsigned long startTime = millis();
+    while (!done(ticket)) {
+        unsigned long elapsed = millis() - startTime;
+        if (ticket == 0 || elapsed >= timeoutMs) {
+            return false;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs - elapsed));
+    }
+    return true;
+}
+
+/**
+ * Task body: execute commands in order, notify the poster of each
+ */
+void DisplayTask::taskMain(void* param)
+{
+    DisplayTask* self = static_cast<DisplayTask*>(param);
+    Entry entry;
+    
+    for (;;) {
+        if (xQueueReceive(self->queue, &entry, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        self->executor(entry.command, self->context);
+        self->completed = entry.ticket;
+        xTaskNotifyGive(entry.requester);
+    }
+}
+
+#else
+
+/**
+ * Destructor: finish queued commands and join the thread
+ */
+DisplayTask::~DisplayTask()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    changed.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+/**
+ * Start the thread
+ */
+bool DisplayTask::begin(Executor executor, void* context)
+{
+    if (worker.joinable()) {
+        return true;
+    }
+    this->executor = executor;
+    this->context = context;
+    worker = std::thread(&DisplayTask::run, this);
+    return true;
+}
+
+/**
+ * Queue a command
+ */
+uint32_t DisplayTask::post(const DisplayCommand& command)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (!worker.joinable() || stopping) {
+        return 0;
+    }
+    Entry entry;
+    entry.command = command;
+    entry.ticket = nextTicket;
+    queue.push_back(entry);
+    changed.notify_all();
+    return nextTicket++;
+}
+
+/**
+ * Wait until a command is done
+ */
+bool DisplayTask::wait(uint32_t ticket, unsigned long timeoutMs)
+{
+    if (ticket == 0) {
+        return false;
+    }
+    std::unique_lock<std::mutex> guard(lock);
+    return changed.wait_for(guard, std::chrono::milliseconds(timeoutMs),
+                            [&] { return (int32_t)(completed - ticket) >= 0; });
+}
+
+/**
+ * Thread body: execute commands in order, wake waiters after each
+ */
+void DisplayTask::run()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    for (;;) {
+        changed.wait(guard, [&] { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;  // Stopping with nothing left
+        }
+        Entry entry = queue.front();
+        queue.pop_front();
+        
+        guard.unlock();
+        executor(entry.command, context);
+        guard.lock();
+        
+        completed = entry.ticket;
+        changed.notify_all();
+    }
+}
+
+#endif
+
+/**
+ * Whether a command is done
+ */
+bool DisplayTask::done(uint32_t ticket) const
+{
+    return ticket != 0 && (int32_t)(completed - ticket) >= 0;
+}
@@ -0,0 +1,179 @@
+#include "EnergyModel.h"
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include <math.h>
+#include "RtcStore.h"
+#include "Log.h"
+#endif
+
+namespace {
+    const float MS_PER_HOUR = 3600000.0f;
+    const float MIN_SCALE = 0.25f;
+    const float MAX_SCALE = 4.0f;
+    
+    float clampScale(float scale)
+    {
+        return scale < MIN_SCALE ? MIN_SCALE : (scale > MAX_SCALE ? MAX_SCALE : scale);
+    }
+}
+
+EnergyModel::EnergyModel(const EnergyCoefficients& coefficients)
+    : k(coefficients)
+{
+}
+
+/**
+ * Coefficients from Config.h
+ */
+EnergyCoefficients EnergyModel::defaultCoefficients()
+{
+    EnergyCoefficients coefficients;
+    coefficients.cpuMa = ENERGY_CPU_MA;
+    coefficients.radioMa = ENERGY_RADIO_MA;
+    coefficients.panelMa = ENERGY_PANEL_MA;
+    coefficients.lightSleepMa = ENERGY_LIGHT_SLEEP_MA;
+    coefficients.deepSleepMa = ENERGY_DEEP_SLEEP_MA;
+    return coefficients;
+}
+
+/**
+ * Fresh state: no calibration, no history
+ */
+void EnergyModel::reset(EnergyState& state)
+{
+    state.scale = 1.0f;
+    state.averageMa = 0;
+    state.cycleMah = 0;
+    state.anchorPercent = -1;
+    state.anchorMah = 0;
+    state.cycles = 0;
+    state.calibrations = 0;
+}
+
+/**
+ * Modelled charge of one cycle (uncalibrated)
+ */
+float EnergyModel::cycleMah(const EnergyPhases& phases) const
+{
+    uint32_t lightSleepMs = phases.lightSleepMs < phases.awakeMs ? phases.lightSleepMs : phases.awakeMs;
+    float awakeMaMs = (phases.awakeMs - lightSleepMs) * k.cpuMa + lightSleepMs * k.lightSleepMa +
+                      phases.radioMs * k.radioMa + phases.panelMs * k.panelMa;
+    return awakeMaMs / MS_PER_HOUR + phases.deepSleepS * k.deepSleepMa / 3600.0f;
+}
+
+/**
+ * Add a finished cycle to the state
+ */
+void EnergyModel::account(EnergyState& state, const EnergyPhases& phases) const
+{
+    float mah = cycleMah(phases);
+    float hours = phases.awakeMs / MS_PER_HOUR + phases.deepSleepS / 3600.0f;
+    float ma = hours > 0 ? mah / hours : 0;
+    
+    state.cycleMah = mah;
+    state.anchorMah += mah;
+    state.averageMa = state.cycles == 0 ? ma : state.averageMa + ENERGY_AVERAGE_WEIGHT * (ma - state.averageMa);
+    state.cycles++;
+}
+
+/**
+ * Compare the model with the fuel gauge
+ */
+bool EnergyModel::calibrate(EnergyState& state, float batteryPercent, float capacityMah)
+{
+    // No calibration point yet, or charged since: start over from here
+    if (state.anchorPercent < 0 || batteryPercent > state.anchorPercent + 1) {
+        state.anchorPercent = batteryPercent;
+        state.anchorMah = 0;
+        return false;
+    }
+    
+    float drop = state.anchorPercent - batteryPercent;
+    if (drop < ENERGY_CALIBRATION_PCT || state.anchorMah <= 0) {
+        return false;
+    }
+    
+    float measuredMah = drop / 100.0f * capacityMah;
+    float ratio = clampScale(measuredMah / state.anchorMah);
+    state.scale = clampScale(state.scale + ENERGY_CALIBRATION_WEIGHT * (ratio - state.scale));
+    state.anchorPercent = batteryPercent;
+    state.anchorMah = 0;
+    state.calibrations++;
+    return true;
+}
+
+/**
+ * Calibrated average current
+ */
+float EnergyModel::averageMa(const EnergyState& state)
+{
+    return state.averageMa * state.scale;
+}
+
+/**
+ * Days until the battery is empty at the calibrated average current
+ */
+float EnergyModel::projectedDays(const EnergyState& state, float batteryPercent, float capacityMah)
+{
+    float ma = averageMa(state);
+    if (ma <= 0 || state.cycles == 0) {
+        return 0;
+    }
+    return batteryPercent / 100.0f * capacityMah / ma / 24.0f;
+}
+
+#if defined(ARDUINO)
+namespace {
+    const uint32_t ENERGY_MAGIC = 0x4e524731;  // "NRG1"
+    const uint16_t ENERGY_VERSION = 1;
+    const char* ENERGY_NVS_KEY = "rtc_energy";  // The calibration takes days to learn
+    
+    RTC_DATA_ATTR RtcRecord<EnergyState> energy;
+    
+    bool valid()
+    {
+        const EnergyState& state = energy.data;
+        return rtc_store_open(energy, ENERGY_MAGIC, ENERGY_VERSION, ENERGY_NVS_KEY) && isfinite(state.scale) && state.scale >= MIN_SCALE &&
+               state.scale <= MAX_SCALE && isfinite(state.averageMa) && isfinite(state.anchorMah);
+    }
+}
+
+/**
+ * Validate the state kept in RTC memory and calibrate against the gauge
+ */
+void energy_begin(float batteryPercent, bool gaugePresent)
+{
+    if (!valid()) {
+        EnergyModel::reset(energy.data);
+    } else if (rtc_store_restored(energy.header)) {
+        // Charge since the calibration point was not all counted
+        energy.data.anchorPercent = -1;
+    }
+    
+    if (gaugePresent && EnergyModel::calibrate(energy.data, batteryPercent, ENERGY_BATTERY_MAH)) {
+        LOGI("[Energy] Calibrated against the fuel gauge: scale %.2f (%lu steps)",
+             energy.data.scale, (unsigned long)energy.data.calibrations);
+    }
+}
+
+/**
+ * Account this wake and the deep sleep that follows
+ */
+void energy_account(const EnergyPhases& phases)
+{
+    EnergyModel model;
+    model.account(energy.data, phases);
+    LOGI("[Energy] Cycle %.3f mAh (awake %lu ms, radio %lu ms, panel %lu ms), average %.3f mA",
+         energy.data.cycleMah * energy.data.scale, (unsigned long)phases.awakeMs,
+         (unsigned long)phases.radioMs, (unsigned long)phases.panelMs, EnergyModel::averageMa(energy.data));
+}
+
+/**
+ * Accounting kept in RTC memory
+ */
+const EnergyState& energy_state()
+{
+    return energy.data;
+}
+#endif
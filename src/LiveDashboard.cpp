@@ -0,0 +1,148 @@
+#include "LiveDashboard.h"
+#include "Config.h"
+#include "DashboardParser.h"
+#include "Log.h"
+
+namespace {
+    /**
+     * FNV-1a hash of a model, to detect changes
+     */
+    uint32_t fingerprint(const DashboardModel& model)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&model);
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < sizeof(model); i++) {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+}
+
+/**
+ * Constructor
+ */
+LiveDashboard::LiveDashboard(DashboardModel& dashboard, DashboardModel& scratch)
+    : messages(0),
+      renders(0),
+      dashboard(dashboard),
+      scratch(scratch),
+      aggregator(nullptr),
+      nodeName(""),
+      lock(nullptr),
+      pending(false),
+      changedAt(0),
+      renderedAt(0),
+      rendered(false),
+      resyncNeeded(false)
+{
+}
+
+/**
+ * Start merging messages
+ */
+bool LiveDashboard::begin(const char* nodeName, TopicAggregator* aggregator)
+{
+    this->nodeName = nodeName;
+    this->aggregator = aggregator;
+    if (!lock) {
+        lock = xSemaphoreCreateMutex();
+    }
+    return lock != nullptr;
+}
+
+/**
+ * Message handler (network task)
+ */
+void LiveDashboard::onMessage(const char* topic, const uint8_t* payload, unsigned int length, void* context)
+{
+    LiveDashboard* self = static_cast<LiveDashboard*>(context);
+    
+    xSemaphoreTake(self->lock, portMAX_DELAY);
+    self->messages++;
+    if (self->merge(topic, payload, length) && !self->pending) {
+        self->pending = true;
+        self->changedAt = millis();
+    }
+    xSemaphoreGive(self->lock);
+}
+
+/**
+ * Force a render at the next due() check
+ */
+void LiveDashboard::invalidate(unsigned long now)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (!pending) {
+        pending = true;
+        changedAt = now;
+    }
+    xSemaphoreGive(lock);
+}
+
+/**
+ * Whether a render is due
+ */
+bool LiveDashboard::due(unsigned long now) const
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    bool ready = pending &&
+                 now - changedAt >= LIVE_COALESCE_MS &&
+                 (!rendered || now - renderedAt >= LIVE_MIN_INTERVAL_MS);
+    xSemaphoreGive(lock);
+    return ready;
+}
+
+/**
+ * Copy the dashboard to render
+ */
+void LiveDashboard::take(DashboardModel& out, unsigned long now)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    out = dashboard;
+    pending = false;
+    rendered = true;
+    renderedAt = now;
+    renders++;
+    xSemaphoreGive(lock);
+}
+
+/**
+ * Sequence number to request a snapshot from
+ */
+bool LiveDashboard::takeResync(uint32_t& seq)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    bool needed = resyncNeeded;
+    resyncNeeded = false;
+    seq = dashboard.seq;
+    xSemaphoreGive(lock);
+    return needed;
+}
+
+/**
+ * Merge a message
+ */
+bool LiveDashboard::merge(const char* topic, const uint8_t* payload, unsigned int length)
+{
+    uint32_t before = fingerprint(dashboard);
+    
+    if (aggregator) {
+        if (!aggregator->add(topic, payload, length)) {
+            return false;
+        }
+        aggregator->build(dashboard);
+    } else {
+        if (!dashboard_parse_payload(payload, length, nodeName, scratch)) {
+            return false;
+        }
+        if (!dashboard.applyUpdate(scratch)) {
+            LOGW("[Live] Delta base %lu does not match seq %lu",
+                 (unsigned long)scratch.base, (unsigned long)dashboard.seq);
+            resyncNeeded = true;
+            return false;
+        }
+    }
+    
+    return fingerprint(dashboard) != before;
+}
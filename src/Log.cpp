@@ -0,0 +1,344 @@
+#include "Log.h"
+#include "Config.h"
+#include <atomic>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+
+namespace {
+    /**
+     * One queued line. The sequence number tells producers and the log
+     * task whose turn the slot is (bounded MPMC queue, D. Vyukov):
+     * seq == pos: free for the line at pos, seq == pos + 1: line written.
+     * It is stored relative to the slot index so that the zeroed ring is
+     * ready before log_init().
+     */
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        char text[LOG_LINE_MAX];
+    };
+    
+    const uint32_t MASK = LOG_RING_SLOTS - 1;
+    
+    Slot ring[LOG_RING_SLOTS];
+    std::atomic<uint32_t> enqueuePos(0);
+    std::atomic<uint32_t> dequeuePos(0);
+    std::atomic<uint32_t> dropped(0);
+    bool synchronous = false;   // No log task: write from the caller
+    
+    uint32_t sequence(const Slot& slot, uint32_t pos)
+    {
+        return slot.seq.load(std::memory_order_acquire) + (pos & MASK);
+    }
+    
+    void setSequence(Slot& slot, uint32_t pos, uint32_t seq)
+    {
+        slot.seq.store(seq - (pos & MASK), std::memory_order_release);
+    }
+
+#if defined(ARDUINO)
+    TaskHandle_t logTask = nullptr;
+    
+    void output(const char* line, size_t length)
+    {
+        Serial.write(reinterpret_cast<const uint8_t*>(line), length);
+        Serial.print("\r\n");
+    }
+    
+    void notify()
+    {
+        if (logTask) {
+            xTaskNotifyGive(logTask);
+        }
+    }
+#else
+    void writeStdout(const char* line, size_t length)
+    {
+        fwrite(line, 1, length, stdout);
+        fputc('\n', stdout);
+    }
+    
+    LogSink output = writeStdout;
+    std::mutex wakeMutex;
+    std::condition_variable wakeup;
+    bool taskRunning = false;
+    
+    void notify()
+    {
+        wakeup.notify_one();
+    }
+#endif
+
+#if LOG_CRASH_TAIL
+    const uint32_t TAIL_MAGIC = 0x4c4f4731;  // "LOG1"
+    
+    /**
+     * Last lines of this boot, in RTC memory that a reset does not clear
+     */
+    struct CrashTail {
+        uint32_t magic;
+        uint32_t seq[LOG_CRASH_TAIL_LINES];     // Line number + 1, 0 = empty
+        char text[LOG_CRASH_TAIL_LINES][LOG_LINE_MAX];
+    };
+    
+    RTC_NOINIT_ATTR CrashTail tail;
+    String crashReport;
+    
+    const char* crashReason(esp_reset_reason_t reason)
+    {
+        switch (reason) {
+            case ESP_RST_PANIC:     return "panic";
+            case ESP_RST_INT_WDT:   return "int_wdt";
+            case ESP_RST_TASK_WDT:  return "task_wdt";
+            case ESP_RST_WDT:       return "wdt";
+            case ESP_RST_BROWNOUT:  return "brownout";
+            default:                return nullptr;
+        }
+    }
+    
+    /**
+     * Append a line as a JSON string (control characters become spaces)
+     */
+    void appendJsonString(String& out, const char* text)
+    {
+        out += '"';
+        for (const char* c = text; *c; c++) {
+            if (*c == '"' || *c == '\\') {
+                out += '\\';
+                out += *c;
+            } else if ((unsigned char)*c < 0x20) {
+                out += ' ';
+            } else {
+                out += *c;
+            }
+        }
+        out += '"';
+    }
+    
+    /**
+     * Turn the previous boot's tail into a report if that boot crashed
+     */
+    void collectTail()
+    {
+        const char* reason = crashReason(esp_reset_reason());
+        if (reason && tail.magic == TAIL_MAGIC) {
+            int order[LOG_CRASH_TAIL_LINES];
+            int count = 0;
+            for (int i = 0; i < LOG_CRASH_TAIL_LINES; i++) {
+                if (tail.seq[i] == 0) {
+                    continue;
+                }
+                tail.text[i][LOG_LINE_MAX - 1] = '\0';
+                int at = count++;
+                while (at > 0 && tail.seq[order[at - 1]] > tail.seq[i]) {
+                    order[at] = order[at - 1];
+                    at--;
+                }
+                order[at] = i;
+            }
+            
+            crashReport = String("{\"reason\":\"") + reason + "\",\"lines\":[";
+            for (int i = 0; i < count; i++) {
+                if (i > 0) {
+                    crashReport += ',';
+                }
+                appendJsonString(crashReport, tail.text[order[i]]);
+            }
+            crashReport += "]}";
+        }
+        
+        memset(tail.seq, 0, sizeof(tail.seq));
+        tail.magic = TAIL_MAGIC;
+        if (crashReport.length() > 0) {
+            LOGW("[Log] Previous boot ended with a %s reset", reason);
+        }
+    }
+    
+    void keepInTail(uint32_t pos, const char* text)
+    {
+        int i = pos % LOG_CRASH_TAIL_LINES;
+        tail.seq[i] = 0;
+        memcpy(tail.text[i], text, LOG_LINE_MAX);
+        tail.seq[i] = pos + 1;
+    }
+#endif
+
+    /**
+     * Write the lines that are ready (log task only)
+     */
+    void drain()
+    {
+        uint32_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = ring[pos & MASK];
+            if (sequence(slot, pos) != pos + 1) {
+                break;
+            }
+            output(slot.text, strlen(slot.text));
+            setSequence(slot, pos, pos + LOG_RING_SLOTS);
+            dequeuePos.store(++pos, std::memory_order_release);
+        }
+        
+        uint32_t lost = dropped.exchange(0, std::memory_order_relaxed);
+        if (lost > 0) {
+            char line[48];
+            int length = snprintf(line, sizeof(line), "[Log] %lu lines dropped", (unsigned long)lost);
+            output(line, length);
+        }
+    }
+
+#if defined(ARDUINO)
+    void logTaskMain(void* param)
+    {
+        for (;;) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            drain();
+        }
+    }
+#else
+    void logTaskMain()
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        for (;;) {
+            lock.unlock();
+            drain();
+            lock.lock();
+            wakeup.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+#endif
+}
+
+/**
+ * Start the log task and collect the crash tail of the previous boot
+ */
+void log_init()
+{
+#if LOG_CRASH_TAIL
+    collectTail();
+#endif
+#if defined(ARDUINO)
+    // Lowest priority above idle: the UART is fed while other tasks wait
+    if (!logTask && xTaskCreate(logTaskMain, "log", LOG_TASK_STACK_SIZE, nullptr,
+                                tskIDLE_PRIORITY + 1, &logTask) != pdPASS) {
+        logTask = nullptr;
+        drain();
+        synchronous = true;
+        LOGW("[Log] Failed to start log task, writing inline");
+        return;
+    }
+    notify();
+#else
+    if (!taskRunning) {
+        std::thread(logTaskMain).detach();
+        taskRunning = true;
+    }
+#endif
+}
+
+/**
+ * Queue one line
+ */
+void log_write(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    
+    if (synchronous) {
+        char line[LOG_LINE_MAX];
+        int length = vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        output(line, length < (int)sizeof(line) ? length : sizeof(line) - 1);
+        return;
+    }
+    // Claim the slot for the next line; drop the line if the log task is
+    // a full ring behind
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &ring[pos & MASK];
+        int32_t diff = (int32_t)(sequence(*slot, pos) - pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            va_end(args);
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    
+    vsnprintf(slot->text, LOG_LINE_MAX, format, args);
+    va_end(args);
+#if LOG_CRASH_TAIL
+    keepInTail(pos, slot->text);
+#endif
+    setSequence(*slot, pos, pos + 1);
+    notify();
+}
+
+/**
+ * Wait until the queued lines have been written
+ */
+void log_flush(unsigned long timeoutMs)
+{
+#if defined(ARDUINO)
+    unsigned long start = millis();
+    while (logTask && dequeuePos.load(std::memory_order_acquire) != enqueuePos.load(std::memory_order_relaxed) &&
+           millis() - start < timeoutMs) {
+        notify();
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+    Serial.flush();
+#else
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (taskRunning && dequeuePos.load(std::memory_order_acquire) != enqueuePos.load(std::memory_order_relaxed) &&
+           std::chrono::steady_clock::now() < deadline) {
+        notify();
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    fflush(stdout);
+#endif
+}
+
+#if LOG_CRASH_TAIL
+/**
+ * Last lines before a crash reset as compact JSON
+ */
+bool log_crash_tail(String& out)
+{
+    if (crashReport.length() == 0) {
+        return false;
+    }
+    out = crashReport;
+    return true;
+}
+#endif
+
+#if !defined(ARDUINO)
+/**
+ * Replace the output
+ */
+void log_set_sink(LogSink sink, bool sync)
+{
+    output = sink ? sink : writeStdout;
+    synchronous = sync;
+}
+#endif
@@ -0,0 +1,245 @@
+#include "MemoryProbe.h"
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Log.h"
+#define PROBE_PRINTF(...) LOGD(__VA_ARGS__)
+#else
+#include <malloc.h>
+#include <mutex>
+#include <pthread.h>
+#include <stdio.h>
+#define PROBE_PRINTF(format, ...) printf(format "\n", ##__VA_ARGS__)
+
+#ifndef MEMORY_PROBE_HOST_HEAP
+#define MEMORY_PROBE_HOST_HEAP 200000  // Free heap of the device after WiFi start
+#endif
+#endif
+
+namespace {
+    /**
+     * One reading of the platform's memory counters
+     */
+    struct Reading {
+        uint32_t freeHeap;
+        uint32_t minEver;
+        uint32_t largestBlock;
+        uint32_t stackFree;
+        uint32_t stackSize;
+        char task[16];
+    };
+    
+    /**
+     * Reading taken at the end of a phase
+     */
+    struct Sample {
+        const char* phase;
+        char task[16];
+        uint32_t freeHeap;
+        uint32_t largestBlock;
+        uint32_t stackFree;
+    };
+    
+    Sample samples[MEMORY_PROBE_SAMPLES];
+    int sampleCount = 0;
+    MemoryProbeReport report = {UINT32_MAX, "", UINT32_MAX, UINT32_MAX, 0, {}};
+
+#if defined(ARDUINO)
+    // Samples come from several tasks; the counters are read outside the
+    // critical section (the heap functions take their own locks)
+    portMUX_TYPE probeLock = portMUX_INITIALIZER_UNLOCKED;
+    
+    void lock() { portENTER_CRITICAL(&probeLock); }
+    void unlock() { portEXIT_CRITICAL(&probeLock); }
+    
+    /**
+     * Stack size of the tasks this firmware creates
+     */
+    uint32_t stackSize(const char* task)
+    {
+        static const struct {
+            const char* task;
+            uint32_t size;
+        } sizes[] = {
+#ifdef CONFIG_ARDUINO_LOOP_STACK_SIZE
+            {"loopTask", CONFIG_ARDUINO_LOOP_STACK_SIZE},
+#endif
+            {"net", NET_TASK_STACK_SIZE},
+            {"display", DISPLAY_TASK_STACK_SIZE},
+            {"parser", PARSER_TASK_STACK_SIZE},
+            {"OTA_Update", OTA_TASK_STACK_SIZE},
+            {"log", LOG_TASK_STACK_SIZE},
+        };
+        for (const auto& entry : sizes) {
+            if (strcmp(entry.task, task) == 0) {
+                return entry.size;
+            }
+        }
+        return 0;
+    }
+    
+    void read(Reading& reading)
+    {
+        reading.freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        reading.minEver = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+        reading.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        reading.stackFree = uxTaskGetStackHighWaterMark(NULL);  // Bytes on ESP-IDF
+        strncpy(reading.task, pcTaskGetName(NULL), sizeof(reading.task) - 1);
+        reading.task[sizeof(reading.task) - 1] = '\0';
+        reading.stackSize = stackSize(reading.task);
+    }
+#else
+    std::mutex probeMutex;
+    uint32_t hostMinEver = UINT32_MAX;
+    const uint8_t PAINT = 0xa5;
+    
+    void lock() { probeMutex.lock(); }
+    void unlock() { probeMutex.unlock(); }
+    
+    void read(Reading& reading)
+    {
+        struct mallinfo2 info = mallinfo2();
+        size_t used = info.uordblks + info.hblkhd;
+        reading.freeHeap = used < MEMORY_PROBE_HOST_HEAP ? MEMORY_PROBE_HOST_HEAP - used : 0;
+        reading.largestBlock = reading.freeHeap;  // No fragmentation model
+        
+        // Stacks grow down: painted bytes left at the low end were never used
+        pthread_attr_t attr;
+        void* base = nullptr;
+        size_t size = 0;
+        if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+            pthread_attr_getstack(&attr, &base, &size);
+            pthread_attr_destroy(&attr);
+        }
+        const uint8_t* bytes = static_cast<const uint8_t*>(base);
+        size_t untouched = 0;
+        while (bytes && untouched < size && bytes[untouched] == PAINT) {
+            untouched++;
+        }
+        reading.stackFree = untouched;
+        reading.stackSize = untouched > 0 ? size : 0;  // Unpainted stack: unknown
+        
+        if (pthread_getname_np(pthread_self(), reading.task, sizeof(reading.task)) != 0) {
+            strcpy(reading.task, "?");
+        }
+        
+        lock();
+        if (reading.freeHeap < hostMinEver) {
+            hostMinEver = reading.freeHeap;
+        }
+        reading.minEver = hostMinEver;
+        unlock();
+    }
+#endif
+
+    /**
+     * Stack entry of a task, added on first use (lock held)
+     */
+    MemoryProbeStack* stackEntry(const char* task)
+    {
+        for (int i = 0; i < report.stackCount; i++) {
+            if (strcmp(report.stacks[i].task, task) == 0) {
+                return &report.stacks[i];
+            }
+        }
+        if (report.stackCount >= MEMORY_PROBE_TASKS) {
+            return nullptr;
+        }
+        MemoryProbeStack& entry = report.stacks[report.stackCount++];
+        memcpy(entry.task, task, sizeof(entry.task));
+        entry.size = 0;
+        entry.minFree = UINT32_MAX;
+        return &entry;
+    }
+}
+
+/**
+ * Sample heap and the calling task's stack
+ */
+void memory_probe_sample(const char* phase)
+{
+    Reading reading;
+    read(reading);
+    
+    lock();
+    if (sampleCount < MEMORY_PROBE_SAMPLES) {
+        Sample& sample = samples[sampleCount++];
+        sample.phase = phase;
+        memcpy(sample.task, reading.task, sizeof(sample.task));
+        sample.freeHeap = reading.freeHeap;
+        sample.largestBlock = reading.largestBlock;
+        sample.stackFree = reading.stackFree;
+    }
+    
+    if (reading.freeHeap < report.heapMin) {
+        report.heapMin = reading.freeHeap;
+        report.heapMinPhase = phase;
+    }
+    if (reading.minEver < report.heapMinEver) {
+        report.heapMinEver = reading.minEver;
+    }
+    if (reading.largestBlock < report.blockMin) {
+        report.blockMin = reading.largestBlock;
+    }
+    
+    MemoryProbeStack* stack = stackEntry(reading.task);
+    if (stack) {
+        stack->size = reading.stackSize;
+        if (reading.stackFree < stack->minFree) {
+            stack->minFree = reading.stackFree;
+        }
+    }
+    unlock();
+}
+
+/**
+ * Lowest values seen so far
+ */
+const MemoryProbeReport& memory_probe_report()
+{
+    return report;
+}
+
+/**
+ * Print the per-phase samples and stack headroom
+ */
+void memory_probe_print()
+{
+    if (sampleCount == 0) {
+        return;
+    }
+    
+    PROBE_PRINTF("[Memory] phase        task          heap   block  stack");
+    for (int i = 0; i < sampleCount; i++) {
+        const Sample& sample = samples[i];
+        PROBE_PRINTF("[Memory] %-12s %-12s %6lu %6lu %6lu", sample.phase, sample.task,
+                     (unsigned long)sample.freeHeap, (unsigned long)sample.largestBlock,
+                     (unsigned long)sample.stackFree);
+    }
+    PROBE_PRINTF("[Memory] heap min %lu at %s (ever %lu), largest block min %lu",
+                 (unsigned long)report.heapMin, report.heapMinPhase,
+                 (unsigned long)report.heapMinEver, (unsigned long)report.blockMin);
+    for (int i = 0; i < report.stackCount; i++) {
+        const MemoryProbeStack& stack = report.stacks[i];
+        if (stack.size > 0) {
+            PROBE_PRINTF("[Memory] stack %-12s %6lu of %6lu bytes free", stack.task,
+                         (unsigned long)stack.minFree, (unsigned long)stack.size);
+        } else {
+            PROBE_PRINTF("[Memory] stack %-12s %6lu bytes free", stack.task, (unsigned long)stack.minFree);
+        }
+    }
+}
+
+#if !defined(ARDUINO)
+/**
+ * Fill a thread stack with the paint pattern
+ */
+void memory_probe_paint(void* stack, uint32_t size)
+{
+    memset(stack, PAINT, size);
+}
+#endif
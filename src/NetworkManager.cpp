@@ -1,7 +1,11 @@
 #include "NetworkManager.h"
 #include "Config.h"
+#include "Log.h"
 #include "Settings.h"
+#include "PhaseTrace.h"
+#include "MemoryProbe.h"
 #include <cstring>
+#include <lwip/sockets.h>
 
 // Static instance for callbacks
 NetworkManager* NetworkManager::instance = nullptr;
@@ -18,7 +22,21 @@ NetworkManager::NetworkManager()
       paramMqttPassword(nullptr),
       paramMqttTopic(nullptr),
       paramSleepHours(nullptr),
-      messageReceived(false)
+      paramAlwaysOn(nullptr),
+      paramQuietHours(nullptr),
+      paramTimezone(nullptr),
+      paramPublishPeriod(nullptr),
+      machine(*this, WIFI_CONNECT_TIMEOUT, MQTT_CONNECT_TIMEOUT, MQTT_RETRY_MS),
+      netTask(nullptr),
+      netEvents(nullptr),
+      netBits(nullptr),
+      mqttLock(nullptr),
+      payloadSink(nullptr),
+      messageHandler(nullptr),
+      handlerContext(nullptr),
+      messageCount(0),
+      deliveryArmed(false),
+      listening(false)
 {
     setInstance(this);
     mqttClient = new PubSubClient(wifiClient);
@@ -39,6 +57,10 @@ NetworkManager::~NetworkManager()
     delete paramMqttPassword;
     delete paramMqttTopic;
     delete paramSleepHours;
+    delete paramAlwaysOn;
+    delete paramQuietHours;
+    delete paramTimezone;
+    delete paramPublishPeriod;
     
     delete mqttClient;
 }
@@ -55,6 +77,17 @@ void NetworkManager::loadSettings()
     strncpy(mqttPasswordStr, settings_get_string("mqtt_password", "").c_str(), sizeof(mqttPasswordStr) - 1);
     strncpy(mqttTopicStr, settings_get_string("mqtt_topic", "").c_str(), sizeof(mqttTopicStr) - 1);
     snprintf(sleepHoursStr, sizeof(sleepHoursStr), "%d", settings_get_int("sleep_hours", DEFAULT_SLEEP_HOURS));
+    snprintf(alwaysOnStr, sizeof(alwaysOnStr), "%d", settings_get_bool("always_on", false) ? 1 : 0);
+    
+    int quietStart = settings_get_int("quiet_start", SLEEP_QUIET_START);
+    int quietEnd = settings_get_int("quiet_end", SLEEP_QUIET_END);
+    if (quietStart >= 0 && quietEnd >= 0) {
+        snprintf(quietHoursStr, sizeof(quietHoursStr), "%d-%d", quietStart, quietEnd);
+    } else {
+        quietHoursStr[0] = '\0';
+    }
+    strncpy(timezoneStr, settings_get_string("timezone", CLOCK_TIMEZONE).c_str(), sizeof(timezoneStr) - 1);
+    snprintf(publishPeriodStr, sizeof(publishPeriodStr), "%d", settings_get_int("publish_period", CLOCK_PUBLISH_PERIOD_MIN));
 }
 
 /**
@@ -78,6 +111,10 @@ void NetworkManager::initConfigPortal()
     paramMqttPassword = new WiFiManagerParameter("mqtt_password", "MQTT Password (optional)", mqttPasswordStr, 64, "type=\"password\"");
     paramMqttTopic = new WiFiManagerParameter("mqtt_topic", "MQTT Topic to Subscribe", mqttTopicStr, 128);
     paramSleepHours = new WiFiManagerParameter("sleep_hours", "Sleep Hours (1-24)", sleepHoursStr, 16);
+    paramAlwaysOn = new WiFiManagerParameter("always_on", "Always On (1 = USB powered, no deep sleep)", alwaysOnStr, 4);
+    paramQuietHours = new WiFiManagerParameter("quiet_hours", "Quiet Hours (e.g. 22-7, empty = none)", quietHoursStr, 8);
+    paramTimezone = new WiFiManagerParameter("timezone", "Timezone (POSIX TZ, e.g. CET-1CEST,M3.5.0,M10.5.0/3)", timezoneStr, 48);
+    paramPublishPeriod = new WiFiManagerParameter("publish_period", "Publish Period (minutes, 0 = do not align)", publishPeriodStr, 8);
     
     // Add parameters to WiFiManager (WiFi SSID/Password removed - using built-in scan)
     wifiManager.addParameter(paramNodeName);
@@ -87,6 +124,10 @@ void NetworkManager::initConfigPortal()
     wifiManager.addParameter(paramMqttPassword);
     wifiManager.addParameter(paramMqttTopic);
     wifiManager.addParameter(paramSleepHours);
+    wifiManager.addParameter(paramAlwaysOn);
+    wifiManager.addParameter(paramQuietHours);
+    wifiManager.addParameter(paramTimezone);
+    wifiManager.addParameter(paramPublishPeriod);
 }
 
 /**
@@ -96,9 +137,9 @@ bool NetworkManager::startConfigPortal(const char* portalName, const char* passw
 {
     initConfigPortal();
     
-    Serial.printf("Starting config portal: %s\r\n", portalName);
+    LOGI("Starting config portal: %s", portalName);
     if (password) {
-        Serial.printf("AP Password: %s\r\n", password);
+        LOGI("AP Password: %s", password);
     }
     
     if (timeoutSeconds > 0) {
@@ -127,7 +168,7 @@ void NetworkManager::saveConfigCallback()
  */
 void NetworkManager::saveSettings()
 {
-    Serial.println("Saving configuration...");
+    LOGI("Saving configuration...");
     
     // Save custom MQTT parameters only (WiFi credentials saved by WiFiManager automatically)
     settings_put_string("node_name", paramNodeName->getValue());
@@ -137,44 +178,98 @@ void NetworkManager::saveSettings()
     settings_put_string("mqtt_password", paramMqttPassword->getValue());
     settings_put_string("mqtt_topic", paramMqttTopic->getValue());
     settings_put_int("sleep_hours", atoi(paramSleepHours->getValue()));
+    settings_put_bool("always_on", atoi(paramAlwaysOn->getValue()) != 0);
+    
+    // Quiet hours as "start-end" (hours of the day); anything else clears them
+    int quietStart = -1, quietEnd = -1;
+    if (sscanf(paramQuietHours->getValue(), "%d-%d", &quietStart, &quietEnd) != 2 ||
+        quietStart < 0 || quietStart > 23 || quietEnd < 0 || quietEnd > 23) {
+        quietStart = quietEnd = -1;
+    }
+    settings_put_int("quiet_start", quietStart);
+    settings_put_int("quiet_end", quietEnd);
+    settings_put_string("timezone", paramTimezone->getValue());
+    settings_put_int("publish_period", atoi(paramPublishPeriod->getValue()));
     
     // Mark that configuration has been saved
     settings_put_bool("config_done", true);
     
-    Serial.println("Configuration saved!");
-    Serial.println("Settings stored:");
-    Serial.printf("  Node Name: %s\r\n", paramNodeName->getValue());
-    Serial.printf("  MQTT Broker: %s\r\n", paramMqttBroker->getValue());
-    Serial.printf("  MQTT Topic: %s\r\n", paramMqttTopic->getValue());
-    Serial.printf("  Sleep Hours: %s\r\n", paramSleepHours->getValue());
-    Serial.println("  WiFi credentials: saved by WiFiManager");
+    LOGI("Configuration saved!");
+    LOGD("Settings stored:");
+    LOGD("  Node Name: %s", paramNodeName->getValue());
+    LOGD("  MQTT Broker: %s", paramMqttBroker->getValue());
+    LOGD("  MQTT Topic: %s", paramMqttTopic->getValue());
+    LOGD("  Sleep Hours: %s", paramSleepHours->getValue());
+    LOGD("  Always On: %s", paramAlwaysOn->getValue());
+    LOGD("  Quiet Hours: %s", paramQuietHours->getValue());
+    LOGD("  Timezone: %s", paramTimezone->getValue());
+    LOGD("  Publish Period: %s", paramPublishPeriod->getValue());
+    LOGD("  WiFi credentials: saved by WiFiManager");
 }
 
 /**
- * Connect to WiFi using saved credentials (from WiFiManager's storage)
+ * Start connecting to WiFi using saved credentials
  */
-bool NetworkManager::connectWiFi()
+void NetworkManager::startWiFi()
 {
-    Serial.println("Connecting to WiFi using saved credentials...");
-    
-    WiFi.mode(WIFI_STA);
-    // WiFi.begin() without parameters uses saved credentials from flash
-    WiFi.begin();
+    startTask();
+    post(NET_EV_START_WIFI);
+}
+
+/**
+ * Request the MQTT connection
+ */
+bool NetworkManager::startMQTT(const char* clientId)
+{
+    String broker = settings_get_string("mqtt_broker", "");
+    int port = settings_get_int("mqtt_port", DEFAULT_MQTT_PORT);
     
-    unsigned long startTime = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - startTime < WIFI_CONNECT_TIMEOUT) {
-        delay(500);
-        Serial.println(".");
+    if (broker.length() == 0) {
+        LOGE("No MQTT broker configured");
+        return false;
     }
     
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.printf("WiFi connected to: %s\r\n", WiFi.SSID().c_str());
-        Serial.printf("IP address: %s\r\n", WiFi.localIP().toString().c_str());
-        return true;
-    } else {
-        Serial.println("WiFi connection failed - no saved credentials or invalid");
+    LOGI("Connecting to MQTT broker: %s:%d", broker.c_str(), port);
+    
+    startTask();
+    xSemaphoreTake(mqttLock, portMAX_DELAY);
+    this->clientId = clientId;
+    brokerUser = settings_get_string("mqtt_user", "");
+    brokerPassword = settings_get_string("mqtt_password", "");
+    mqttClient->setServer(broker.c_str(), port);
+    xSemaphoreGive(mqttLock);
+    
+    post(NET_EV_START_MQTT);
+    return true;
+}
+
+/**
+ * Wait until all of the given status bits are set
+ */
+bool NetworkManager::waitFor(uint32_t bits, unsigned long timeoutMs)
+{
+    if (!netBits) {
         return false;
     }
+    
+    unsigned long startTime = millis();
+    for (;;) {
+        EventBits_t current = xEventGroupGetBits(netBits);
+        if ((current & bits) == bits) {
+            return true;
+        }
+        if (current & NET_BIT_FAILED) {
+            return false;
+        }
+        
+        unsigned long elapsed = millis() - startTime;
+        if (elapsed >= timeoutMs) {
+            return false;
+        }
+        // Wake on any change of the awaited or failure bits
+        xEventGroupWaitBits(netBits, bits | NET_BIT_FAILED, pdFALSE, pdFALSE,
+                            pdMS_TO_TICKS(timeoutMs - elapsed));
+    }
 }
 
 /**
@@ -188,84 +283,73 @@ void NetworkManager::setMQTTLastWill(const char* topic, const char* payload)
 }
 
 /**
- * Connect to MQTT broker
+ * Subscribe to MQTT topic
  */
-bool NetworkManager::connectMQTT(const char* clientId)
+bool NetworkManager::subscribeMQTT(const char* topic)
 {
-    String broker = settings_get_string("mqtt_broker", "");
-    int port = settings_get_int("mqtt_port", DEFAULT_MQTT_PORT);
-    String user = settings_get_string("mqtt_user", "");
-    String password = settings_get_string("mqtt_password", "");
+    LOGD("Subscribing to topic: %s", topic);
     
-    if (broker.length() == 0) {
-        Serial.println("No MQTT broker configured");
-        return false;
-    }
-    
-    Serial.printf("Connecting to MQTT broker: %s:%d\r\n", broker.c_str(), port);
-    
-    mqttClient->setServer(broker.c_str(), port);
+    xSemaphoreTake(mqttLock, portMAX_DELAY);
+    bool subscribed = mqttClient->subscribe(topic);
+    xSemaphoreGive(mqttLock);
     
-    unsigned long startTime = millis();
-    bool connected = false;
-    
-    while (!connected && millis() - startTime < MQTT_CONNECT_TIMEOUT) {
-        // Connect with LWT if configured
-        if (lwtTopic.length() > 0) {
-            if (user.length() > 0) {
-                connected = mqttClient->connect(clientId, user.c_str(), password.c_str(),
-                                               lwtTopic.c_str(), 0, true, lwtPayload.c_str());
-            } else {
-                connected = mqttClient->connect(clientId, nullptr, nullptr,
-                                               lwtTopic.c_str(), 0, true, lwtPayload.c_str());
-            }
-        } else {
-            if (user.length() > 0) {
-                connected = mqttClient->connect(clientId, user.c_str(), password.c_str());
-            } else {
-                connected = mqttClient->connect(clientId);
-            }
-        }
-        
-        if (!connected) {
-            Serial.println(".");
-            delay(500);
-        }
-    }
-    
-    if (connected) {
-        Serial.println("MQTT connected!");
-        return true;
-    } else {
-        Serial.printf("MQTT connection failed, state: %d\r\n", mqttClient->state());
-        return false;
+    if (subscribed) {
+        xEventGroupSetBits(netBits, NET_BIT_SUBSCRIBED);
     }
+    return subscribed;
 }
 
 /**
- * Subscribe to MQTT topic
+ * Unsubscribe from MQTT topic
  */
-bool NetworkManager::subscribeMQTT(const char* topic)
+bool NetworkManager::unsubscribeMQTT(const char* topic)
 {
-    Serial.printf("Subscribing to topic: %s\r\n", topic);
-    return mqttClient->subscribe(topic);
+    LOGD("Unsubscribing from topic: %s", topic);
+    
+    xSemaphoreTake(mqttLock, portMAX_DELAY);
+    bool unsubscribed = mqttClient->unsubscribe(topic);
+    xSemaphoreGive(mqttLock);
+    return unsubscribed;
 }
 
 /**
  * MQTT callback (static)
+ * Runs in the network task
  */
 void NetworkManager::mqttCallback(char* topic, byte* payload, unsigned int length)
 {
-    if (instance) {
+    if (instance && instance->listening) {
+        // The counter got the whole payload, the buffer only what fit
+        size_t bytes = instance->liveCounter.bytes;
+        instance->liveCounter.bytes = 0;
+        if (bytes > length) {
+            LOGW("MQTT message on %s dropped: %u bytes exceed the %d byte buffer",
+                 topic, (unsigned)bytes, LIVE_MQTT_BUFFER_SIZE);
+            return;
+        }
+    }
+    if (instance && instance->messageHandler) {
+        instance->messageHandler(topic, payload, length, instance->handlerContext);
+        instance->messageCount++;
+        xEventGroupSetBits(instance->netBits, NET_BIT_DELIVERED);
+    } else if (instance && instance->payloadSink) {
+        // Payload was already written to the stream; the buffer only holds
+        // the part that fit, so it must not be read here
+        if (instance->streamTopic == topic) {
+            xEventGroupSetBits(instance->netBits, NET_BIT_DELIVERED);
+        }
+        LOGD("MQTT message received on topic %s: %u bytes (streamed)", topic, length);
+    } else if (instance) {
         // Convert payload to string
         char* buffer = new char[length + 1];
         memcpy(buffer, payload, length);
         buffer[length] = '\0';
         
         instance->lastMessage = String(buffer);
-        instance->messageReceived = true;
+        xEventGroupSetBits(instance->netBits, NET_BIT_DELIVERED);
         
-        Serial.printf("MQTT message received on topic %s: %s\r\n", topic, buffer);
+        LOGD("MQTT message received on topic %s: %u bytes", topic, length);
+        LOGV("Payload: %s", buffer);
         
         delete[] buffer;
     }
@@ -276,16 +360,143 @@ void NetworkManager::mqttCallback(char* topic, byte* payload, unsigned int lengt
  */
 String NetworkManager::getLastRetainedMessage(unsigned long timeoutMs)
 {
-    messageReceived = false;
+    TRACE_SCOPE(TRACE_RETAINED_WAIT);
     lastMessage = "";
+    waitDelivered(timeoutMs);
+    return lastMessage;
+}
+
+/**
+ * Wait for a retained message, streaming its payload
+ */
+bool NetworkManager::streamRetainedMessage(const char* topic, Stream& sink, unsigned long timeoutMs)
+{
+    TRACE_SCOPE(TRACE_RETAINED_WAIT);
+    xSemaphoreTake(mqttLock, portMAX_DELAY);
+    payloadSink = &sink;
+    streamTopic = topic;
+    mqttClient->setStream(sink);
+    xSemaphoreGive(mqttLock);
+    
+    return waitDelivered(timeoutMs);
+}
+
+/**
+ * Collect the retained messages of all subscribed topics
+ */
+int NetworkManager::collectRetainedMessages(MessageHandler handler, void* context,
+                                            unsigned long timeoutMs, unsigned long idleMs)
+{
+    TRACE_SCOPE(TRACE_RETAINED_WAIT);
+    xSemaphoreTake(mqttLock, portMAX_DELAY);
+    messageHandler = handler;
+    handlerContext = context;
+    messageCount = 0;
+    xSemaphoreGive(mqttLock);
     
+    // Every delivery restarts the idle period
     unsigned long startTime = millis();
-    while (!messageReceived && millis() - startTime < timeoutMs) {
-        mqttClient->loop();
-        delay(10);
+    unsigned long wait = timeoutMs;
+    while (waitDelivered(wait)) {
+        unsigned long elapsed = millis() - startTime;
+        if (elapsed >= timeoutMs) {
+            break;
+        }
+        wait = min(idleMs, timeoutMs - elapsed);
     }
     
-    return lastMessage;
+    xSemaphoreTake(mqttLock, portMAX_DELAY);
+    messageHandler = nullptr;
+    int count = messageCount;
+    xSemaphoreGive(mqttLock);
+    return count;
+}
+
+/**
+ * Wait for a message delivery
+ * Incoming packets stay in the socket until a receiver is armed, so retained
+ * messages sent right after subscribing are not lost before this call.
+ */
+bool NetworkManager::waitDelivered(unsigned long timeoutMs)
+{
+    if (!netBits) {
+        return false;
+    }
+    
+    xSemaphoreTake(mqttLock, portMAX_DELAY);
+    xEventGroupClearBits(netBits, NET_BIT_DELIVERED);
+    deliveryArmed = true;
+    xSemaphoreGive(mqttLock);
+    
+    EventBits_t bits = xEventGroupWaitBits(netBits, NET_BIT_DELIVERED, pdFALSE, pdFALSE,
+                                           pdMS_TO_TICKS(timeoutMs));
+    
+    xSemaphoreTake(mqttLock, portMAX_DELAY);
+    deliveryArmed = false;
+    xSemaphoreGive(mqttLock);
+    return (bits & NET_BIT_DELIVERED) != 0;
+}
+
+/**
+ * Pass every incoming message to a handler
+ */
+void NetworkManager::listen(MessageHandler handler, void* context)
+{
+    startTask();
+    xSemaphoreTake(mqttLock, portMAX_DELAY);
+    messageHandler = handler;
+    handlerContext = context;
+    messageCount = 0;
+    payloadSink = nullptr;
+    mqttClient->setBufferSize(LIVE_MQTT_BUFFER_SIZE);
+    
+    // Replaces the payload stream of the retained message, if any
+    liveCounter.bytes = 0;
+    mqttClient->setStream(liveCounter);
+    listening = true;
+    xSemaphoreGive(mqttLock);
+}
+
+/**
+ * Count a payload byte
+ */
+size_t NetworkManager::PayloadCounter::write(uint8_t c)
+{
+    (void)c;
+    bytes++;
+    return 1;
+}
+
+/**
+ * Nothing to read back
+ */
+int NetworkManager::PayloadCounter::available()
+{
+    return 0;
+}
+
+/**
+ * Nothing to read back
+ */
+int NetworkManager::PayloadCounter::read()
+{
+    return -1;
+}
+
+/**
+ * Nothing to read back
+ */
+int NetworkManager::PayloadCounter::peek()
+{
+    return -1;
+}
+
+/**
+ * Current status bits
+ */
+uint32_t NetworkManager::status() const
+{
+    return netBits ? xEventGroupGetBits(netBits) : 0;
 }
 
 /**
@@ -293,18 +504,24 @@ String NetworkManager::getLastRetainedMessage(unsigned long timeoutMs)
  */
 bool NetworkManager::publishMQTT(const char* topic, const char* payload, bool retained)
 {
-    Serial.printf("Publishing to %s: %s\r\n", topic, payload);
-    return mqttClient->publish(topic, payload, retained);
+    LOGD("Publishing to %s: %u bytes", topic, (unsigned)strlen(payload));
+    LOGV("Payload: %s", payload);
+    
+    xSemaphoreTake(mqttLock, portMAX_DELAY);
+    bool published = mqttClient->publish(topic, payload, retained);
+    xSemaphoreGive(mqttLock);
+    return published;
 }
 
 /**
  * Disconnect from MQTT
+ * Stops the network task's connections (broker first, then WiFi)
  */
 void NetworkManager::disconnectMQTT()
 {
-    if (mqttClient->connected()) {
-        mqttClient->disconnect();
-        Serial.println("MQTT disconnected");
+    if (netTask) {
+        post(NET_EV_STOP);
+        waitFor(NET_BIT_STOPPED, MQTT_CONNECT_TIMEOUT);
     }
 }
 
@@ -313,10 +530,207 @@ void NetworkManager::disconnectMQTT()
  */
 void NetworkManager::disconnectWiFi()
 {
-    if (WiFi.status() == WL_CONNECTED) {
+    if (netTask) {
+        post(NET_EV_STOP);
+        waitFor(NET_BIT_STOPPED, MQTT_CONNECT_TIMEOUT);
+    } else if (WiFi.status() == WL_CONNECTED) {
         WiFi.disconnect();
-        Serial.println("WiFi disconnected");
+        LOGI("WiFi disconnected");
+    }
+}
+
+/**
+ * Create the network task and its queue, event group and mutex
+ */
+void NetworkManager::startTask()
+{
+    if (netTask) {
+        return;
+    }
+    
+    netEvents = xQueueCreate(8, sizeof(NetEvent));
+    netBits = xEventGroupCreate();
+    mqttLock = xSemaphoreCreateMutex();
+    
+    WiFi.onEvent(onWiFiEvent, ARDUINO_EVENT_WIFI_STA_CONNECTED);
+    WiFi.onEvent(onWiFiEvent, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    WiFi.onEvent(onWiFiEvent, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    
+    // Same core as the WiFi/network stack
+    xTaskCreatePinnedToCore(netTaskMain, "net", NET_TASK_STACK_SIZE, this, 2, &netTask, 1);
+}
+
+/**
+ * Queue an event for the network task
+ */
+void NetworkManager::post(NetEvent event)
+{
+    if (xQueueSend(netEvents, &event, pdMS_TO_TICKS(100)) != pdTRUE) {
+        LOGW("[Net] Event queue full, dropped event %d", event);
+    }
+}
+
+/**
+ * WiFi event handler
+ */
+void NetworkManager::onWiFiEvent(arduino_event_id_t event, WiFiEventInfo_t info)
+{
+    if (!instance) {
+        return;
+    }
+    if (event == ARDUINO_EVENT_WIFI_STA_CONNECTED) {
+        // Associated; DHCP follows
+        TRACE_END(TRACE_WIFI);
+        TRACE_BEGIN(TRACE_DHCP);
+    } else if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        TRACE_END(TRACE_DHCP);
+        instance->post(NET_EV_WIFI_UP);
+    } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+        instance->post(NET_EV_WIFI_DOWN);
+    }
+}
+
+/**
+ * Network task body
+ * Runs the state machine, mirrors its status into the event group and
+ * sleeps until an event arrives, the socket becomes readable or a timer
+ * of the state machine is due.
+ */
+void NetworkManager::netTaskMain(void* param)
+{
+    NetworkManager* self = static_cast<NetworkManager*>(param);
+    NetState lastState = NET_IDLE;
+    const EventBits_t mirrored = NET_BIT_WIFI | NET_BIT_MQTT | NET_BIT_FAILED | NET_BIT_STOPPED;
+    
+    for (;;) {
+        xSemaphoreTake(self->mqttLock, portMAX_DELAY);
+        uint32_t waitMs = self->machine.step(millis());
+        NetState state = self->machine.state();
+        uint32_t status = self->machine.bits();
+        bool receiving = self->deliveryArmed || self->listening;
+        xSemaphoreGive(self->mqttLock);
+        
+        EventBits_t clear = mirrored & ~status;
+        if (!(status & NET_BIT_MQTT)) {
+            clear |= NET_BIT_SUBSCRIBED;
+        }
+        xEventGroupClearBits(self->netBits, clear);
+        xEventGroupSetBits(self->netBits, status & mirrored);
+        
+        if (state != lastState) {
+            LOGD("[Net] %s -> %s", NetworkStateMachine::stateName(lastState),
+                 NetworkStateMachine::stateName(state));
+            memory_probe_sample(NetworkStateMachine::stateName(lastState));
+            lastState = state;
+        }
+        
+        if (state == NET_ONLINE) {
+            if (receiving || self->wifiClient.available() == 0) {
+                self->waitReadable(NET_POLL_MS);
+                waitMs = 0;
+            } else {
+                // Data is held until a receiver is armed
+                waitMs = NET_POLL_MS;
+            }
+        }
+        
+        NetEvent event;
+        if (xQueueReceive(self->netEvents, &event, pdMS_TO_TICKS(waitMs)) == pdTRUE) {
+            xSemaphoreTake(self->mqttLock, portMAX_DELAY);
+            self->machine.handle(event, millis());
+            xSemaphoreGive(self->mqttLock);
+        }
+    }
+}
+
+/**
+ * Wait until the MQTT socket is readable or timeoutMs elapsed
+ */
+void NetworkManager::waitReadable(uint32_t timeoutMs)
+{
+    int fd = wifiClient.fd();
+    if (fd < 0 || wifiClient.available() > 0) {
+        return;
+    }
+    
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(fd, &readable);
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = timeoutMs * 1000;
+    select(fd + 1, &readable, nullptr, nullptr, &timeout);
+}
+
+/**
+ * Start WiFi association
+ */
+void NetworkManager::wifiBegin()
+{
+    LOGI("Connecting to WiFi using saved credentials...");
+    TRACE_BEGIN(TRACE_WIFI);
+    WiFi.mode(WIFI_STA);
+    // WiFi.begin() without parameters uses saved credentials from flash
+    WiFi.begin();
+}
+
+/**
+ * Disconnect WiFi
+ */
+void NetworkManager::wifiEnd()
+{
+    WiFi.disconnect();
+    LOGI("WiFi disconnected");
+}
+
+/**
+ * One MQTT connect attempt, with LWT if configured
+ */
+bool NetworkManager::mqttConnect()
+{
+    TRACE_SCOPE(TRACE_MQTT_CONNECT);
+    const char* user = brokerUser.length() > 0 ? brokerUser.c_str() : nullptr;
+    const char* password = brokerUser.length() > 0 ? brokerPassword.c_str() : nullptr;
+    
+    bool connected;
+    if (lwtTopic.length() > 0) {
+        connected = mqttClient->connect(clientId.c_str(), user, password,
+                                        lwtTopic.c_str(), 0, true, lwtPayload.c_str());
+    } else {
+        connected = mqttClient->connect(clientId.c_str(), user, password);
+    }
+    
+    if (!connected) {
+        LOGW("MQTT connect attempt failed, state: %d", mqttClient->state());
+    }
+    return connected;
+}
+
+/**
+ * Disconnect from the broker
+ */
+void NetworkManager::mqttDisconnect()
+{
+    mqttClient->disconnect();
+    LOGI("MQTT disconnected");
+}
+
+/**
+ * Process pending incoming packets
+ * PubSubClient handles one packet per loop()
+ */
+bool NetworkManager::mqttPoll()
+{
+    if (!deliveryArmed && !listening && wifiClient.available() > 0) {
+        // Hold incoming messages until a receiver waits for them
+        return mqttClient->connected();
+    }
+    
+    bool connected = mqttClient->loop();
+    while (connected && wifiClient.available() > 0) {
+        connected = mqttClient->loop();
     }
+    return connected;
 }
 
 /**
@@ -0,0 +1,167 @@
+#include "NetworkStateMachine.h"
+
+namespace {
+    const uint32_t IDLE_WAIT_MS = 1000;  // Nothing due, wait for events
+}
+
+/**
+ * Constructor
+ */
+NetworkStateMachine::NetworkStateMachine(NetworkTransport& transport, uint32_t wifiTimeoutMs,
+                                         uint32_t mqttTimeoutMs, uint32_t retryMs)
+    : transport(transport),
+      wifiTimeoutMs(wifiTimeoutMs),
+      mqttTimeoutMs(mqttTimeoutMs),
+      retryMs(retryMs),
+      current(NET_IDLE),
+      status(0),
+      mqttRequested(false),
+      deadline(0),
+      retryAt(0)
+{
+}
+
+/**
+ * Handle an event
+ */
+void NetworkStateMachine::handle(NetEvent event, uint32_t now)
+{
+    switch (event) {
+        case NET_EV_START_WIFI:
+            if (current == NET_IDLE || current == NET_STOPPED || current == NET_FAILED) {
+                status &= ~(NET_BIT_FAILED | NET_BIT_STOPPED);
+                transport.wifiBegin();
+                enter(NET_WIFI_CONNECTING, now);
+            }
+            break;
+        
+        case NET_EV_START_MQTT:
+            mqttRequested = true;
+            if (current == NET_WIFI_READY) {
+                wifiReady(now);
+            }
+            break;
+        
+        case NET_EV_WIFI_UP:
+            status |= NET_BIT_WIFI;
+            if (current == NET_WIFI_CONNECTING) {
+                wifiReady(now);
+            }
+            break;
+        
+        case NET_EV_WIFI_DOWN:
+            status &= ~(NET_BIT_WIFI | NET_BIT_MQTT | NET_BIT_SUBSCRIBED);
+            if (current == NET_WIFI_READY || current == NET_MQTT_CONNECTING ||
+                current == NET_MQTT_RETRY || current == NET_ONLINE) {
+                // The WiFi stack reconnects on its own
+                enter(NET_WIFI_CONNECTING, now);
+            }
+            break;
+        
+        case NET_EV_STOP:
+            if (current == NET_ONLINE) {
+                transport.mqttDisconnect();
+            }
+            if (current != NET_IDLE && current != NET_STOPPED) {
+                transport.wifiEnd();
+            }
+            status = (status & NET_BIT_FAILED) | NET_BIT_STOPPED;
+            mqttRequested = false;
+            enter(NET_STOPPED, now);
+            break;
+    }
+}
+
+/**
+ * Run due work
+ */
+uint32_t NetworkStateMachine::step(uint32_t now)
+{
+    switch (current) {
+        case NET_WIFI_CONNECTING:
+            if (reached(now, deadline)) {
+                enter(NET_FAILED, now);
+                return IDLE_WAIT_MS;
+            }
+            return deadline - now;
+        
+        case NET_MQTT_CONNECTING:
+            if (transport.mqttConnect()) {
+                status |= NET_BIT_MQTT;
+                enter(NET_ONLINE, now);
+                return 0;
+            }
+            if (reached(now, deadline)) {
+                enter(NET_FAILED, now);
+                return IDLE_WAIT_MS;
+            }
+            retryAt = now + retryMs;
+            enter(NET_MQTT_RETRY, now);
+            return retryMs;
+        
+        case NET_MQTT_RETRY:
+            if (reached(now, retryAt)) {
+                enter(NET_MQTT_CONNECTING, now);
+                return 0;
+            }
+            return retryAt - now;
+        
+        case NET_ONLINE:
+            if (!transport.mqttPoll()) {
+                // Broker dropped us: reconnect within a fresh timeout
+                status &= ~(NET_BIT_MQTT | NET_BIT_SUBSCRIBED);
+                deadline = now + mqttTimeoutMs;
+                retryAt = now + retryMs;
+                enter(NET_MQTT_RETRY, now);
+                return retryMs;
+            }
+            return 0;  // Keep servicing the socket
+        
+        default:
+            return IDLE_WAIT_MS;
+    }
+}
+
+/**
+ * Enter a state
+ */
+void NetworkStateMachine::enter(NetState next, uint32_t now)
+{
+    if (next == NET_WIFI_CONNECTING) {
+        deadline = now + wifiTimeoutMs;
+    } else if (next == NET_FAILED) {
+        status |= NET_BIT_FAILED;
+    }
+    current = next;
+}
+
+/**
+ * WiFi is up: connect to the broker if requested
+ */
+void NetworkStateMachine::wifiReady(uint32_t now)
+{
+    if (!mqttRequested) {
+        enter(NET_WIFI_READY, now);
+        return;
+    }
+    deadline = now + mqttTimeoutMs;
+    enter(NET_MQTT_CONNECTING, now);
+}
+
+/**
+ * Readable name of a state
+ */
+const char* NetworkStateMachine::stateName(NetState state)
+{
+    switch (state) {
+        case NET_IDLE:            return "idle";
+        case NET_WIFI_CONNECTING: return "wifi-connecting";
+        case NET_WIFI_READY:      return "wifi-ready";
+        case NET_MQTT_CONNECTING: return "mqtt-connecting";
+        case NET_MQTT_RETRY:      return "mqtt-retry";
+        case NET_ONLINE:          return "online";
+        case NET_FAILED:          return "failed";
+        case NET_STOPPED:         return "stopped";
+    }
+    return "?";
+}
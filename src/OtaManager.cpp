@@ -1,5 +1,8 @@
 #include "OtaManager.h"
+#include "Config.h"
+#include "Log.h"
 #include "Settings.h"
+#include "MemoryProbe.h"
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 #include <HTTPClient.h>
@@ -69,22 +72,22 @@ bool OtaManager::base64Decode(unsigned char* output, const char* input, int leng
 
 bool OtaManager::verifySignature(const String& url, const String& md5sum, const String& signature_b64) {
     if (url.length() == 0 || md5sum.length() == 0 || signature_b64.length() == 0) {
-        Serial.println("[OTA] Empty url, md5sum, or signature");
+        LOGE("[OTA] Empty url, md5sum, or signature");
         return false;
     }
 
     String message = url + md5sum;
-    Serial.printf("[OTA] Verifying signature for message: %s\r\n", message.c_str());
-    Serial.printf("[OTA] Signature (base64): %s\r\n", signature_b64.c_str());
+    LOGV("[OTA] Verifying signature for message: %s", message.c_str());
+    LOGV("[OTA] Signature (base64): %s", signature_b64.c_str());
 
     // Get public key from build flag
     const char* pubkey_hex = IDENTITYLABS_PUB_KEY;
-    Serial.printf("[OTA] Public key: %s\r\n", pubkey_hex);
+    LOGV("[OTA] Public key: %s", pubkey_hex);
 
     // Convert hex public key to bytes
     unsigned char pubkey[32];
     if (strlen(pubkey_hex) != 64) {
-        Serial.println("[OTA] Invalid public key length");
+        LOGE("[OTA] Invalid public key length");
         return false;
     }
 
@@ -96,23 +99,23 @@ bool OtaManager::verifySignature(const String& url, const String& md5sum, const
     // Decode base64 signature
     int sig_len = base64DecLen(signature_b64.c_str(), signature_b64.length());
     if (sig_len != 64) {
-        Serial.printf("[OTA] Invalid signature length: %d\r\n", sig_len);
+        LOGE("[OTA] Invalid signature length: %d", sig_len);
         return false;
     }
 
     unsigned char sig[64];
     if (!base64Decode(sig, signature_b64.c_str(), signature_b64.length())) {
-        Serial.println("[OTA] Failed to decode base64 signature");
+        LOGE("[OTA] Failed to decode base64 signature");
         return false;
     }
 
     // Verify signature using Ed25519
     if (!Ed25519::verify(sig, pubkey, (const uint8_t*)message.c_str(), message.length())) {
-        Serial.println("[OTA] Signature verification failed");
+        LOGE("[OTA] Signature verification failed");
         return false;
     }
 
-    Serial.println("[OTA] Signature verification successful");
+    LOGI("[OTA] Signature verification successful");
     return true;
 }
 
@@ -121,13 +124,13 @@ void OtaManager::otaTask(void* pvParameters) {
     OtaTaskParams* params = (OtaTaskParams*)pvParameters;
     bool success = false;
     
-    Serial.println("[OTA Task] Started in dedicated FreeRTOS task");
-    Serial.printf("[OTA Task] Free heap: %d bytes\r\n", ESP.getFreeHeap());
-    Serial.printf("[OTA Task] Stack high water mark: %d bytes\r\n", uxTaskGetStackHighWaterMark(NULL));
+    LOGI("[OTA Task] Started in dedicated FreeRTOS task");
+    LOGD("[OTA Task] Free heap: %lu bytes", (unsigned long)ESP.getFreeHeap());
+    LOGD("[OTA Task] Stack high water mark: %u bytes", (unsigned)uxTaskGetStackHighWaterMark(NULL));
     
     // Verify WiFi is connected
     if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("[OTA Task] ERROR: WiFi not connected!");
+        LOGE("[OTA Task] ERROR: WiFi not connected!");
         *(params->result) = false;
         xSemaphoreGive(params->done);
         vTaskDelete(NULL);
@@ -144,29 +147,29 @@ void OtaManager::otaTask(void* pvParameters) {
         unsigned long now = millis();
         
         if (now - lastUpdate >= 2000 || progress == total) {
-            Serial.printf("[OTA Task] Progress: %d/%d bytes (%.1f%%)\r\n", 
-                         progress, total, (progress * 100.0) / total);
+            LOGD("[OTA Task] Progress: %d/%d bytes (%.1f%%)",
+                 progress, total, (progress * 100.0) / total);
             // Log memory status periodically
-            Serial.printf("[OTA Task] Free heap: %d, Stack HWM: %d\r\n",
-                         ESP.getFreeHeap(), uxTaskGetStackHighWaterMark(NULL));
+            LOGD("[OTA Task] Free heap: %lu, Stack HWM: %u",
+                 (unsigned long)ESP.getFreeHeap(), (unsigned)uxTaskGetStackHighWaterMark(NULL));
             lastUpdate = now;
         }
     });
 
     // Error callback
     httpUpdate.onError([](int error) {
-        Serial.printf("[OTA Task] HTTPUpdate error: %d - %s\r\n", 
-                     error, httpUpdate.getLastErrorString().c_str());
+        LOGE("[OTA Task] HTTPUpdate error: %d - %s",
+             error, httpUpdate.getLastErrorString().c_str());
     });
 
     // Start callback
     httpUpdate.onStart([]() {
-        Serial.println("[OTA Task] HTTPUpdate started");
+        LOGD("[OTA Task] HTTPUpdate started");
     });
 
     // End callback
     httpUpdate.onEnd([]() {
-        Serial.println("[OTA Task] HTTPUpdate finished");
+        LOGD("[OTA Task] HTTPUpdate finished");
     });
 
     // Create HTTPClient
@@ -180,7 +183,7 @@ void OtaManager::otaTask(void* pvParameters) {
     if (params->url.startsWith("https://")) {
         secureClient = new WiFiClientSecure();
         if (!secureClient) {
-            Serial.println("[OTA Task] Failed to allocate WiFiClientSecure");
+            LOGE("[OTA Task] Failed to allocate WiFiClientSecure");
             *(params->result) = false;
             xSemaphoreGive(params->done);
             vTaskDelete(NULL);
@@ -190,16 +193,16 @@ void OtaManager::otaTask(void* pvParameters) {
         // TEMPORARY: Try insecure mode to diagnose certificate issue
         // TODO: Fix certificate chain for GitHub redirects
         secureClient->setInsecure();
-        Serial.println("[OTA Task] WARNING: Using insecure mode (certificate validation disabled)");
-        Serial.println("[OTA Task] This is acceptable for GitHub downloads with signature verification");
+        LOGW("[OTA Task] WARNING: Using insecure mode (certificate validation disabled)");
+        LOGW("[OTA Task] This is acceptable for GitHub downloads with signature verification");
         
         // Enable client debug output
         secureClient->setHandshakeTimeout(30);
-        Serial.printf("[OTA Task] Attempting HTTPS connection to: %s\r\n", params->url.c_str());
+        LOGI("[OTA Task] Attempting HTTPS connection to: %s", params->url.c_str());
         
         if (!httpClient.begin(*secureClient, params->url)) {
-            Serial.println("[OTA Task] HTTPClient begin failed for HTTPS URL");
-            Serial.println("[OTA Task] This usually means URL parsing failed");
+            LOGE("[OTA Task] HTTPClient begin failed for HTTPS URL");
+            LOGE("[OTA Task] This usually means URL parsing failed");
             delete secureClient;
             *(params->result) = false;
             xSemaphoreGive(params->done);
@@ -207,11 +210,11 @@ void OtaManager::otaTask(void* pvParameters) {
             return;
         }
         
-        Serial.println("[OTA Task] HTTPClient begin succeeded");
+        LOGD("[OTA Task] HTTPClient begin succeeded");
     } else {
         regularClient = new WiFiClient();
         if (!regularClient) {
-            Serial.println("[OTA Task] Failed to allocate WiFiClient");
+            LOGE("[OTA Task] Failed to allocate WiFiClient");
             *(params->result) = false;
             xSemaphoreGive(params->done);
             vTaskDelete(NULL);
@@ -219,7 +222,7 @@ void OtaManager::otaTask(void* pvParameters) {
         }
         
         if (!httpClient.begin(*regularClient, params->url)) {
-            Serial.println("[OTA Task] HTTPClient begin failed for HTTP URL");
+            LOGE("[OTA Task] HTTPClient begin failed for HTTP URL");
             delete regularClient;
             *(params->result) = false;
             xSemaphoreGive(params->done);
@@ -233,27 +236,27 @@ void OtaManager::otaTask(void* pvParameters) {
     httpClient.setConnectTimeout(15000);    // 15 second connection timeout
     httpClient.setReuse(false);             // Don't reuse connection
     
-    Serial.println("[OTA Task] HTTPClient configured with timeouts");
-    Serial.printf("[OTA Task] Timeout: 30s, Connect timeout: 15s\r\n");
+    LOGD("[OTA Task] HTTPClient configured with timeouts");
+    LOGD("[OTA Task] Timeout: 30s, Connect timeout: 15s");
     
     // Test connection first
-    Serial.println("[OTA Task] Testing HEAD request to check connectivity...");
+    LOGD("[OTA Task] Testing HEAD request to check connectivity...");
     int httpCode = httpClient.sendRequest("HEAD");
-    Serial.printf("[OTA Task] HEAD request returned code: %d\r\n", httpCode);
+    LOGD("[OTA Task] HEAD request returned code: %d", httpCode);
     
     if (httpCode < 0) {
-        Serial.printf("[OTA Task] Connection test failed with error: %s\r\n", httpClient.errorToString(httpCode).c_str());
-        Serial.println("[OTA Task] Possible issues:");
-        Serial.println("[OTA Task]   - DNS resolution failed");
-        Serial.println("[OTA Task]   - TLS handshake failed");
-        Serial.println("[OTA Task]   - Network unreachable");
-        Serial.println("[OTA Task]   - Certificate validation failed");
+        LOGE("[OTA Task] Connection test failed with error: %s", httpClient.errorToString(httpCode).c_str());
+        LOGE("[OTA Task] Possible issues:");
+        LOGE("[OTA Task]   - DNS resolution failed");
+        LOGE("[OTA Task]   - TLS handshake failed");
+        LOGE("[OTA Task]   - Network unreachable");
+        LOGE("[OTA Task]   - Certificate validation failed");
     } else if (httpCode == 302 || httpCode == 301) {
-        Serial.printf("[OTA Task] Server returned redirect (%d)\r\n", httpCode);
+        LOGD("[OTA Task] Server returned redirect (%d)", httpCode);
         String location = httpClient.getLocation();
-        Serial.printf("[OTA Task] Redirect location: %s\r\n", location.c_str());
+        LOGD("[OTA Task] Redirect location: %s", location.c_str());
     } else {
-        Serial.printf("[OTA Task] Connection test successful (HTTP %d)\r\n", httpCode);
+        LOGD("[OTA Task] Connection test successful (HTTP %d)", httpCode);
     }
     
     // Close test connection
@@ -262,7 +265,7 @@ void OtaManager::otaTask(void* pvParameters) {
     // Re-initialize for actual update
     if (params->url.startsWith("https://")) {
         if (!httpClient.begin(*secureClient, params->url)) {
-            Serial.println("[OTA Task] Failed to reinitialize HTTPClient");
+            LOGE("[OTA Task] Failed to reinitialize HTTPClient");
             delete secureClient;
             *(params->result) = false;
             xSemaphoreGive(params->done);
@@ -271,7 +274,7 @@ void OtaManager::otaTask(void* pvParameters) {
         }
     } else {
         if (!httpClient.begin(*regularClient, params->url)) {
-            Serial.println("[OTA Task] Failed to reinitialize HTTPClient");
+            LOGE("[OTA Task] Failed to reinitialize HTTPClient");
             delete regularClient;
             *(params->result) = false;
             xSemaphoreGive(params->done);
@@ -289,20 +292,20 @@ void OtaManager::otaTask(void* pvParameters) {
     String md5sumCopy = params->md5sum;
     HTTPUpdateRequestCB requestCallback = [md5sumCopy](HTTPClient* client) {
         client->addHeader("x-MD5", md5sumCopy);
-        Serial.printf("[OTA Task] Added x-MD5 header: %s\r\n", md5sumCopy.c_str());
+        LOGD("[OTA Task] Added x-MD5 header: %s", md5sumCopy.c_str());
     };
 
     // Perform the update
-    Serial.println("[OTA Task] Starting firmware update...");
+    LOGI("[OTA Task] Starting firmware update...");
     HTTPUpdateResult result;
 
     try {
         result = httpUpdate.update(httpClient, params->version, requestCallback);
     } catch (const std::exception& e) {
-        Serial.printf("[OTA Task] Exception during update: %s\r\n", e.what());
+        LOGE("[OTA Task] Exception during update: %s", e.what());
         result = HTTP_UPDATE_FAILED;
     } catch (...) {
-        Serial.println("[OTA Task] Unknown exception during update");
+        LOGE("[OTA Task] Unknown exception during update");
         result = HTTP_UPDATE_FAILED;
     }
 
@@ -313,30 +316,33 @@ void OtaManager::otaTask(void* pvParameters) {
     // Check result
     switch (result) {
         case HTTP_UPDATE_OK:
-            Serial.println("[OTA Task] Firmware update completed successfully!");
+            LOGI("[OTA Task] Firmware update completed successfully!");
             success = true;
             break;
 
         case HTTP_UPDATE_NO_UPDATES:
-            Serial.println("[OTA Task] No updates available (same version)");
+            LOGI("[OTA Task] No updates available (same version)");
             success = false;
             break;
 
         case HTTP_UPDATE_FAILED:
         default:
-            Serial.printf("[OTA Task] Update failed. Error (%d): %s\r\n",
-                         httpUpdate.getLastError(),
-                         httpUpdate.getLastErrorString().c_str());
+            LOGE("[OTA Task] Update failed. Error (%d): %s",
+                 httpUpdate.getLastError(),
+                 httpUpdate.getLastErrorString().c_str());
             success = false;
             break;
     }
 
+    // Stack headroom of the download, before the caller resumes
+    memory_probe_sample("ota");
+    
     // Signal completion
     *(params->result) = success;
     xSemaphoreGive(params->done);
     
-    Serial.printf("[OTA Task] Task complete. Final stack HWM: %d bytes\r\n", 
-                 uxTaskGetStackHighWaterMark(NULL));
+    LOGD("[OTA Task] Task complete. Final stack HWM: %u bytes",
+         (unsigned)uxTaskGetStackHighWaterMark(NULL));
     
     // Task will self-delete
     vTaskDelete(NULL);
@@ -344,26 +350,26 @@ void OtaManager::otaTask(void* pvParameters) {
 
 // Main thread function - validates and spawns OTA task
 bool OtaManager::downloadAndInstall(const String& url, const String& md5sum, const String& version) {
-    Serial.println("[OTA] Starting firmware download and installation...");
-    Serial.printf("[OTA] URL: %s\r\n", url.c_str());
-    Serial.printf("[OTA] Expected MD5: %s\r\n", md5sum.c_str());
-    Serial.printf("[OTA] Version: %s\r\n", version.c_str());
+    LOGI("[OTA] Starting firmware download and installation...");
+    LOGI("[OTA] URL: %s", url.c_str());
+    LOGD("[OTA] Expected MD5: %s", md5sum.c_str());
+    LOGI("[OTA] Version: %s", version.c_str());
 
     // Check if WiFi is connected
     if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("[OTA] ERROR: WiFi not connected! OTA requires active WiFi connection.");
+        LOGE("[OTA] ERROR: WiFi not connected! OTA requires active WiFi connection.");
         return false;
     }
     
-    Serial.println("[OTA] WiFi connected - proceeding with OTA");
-    Serial.printf("[OTA] SSID: %s\r\n", WiFi.SSID().c_str());
-    Serial.printf("[OTA] IP Address: %s\r\n", WiFi.localIP().toString().c_str());
-    Serial.printf("[OTA] Free heap before task: %d bytes\r\n", ESP.getFreeHeap());
+    LOGI("[OTA] WiFi connected - proceeding with OTA");
+    LOGD("[OTA] SSID: %s", WiFi.SSID().c_str());
+    LOGD("[OTA] IP Address: %s", WiFi.localIP().toString().c_str());
+    LOGD("[OTA] Free heap before task: %lu bytes", (unsigned long)ESP.getFreeHeap());
 
     // Create synchronization objects
     SemaphoreHandle_t doneSemaphore = xSemaphoreCreateBinary();
     if (!doneSemaphore) {
-        Serial.println("[OTA] Failed to create semaphore");
+        LOGE("[OTA] Failed to create semaphore");
         return false;
     }
     
@@ -379,7 +385,7 @@ bool OtaManager::downloadAndInstall(const String& url, const String& md5sum, con
     };
     
     if (!params) {
-        Serial.println("[OTA] Failed to allocate task parameters");
+        LOGE("[OTA] Failed to allocate task parameters");
         vSemaphoreDelete(doneSemaphore);
         return false;
     }
@@ -387,7 +393,6 @@ bool OtaManager::downloadAndInstall(const String& url, const String& md5sum, con
     // Create OTA task with 32KB stack
     // Priority 1 (same as default loop task)
     // Core 1 (same as WiFi/network stack)
-    constexpr uint32_t OTA_TASK_STACK_SIZE = 32768;
     TaskHandle_t otaTaskHandle = NULL;
     
     BaseType_t taskCreated = xTaskCreatePinnedToCore(
@@ -401,23 +406,23 @@ bool OtaManager::downloadAndInstall(const String& url, const String& md5sum, con
     );
     
     if (taskCreated != pdPASS || otaTaskHandle == NULL) {
-        Serial.println("[OTA] Failed to create OTA task");
+        LOGE("[OTA] Failed to create OTA task");
         delete params;
         vSemaphoreDelete(doneSemaphore);
         return false;
     }
     
-    Serial.printf("[OTA] OTA task created with %d byte stack on core 1\r\n", OTA_TASK_STACK_SIZE);
+    LOGD("[OTA] OTA task created with %d byte stack on core 1", OTA_TASK_STACK_SIZE);
     
     // Wait for task to complete (blocks main thread)
     // Use a timeout to prevent infinite blocking
     constexpr TickType_t TIMEOUT_TICKS = pdMS_TO_TICKS(300000); // 5 minutes
     
-    Serial.println("[OTA] Waiting for OTA task to complete...");
+    LOGI("[OTA] Waiting for OTA task to complete...");
     if (xSemaphoreTake(doneSemaphore, TIMEOUT_TICKS) == pdTRUE) {
-        Serial.printf("[OTA] OTA task completed with result: %s\r\n", result ? "SUCCESS" : "FAILED");
+        LOGI("[OTA] OTA task completed with result: %s", result ? "SUCCESS" : "FAILED");
     } else {
-        Serial.println("[OTA] OTA task timeout - aborting");
+        LOGE("[OTA] OTA task timeout - aborting");
         // Force delete the task if it's still running
         if (eTaskGetState(otaTaskHandle) != eDeleted) {
             vTaskDelete(otaTaskHandle);
@@ -429,21 +434,21 @@ bool OtaManager::downloadAndInstall(const String& url, const String& md5sum, con
     delete params;
     vSemaphoreDelete(doneSemaphore);
     
-    Serial.printf("[OTA] Free heap after OTA: %d bytes\r\n", ESP.getFreeHeap());
+    LOGD("[OTA] Free heap after OTA: %lu bytes", (unsigned long)ESP.getFreeHeap());
     
     return result;
 }
 
 bool OtaManager::processUpdate(const String& jsonPayload) {
-    Serial.println("[OTA] Processing OTA update message...");
-    Serial.printf("[OTA] Payload: %s\r\n", jsonPayload.c_str());
+    LOGI("[OTA] Processing OTA update message...");
+    LOGV("[OTA] Payload: %s", jsonPayload.c_str());
 
     // Parse JSON
     StaticJsonDocument<512> doc;
     DeserializationError error = deserializeJson(doc, jsonPayload);
 
     if (error) {
-        Serial.printf("[OTA] JSON parse error: %s\r\n", error.c_str());
+        LOGE("[OTA] JSON parse error: %s", error.c_str());
         return false;
     }
 
@@ -455,7 +460,7 @@ bool OtaManager::processUpdate(const String& jsonPayload) {
     } else if (doc["u"]) {
         url = doc["u"].as<String>();
     } else {
-        Serial.println("[OTA] Missing 'url' field");
+        LOGE("[OTA] Missing 'url' field");
         return false;
     }
 
@@ -464,7 +469,7 @@ bool OtaManager::processUpdate(const String& jsonPayload) {
     } else if (doc["v"]) {
         version = doc["v"].as<String>();
     } else {
-        Serial.println("[OTA] Missing 'version' field");
+        LOGE("[OTA] Missing 'version' field");
         return false;
     }
 
@@ -473,7 +478,7 @@ bool OtaManager::processUpdate(const String& jsonPayload) {
     } else if (doc["m"]) {
         md5sum = doc["m"].as<String>();
     } else {
-        Serial.println("[OTA] Missing 'md5sum' field");
+        LOGE("[OTA] Missing 'md5sum' field");
         return false;
     }
 
@@ -482,24 +487,24 @@ bool OtaManager::processUpdate(const String& jsonPayload) {
     } else if (doc["s"]) {
         signature = doc["s"].as<String>();
     } else {
-        Serial.println("[OTA] Missing 'signature' field");
+        LOGE("[OTA] Missing 'signature' field");
         return false;
     }
 
-    Serial.printf("[OTA] Extracted - URL: %s, Version: %s\r\n", url.c_str(), version.c_str());
+    LOGI("[OTA] Extracted - URL: %s, Version: %s", url.c_str(), version.c_str());
 
     // Verify signature
     if (!verifySignature(url, md5sum, signature)) {
-        Serial.println("[OTA] Signature verification failed - aborting update");
+        LOGE("[OTA] Signature verification failed - aborting update");
         return false;
     }
 
     // Download and install firmware
     if (!downloadAndInstall(url, md5sum, version)) {
-        Serial.println("[OTA] Firmware installation failed");
+        LOGE("[OTA] Firmware installation failed");
         return false;
     }
 
-    Serial.println("[OTA] OTA update completed successfully!");
+    LOGI("[OTA] OTA update completed successfully!");
     return true;
 }
@@ -0,0 +1,166 @@
+#include "PayloadIngest.h"
+#include "DashboardParser.h"
+#include "Log.h"
+#include "PhaseTrace.h"
+#include "MemoryProbe.h"
+
+/**
+ * Constructor
+ */
+PayloadIngest::PayloadIngest(DashboardModel& model)
+    : model(model),
+      nodeName(""),
+      buffer(nullptr),
+      done(nullptr),
+      task(nullptr),
+      ended(false),
+      parsed(false),
+      aborted(false),
+      result(false),
+      peeked(-1),
+      received(0)
+{
+}
+
+/**
+ * Allocate the stream buffer
+ */
+bool PayloadIngest::begin(const char* nodeName)
+{
+    this->nodeName = nodeName;
+    buffer = xStreamBufferCreate(PAYLOAD_STREAM_BUFFER, 1);
+    done = xSemaphoreCreateBinary();
+    if (buffer == nullptr || done == nullptr) {
+        LOGE("Failed to allocate payload stream buffer");
+        return false;
+    }
+    
+    // read() does the waiting, no extra polling in Stream::timedRead()
+    setTimeout(0);
+    return true;
+}
+
+/**
+ * Write one payload byte
+ */
+size_t PayloadIngest::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+/**
+ * Write payload bytes, starting the parser task on the first one
+ */
+size_t PayloadIngest::write(const uint8_t* data, size_t length)
+{
+    if (buffer == nullptr || parsed || ended) {
+        return length;  // Nothing left to feed, drop trailing bytes
+    }
+    
+    if (task == nullptr) {
+        if (xTaskCreate(parserTask, "parser", PARSER_TASK_STACK_SIZE, this, 1, &task) != pdPASS) {
+            LOGE("Failed to start parser task");
+            parsed = true;
+            return length;
+        }
+    }
+    
+    // Blocks while the parser catches up
+    size_t sent = xStreamBufferSend(buffer, data, length, pdMS_TO_TICKS(PAYLOAD_STREAM_TIMEOUT));
+    received += sent;
+    return sent;
+}
+
+/**
+ * Bytes ready for the parser
+ */
+int PayloadIngest::available()
+{
+    return (peeked >= 0 ? 1 : 0) + (buffer ? xStreamBufferBytesAvailable(buffer) : 0);
+}
+
+/**
+ * Read one byte, waiting for it to arrive
+ * Returns -1 at the end of the payload, after PAYLOAD_STREAM_TIMEOUT or
+ * once the parse is aborted.
+ */
+int PayloadIngest::read()
+{
+    if (aborted) {
+        return -1;
+    }
+    if (peeked >= 0) {
+        int c = peeked;
+        peeked = -1;
+        return c;
+    }
+    
+    uint8_t c;
+    unsigned long startTime = millis();
+    do {
+        bool last = ended;
+        if (xStreamBufferReceive(buffer, &c, 1, last ? 0 : pdMS_TO_TICKS(10)) == 1) {
+            return c;
+        }
+        if (last || aborted) {
+            return -1;
+        }
+    } while (millis() - startTime < PAYLOAD_STREAM_TIMEOUT);
+    
+    return -1;
+}
+
+/**
+ * Next byte without consuming it
+ */
+int PayloadIngest::peek()
+{
+    if (peeked < 0) {
+        peeked = read();
+    }
+    return peeked;
+}
+
+/**
+ * End of payload: wait for the parser task
+ */
+bool PayloadIngest::finish(unsigned long timeoutMs)
+{
+    // The MQTT client keeps this stream; later messages are dropped
+    ended = true;
+    if (task == nullptr) {
+        return false;  // No payload received
+    }
+    
+    if (xSemaphoreTake(done, pdMS_TO_TICKS(timeoutMs)) != pdTRUE) {
+        // The parser still writes the model: cut its input short and let it
+        // return before the caller touches the model again
+        LOGW("Payload parser timed out, aborting");
+        aborted = true;
+        xSemaphoreTake(done, portMAX_DELAY);
+        return false;
+    }
+    
+    LOGD("Payload streamed: %lu bytes through a %d byte buffer",
+         (unsigned long)received, PAYLOAD_STREAM_BUFFER);
+    return result;
+}
+
+/**
+ * Parser task: consume the stream into the model, then exit
+ */
+void PayloadIngest::parserTask(void* param)
+{
+    PayloadIngest* self = static_cast<PayloadIngest*>(param);
+    
+    {
+        TRACE_SCOPE(TRACE_PARSE);
+        self->result = dashboard_parse_payload(*self, self->nodeName, self->model);
+    }
+    self->parsed = true;
+    
+    LOGD("Parser task stack free (min): %u bytes", (unsigned)uxTaskGetStackHighWaterMark(NULL));
+    memory_probe_sample("parse");
+    xSemaphoreGive(self->done);
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,134 @@
+#include "PhaseTrace.h"
+
+#if PHASE_TRACE
+
+#include <freertos/FreeRTOS.h>
+#include <cstring>
+#include "Config.h"
+
+namespace {
+    const uint32_t TRACE_MAGIC = 0x54524331;  // "TRC1"
+    
+    struct TraceRecord {
+        uint32_t startUs;
+        uint32_t durationUs;
+        uint8_t phase;
+    };
+    
+    struct TraceLog {
+        uint32_t magic;
+        uint32_t wake;
+        uint16_t count;
+        uint16_t dropped;
+        TraceRecord records[TRACE_MAX_RECORDS];
+    };
+    
+    // Current wake (kept through deep sleep) and the previous one
+    RTC_DATA_ATTR TraceLog current;
+    TraceLog previous;
+    bool hasPrevious = false;
+    
+    // Start of phases opened with trace_begin(), 0 = not open
+    int64_t openStart[TRACE_PHASE_COUNT];
+    
+    // Records come from several tasks (network, jobs, parser, display)
+    portMUX_TYPE traceLock = portMUX_INITIALIZER_UNLOCKED;
+    
+    const char* const PHASE_NAMES[TRACE_PHASE_COUNT] = {
+        "settings", "battery", "wifi", "dhcp", "mqtt", "retained",
+        "parse", "render", "draw", "panel", "sleep"
+    };
+}
+
+/**
+ * Start this wake's trace
+ */
+void trace_init()
+{
+    hasPrevious = current.magic == TRACE_MAGIC && current.count <= TRACE_MAX_RECORDS;
+    if (hasPrevious) {
+        memcpy(&previous, &current, sizeof(previous));
+    }
+    
+    uint32_t wake = hasPrevious ? previous.wake + 1 : 0;
+    memset(&current, 0, sizeof(current));
+    current.magic = TRACE_MAGIC;
+    current.wake = wake;
+    memset(openStart, 0, sizeof(openStart));
+}
+
+/**
+ * Open a phase
+ */
+void trace_begin(TracePhase phase)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&traceLock);
+    openStart[phase] = now > 0 ? now : 1;
+    portEXIT_CRITICAL(&traceLock);
+}
+
+/**
+ * Close a phase
+ */
+void trace_end(TracePhase phase)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&traceLock);
+    int64_t start = openStart[phase];
+    openStart[phase] = 0;
+    portEXIT_CRITICAL(&traceLock);
+    
+    if (start != 0) {
+        trace_record(phase, start, now);
+    }
+}
+
+/**
+ * Record a finished phase
+ */
+void trace_record(TracePhase phase, int64_t startUs, int64_t endUs)
+{
+    portENTER_CRITICAL(&traceLock);
+    if (current.magic == TRACE_MAGIC && current.count < TRACE_MAX_RECORDS) {
+        TraceRecord& record = current.records[current.count++];
+        record.startUs = (uint32_t)startUs;
+        record.durationUs = (uint32_t)(endUs - startUs);
+        record.phase = phase;
+    } else {
+        current.dropped++;
+    }
+    portEXIT_CRITICAL(&traceLock);
+}
+
+/**
+ * Trace of the previous wake as compact JSON
+ */
+bool trace_previous_json(String& out)
+{
+    if (!hasPrevious) {
+        return false;
+    }
+    
+    out = "{\"wake\":" + String(previous.wake) + ",\"dropped\":" + String(previous.dropped) + ",\"phases\":[";
+    for (int i = 0; i < previous.count; i++) {
+        const TraceRecord& record = previous.records[i];
+        char entry[48];
+        snprintf(entry, sizeof(entry), "%s[\"%s\",%lu,%lu]", i > 0 ? "," : "",
+                 trace_phase_name((TracePhase)record.phase),
+                 (unsigned long)record.startUs, (unsigned long)record.durationUs);
+        out += entry;
+    }
+    out += "]}";
+    return true;
+}
+
+/**
+ * Phase name used in the published record
+ */
+const char* trace_phase_name(TracePhase phase)
+{
+    return phase < TRACE_PHASE_COUNT ? PHASE_NAMES[phase] : "?";
+}
+
+#endif // PHASE_TRACE
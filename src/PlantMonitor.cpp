@@ -1,46 +1,130 @@
 #include "PlantMonitor.h"
-#include "DisplayUtils.h"
-#include "fonts.h"
+#include "DashboardRenderer.h"
+#include "Log.h"
+#include "PhaseTrace.h"
 #include <SPI.h>
-#include <qrcode.h>
+
+namespace {
+    const uint32_t FRAME_STATE_MAGIC = 0x46524d31;  // "FRM1"
+    const uint8_t FRAME_STATE_VERSION = 4;
+    
+    typedef PanelTraits<PanelDisplay> Panel;
+    
+    const int SCREEN_W = Panel::WIDTH;
+    const int SCREEN_H = Panel::HEIGHT;
+    
+    const RefreshPolicy::PanelCaps PANEL_CAPS = {
+        Panel::PARTIAL,
+        Panel::MONO,
+        Panel::PLANES > 1,
+        Panel::FULL_MS,
+        Panel::PARTIAL_MS
+    };
+    const char* FRAME_STATE_KEY = "frame_state";
+    
+    /**
+     * FNV-1a hash used to fingerprint widget content
+     */
+    uint32_t fnv1a(const void* data, size_t length, uint32_t hash = 2166136261u)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; i++) {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+    
+    /**
+     * Bytes sent over SPI for a window: the controller works on 8-pixel
+     * aligned columns, one bit plane per panel color
+     */
+    uint32_t windowBytes(int x, int w, int h)
+    {
+        int x0 = x & ~7;
+        int x1 = (x + w + 7) & ~7;
+        return (uint32_t)(x1 - x0) / 8 * h * Panel::PLANES;
+    }
+}
+
+RTC_DATA_ATTR RtcRecord<PlantMonitor::FrameState> PlantMonitor::frameRecord;
 
 /**
  * Constructor
  */
 PlantMonitor::PlantMonitor() 
-    : display(GxEPD2_420c_GDEY042Z98(EPD_CS, EPD_DC, EPD_RST, EPD_BUSY)),
-      plantCount(0),
+    : display(Panel::DriverType(EPD_CS, EPD_DC, EPD_RST, EPD_BUSY)),
+      model(),
       batteryPercent(0),
-      headerHeight(0),
-      gaugeW(0),
-      gaugeH(0)
+      layout(),
+      frameState(),
+      refreshPolicy(PANEL_CAPS),
+      refreshStats{"skip", 0, 0},
+      prerenderedHeader(0)
 {
     // Display initialization moved to init() method
 }
 
 /**
  * Initialize display hardware
- * Call this after WiFi/network operations are complete
+ * Can run while the network task connects
  */
 void PlantMonitor::init()
 {
-    Serial.println("Initializing display...");
+    LOGD("Initializing display...");
     SPI.begin();
-    display.init(115200, true, 10, false);
+    
+    // Panel content is known when fingerprints survived deep sleep, which
+    // lets the driver do partial refreshes without a forced initial full one
+    loadFrameState();
+    display.init(115200, !frameState.panelKnown, 10, false);
     display.setRotation(0);
-    Serial.println("Display initialized");
+    LOGD("Display initialized");
 }
 
 /**
- * Main entry point - updates display from JSON data and battery level
+ * Main entry point - updates display from the dashboard model and battery level
  */
-void PlantMonitor::updateDisplay(const JsonDocument& jsonDoc, int batteryPercent)
+void PlantMonitor::updateDisplay(const DashboardModel& model, int batteryPercent)
 {
+    this->model = model;
     this->batteryPercent = batteryPercent;
-    parseJsonData(jsonDoc);
     render();
 }
 
+/**
+ * Set the content expected for this wake
+ */
+void PlantMonitor::expect(const DashboardModel& model)
+{
+    this->model = model;
+}
+
+/**
+ * Speculatively draw the header of the expected content
+ */
+void PlantMonitor::prerender(int batteryPercent)
+{
+    if (display.pages() != 1) {
+        return;
+    }
+    
+    this->batteryPercent = batteryPercent;
+    computeLayout();
+    
+    FrameState guess;
+    computeFingerprints(guess);
+    
+    DashboardRenderer<PanelDisplay> renderer(display);
+    display.setFullWindow();
+    display.fillScreen(GxEPD_WHITE);
+    renderer.drawHeader(model.updateDate, batteryPercent, layout.page, layout.pageCount);
+    prerenderedHeader = guess.header;
+    
+    LOGD("Header pre-rendered (%s, page %d/%d)",
+         model.updateDate, layout.page + 1, layout.pageCount);
+}
+
 /**
  * Put display into deep sleep mode
  */
@@ -62,264 +146,279 @@ void PlantMonitor::wake()
  */
 void PlantMonitor::showUpgradeScreen()
 {
-    Serial.println("Displaying firmware upgrade screen...");
+    LOGI("Displaying firmware upgrade screen...");
     
+    invalidateFrameState();
+    DashboardRenderer<PanelDisplay> renderer(display);
     display.setFullWindow();
     display.firstPage();
     
     do {
-        display.fillScreen(GxEPD_WHITE);
-        display.setTextColor(GxEPD_BLACK);
-        display.setFont(&DejaVu_Sans_Bold_11);
-        display.setTextSize(2);
-        
-        int16_t tbx, tby;
-        uint16_t tbw, tbh;
-        
-        // "Firmware Upgrade" text
-        const char* msg1 = "Firmware Upgrade";
-        display.getTextBounds(msg1, 0, 0, &tbx, &tby, &tbw, &tbh);
-        int x = (SCREEN_W - tbw) / 2;
-        int y = (SCREEN_H / 2) - 20;
-        display.setCursor(x, y);
-        display.print(msg1);
-        
-        // "In Progress..." text
-        const char* msg2 = "In Progress...";
-        display.getTextBounds(msg2, 0, 0, &tbx, &tby, &tbw, &tbh);
-        x = (SCREEN_W - tbw) / 2;
-        y += tbh + 20;
-        display.setCursor(x, y);
-        display.print(msg2);
-        
+        renderer.drawUpgradeScreen();
     } while (display.nextPage());
     
-    Serial.println("Firmware upgrade screen displayed");
+    LOGD("Firmware upgrade screen displayed");
 }
 
 /**
- * Parse JSON data and populate internal plant array
+ * Render the complete display
+ * Only widgets whose fingerprint changed since the last wake are refreshed
  */
-void PlantMonitor::parseJsonData(const JsonDocument& jsonDoc)
+void PlantMonitor::render()
 {
-    // Extract update date
-    updateDate = jsonDoc["updateDate"].as<String>();
+    TRACE_SCOPE(TRACE_RENDER);
+    computeLayout();
+    
+    FrameState next;
+    computeFingerprints(next);
+    
+    // Bounding box of all changed widgets. A refresh costs a full waveform
+    // pass on most panels, so one partial window beats several small ones.
+    int dirtyX0 = SCREEN_W, dirtyY0 = SCREEN_H, dirtyX1 = 0, dirtyY1 = 0;
+    auto markDirty = [&](const DashboardLayout::Rect& r) {
+        dirtyX0 = min(dirtyX0, r.x);
+        dirtyY0 = min(dirtyY0, r.y);
+        dirtyX1 = max(dirtyX1, r.x + r.w);
+        dirtyY1 = max(dirtyY1, r.y + r.h);
+    };
+    
+    if (next.header != frameState.header) {
+        markDirty({0, 0, SCREEN_W, layout.originY});
+    }
+    for (int i = 0; i < MAX_PAGE_CELLS; i++) {
+        if (next.cells[i] != frameState.cells[i]) {
+            // Cells outside the current grid belonged to a previous layout
+            if (i < layout.capacity()) {
+                markDirty(layout.cell(i));
+            } else {
+                markDirty({0, layout.originY, SCREEN_W, SCREEN_H - layout.originY});
+            }
+        }
+    }
     
-    // Extract plant data
-    JsonArrayConst plantsArray = jsonDoc["plants"].as<JsonArrayConst>();
-    plantCount = min((int)plantsArray.size(), 6);  // Max 6 plants
+    RefreshPolicy::Frame frame;
+    frame.panelKnown = frameState.panelKnown;
+    frame.changed = dirtyX1 > dirtyX0;
+    frame.dirtyArea = frame.changed ? (dirtyX1 - dirtyX0) * (dirtyY1 - dirtyY0) : 0;
+    frame.screenArea = SCREEN_W * SCREEN_H;
+    frame.hasRed = frameHasRed();
+    
+    RefreshPolicy::Decision decision = refreshPolicy.decide(frame, frameState.history);
+    refreshStats.mode = RefreshPolicy::modeName(decision.mode);
+    refreshStats.spiBytes = 0;
+    
+    unsigned long startTime = millis();
+    
+    // Window sent to the panel
+    int winX = 0, winY = 0, winW = SCREEN_W, winH = SCREEN_H;
+    if (decision.mode == REFRESH_PARTIAL) {
+        winX = dirtyX0;
+        winY = dirtyY0;
+        winW = dirtyX1 - dirtyX0;
+        winH = dirtyY1 - dirtyY0;
+    }
+    bool headerReused = false;
     
-    for (int i = 0; i < plantCount; i++) {
-        plants[i].name = plantsArray[i]["name"].as<String>();
-        plants[i].moisture = plantsArray[i]["moisture"].as<int>();
+    if (decision.mode != REFRESH_SKIP) {
+        refreshStats.spiBytes = windowBytes(winX, winW, winH);
         
-        Serial.printf("Plant %d: %s = %d%%\r\n", i + 1, plants[i].name.c_str(), plants[i].moisture);
+        if (display.pages() == 1) {
+            // Whole frame in RAM: draw once (header possibly pre-rendered),
+            // then send the window out of the buffer
+            {
+                TRACE_SCOPE(TRACE_DRAW);
+                headerReused = drawBuffered(next.header);
+            }
+            TRACE_SCOPE(TRACE_PANEL);
+            if (decision.mode == REFRESH_PARTIAL) {
+                display.displayWindow(winX, winY, winW, winH);
+            } else {
+                // Mono: full screen with the fast waveform
+                display.display(decision.mode == REFRESH_MONO);
+            }
+        } else {
+            if (decision.mode == REFRESH_PARTIAL || decision.mode == REFRESH_MONO) {
+                display.setPartialWindow(winX, winY, winW, winH);
+            } else {
+                display.setFullWindow();
+            }
+            // Drawing is clipped to the active window by the driver; pages
+            // are drawn and transferred in turn, traced as one panel phase
+            TRACE_SCOPE(TRACE_PANEL);
+            display.firstPage();
+            do {
+                drawFrame();
+            } while (display.nextPage());
+        }
     }
-    
-    Serial.printf("Total plants: %d\r\n", plantCount);
+    prerenderedHeader = 0;
+    
+    refreshStats.refreshMs = millis() - startTime;
+    LOGI("[Refresh] %s (%s): estimated %lu ms, took %lu ms, %lu bytes%s",
+         refreshStats.mode, decision.reason, (unsigned long)decision.estimatedMs,
+         (unsigned long)refreshStats.refreshMs, (unsigned long)refreshStats.spiBytes,
+         headerReused ? ", header pre-rendered" : "");
+    
+    next.panelKnown = 1;
+    next.page = (layout.page + 1) % layout.pageCount;
+    next.history = frameState.history;
+    refreshPolicy.record(next.history, decision, refreshStats.refreshMs, frame.hasRed);
+    frameState = next;
+    saveFrameState();
 }
 
 /**
- * Render the complete display
+ * Draw header and all widgets of the page
  */
-void PlantMonitor::render()
+void PlantMonitor::drawFrame()
 {
-    // Render content in single pass (fillScreen clears old content)
-    display.setFullWindow();
-    display.firstPage();
+    DashboardRenderer<PanelDisplay> renderer(display);
     
-    do {
-        display.fillScreen(GxEPD_WHITE);
-        
-        // Draw header and get its height
-        headerHeight = drawHeader();
-        
-        // Calculate remaining screen space
-        int remainingHeight = SCREEN_H - headerHeight;
-        
-        // Calculate gauge dimensions (3 columns, 2 rows)
-        gaugeW = SCREEN_W / GAUGE_COLS;
-        gaugeH = remainingHeight / GAUGE_ROWS;
-        
-        Serial.printf("Header height: %d, Remaining: %d, Gauge size: %dx%d\r\n", 
-                      headerHeight, remainingHeight, gaugeW, gaugeH);
-        
-        // Draw only actual plants (not empty slots)
-        for (int idx = 0; idx < plantCount; idx++) {
-            int row = idx / GAUGE_COLS;
-            int col = idx % GAUGE_COLS;
-            int x = col * gaugeW;
-            int y = headerHeight + (row * gaugeH);
-            
-            drawGauge(x, y, gaugeW, gaugeH, plants[idx].name.c_str(), plants[idx].moisture);
+    display.fillScreen(GxEPD_WHITE);
+    renderer.drawHeader(model.updateDate, batteryPercent, layout.page, layout.pageCount);
+    drawWidgets();
+}
+
+/**
+ * Draw the widgets of the page
+ */
+void PlantMonitor::drawWidgets()
+{
+    DashboardRenderer<PanelDisplay> renderer(display);
+    
+    // Draw only actual plants (not empty slots)
+    for (int slot = 0; slot < layout.count; slot++) {
+        const DashboardModel::Plant& plant = model.plants[layout.first + slot];
+        DashboardLayout::Rect r = layout.cell(slot);
+        if (layout.compact) {
+            renderer.drawBar(r.x, r.y, r.w, r.h, plant.name, plant.moisture);
+        } else {
+            renderer.drawGauge(r.x, r.y, r.w, r.h, plant.name, plant.moisture);
         }
-        
-    } while (display.nextPage());
+    }
 }
 
 /**
- * Draw header with title, update date, and battery
+ * Draw the frame into the full frame buffer
  */
-int PlantMonitor::drawHeader()
+bool PlantMonitor::drawBuffered(uint32_t header)
 {
-    display.setFont(&DejaVu_Sans_Bold_11);
-    display.setTextColor(GxEPD_BLACK);
-    
-    int16_t tbx, tby;
-    uint16_t tbw, tbh;
-    int currentY = 0;
-    
-    // Title - use larger text size
-    display.setTextSize(2);
-    display.getTextBounds("PLANT MOISTURE", 0, 0, &tbx, &tby, &tbw, &tbh);
-    currentY = tbh + 4;  // Add small padding
-    display.setCursor(SCREEN_W / 2 - tbw / 2, currentY);
-    display.print("PLANT MOISTURE");
+    display.setFullWindow();
     
-    // Date and Battery line - normal font size
-    currentY += 4;  // Small gap
-    display.setTextSize(1);
+    if (prerenderedHeader != 0 && prerenderedHeader == header) {
+        // Speculation held: only the widget area is left to draw
+        display.fillRect(0, layout.originY, SCREEN_W, SCREEN_H - layout.originY, GxEPD_WHITE);
+        drawWidgets();
+        return true;
+    }
     
-    // Draw "Updated:" and date
-    String updateLine = "Updated: " + updateDate + " Battery: ";
-    display.getTextBounds(updateLine.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
-    currentY += tbh;
+    drawFrame();
+    return false;
+}
+
+/**
+ * Compute the layout of the current frame
+ */
+void PlantMonitor::computeLayout()
+{
+    DashboardRenderer<PanelDisplay> renderer(display);
+    int headerHeight = renderer.measureHeader(model.updateDate);
+    
+    layout = DashboardLayout::compute(model.plantCount, SCREEN_W, SCREEN_H, headerHeight, frameState.page);
+    if (layout.pageCount > 1) {
+        // The title gains the page number once paginated, measure it again
+        headerHeight = renderer.measureHeader(model.updateDate, layout.page, layout.pageCount);
+        layout = DashboardLayout::compute(model.plantCount, SCREEN_W, SCREEN_H, headerHeight, frameState.page);
+    }
     
-    // Calculate full line width including battery icon and version
-    String batteryStr = String(batteryPercent) + "%";
+    LOGD("Layout: %dx%d %s of %dx%d, page %d/%d (plants %d-%d of %d)",
+         layout.cols, layout.rows, layout.compact ? "bars" : "gauges",
+         layout.cellW, layout.cellH, layout.page + 1, layout.pageCount,
+         layout.first + 1, layout.first + layout.count, model.plantCount);
+}
+
+/**
+ * Compute content fingerprints for the header and every widget cell
+ */
+void PlantMonitor::computeFingerprints(FrameState& state)
+{
+    memset(&state, 0, sizeof(state));
+    state.version = FRAME_STATE_VERSION;
+    state.plantCount = model.plantCount;
     
-    // Format version as vX.X.X from FIRMWARE_VERSION (e.g., 101 -> v1.0.1)
     int version = FIRMWARE_VERSION;
-    int major = version / 100;
-    int minor = (version / 10) % 10;
-    int patch = version % 10;
-    String versionStr = " v" + String(major) + "." + String(minor) + "." + String(patch);
-    
-    int16_t btbx, btby;
-    uint16_t btbw, btbh;
-    display.getTextBounds(batteryStr.c_str(), 0, 0, &btbx, &btby, &btbw, &btbh);
-    uint16_t versionW, versionH;
-    display.getTextBounds(versionStr.c_str(), 0, 0, &btbx, &btby, &versionW, &versionH);
-    
-    int batteryIconWidth = 20;  // Icon width
-    int totalWidth = tbw + batteryIconWidth + 4 + btbw + versionW;  // Text + icon + gap + percentage + version
-    
-    int startX = SCREEN_W / 2 - totalWidth / 2;
-    display.setCursor(startX, currentY);
-    display.print(updateLine);
-    
-    // Draw battery icon
-    int iconX = startX + tbw;
-    drawBatteryIcon(display, iconX, currentY - tbh + 2, batteryPercent);
-    
-    // Draw battery percentage
-    uint16_t batteryColor = (batteryPercent < BATTERY_LOW_THRESHOLD) ? GxEPD_RED : GxEPD_BLACK;
-    display.setTextColor(batteryColor);
-    display.setCursor(iconX + batteryIconWidth + 4, currentY);
-    display.print(batteryStr);
-    display.setTextColor(GxEPD_BLACK);  // Reset color
-    
-    // Draw version
-    display.setCursor(iconX + batteryIconWidth + 4 + btbw, currentY);
-    display.print(versionStr);
-    
-    // Separator line - thicker (3 pixels)
-    currentY += 4;  // Small gap before line
-    display.drawLine(10, currentY, SCREEN_W - 10, currentY, GxEPD_BLACK);
-    display.drawLine(10, currentY + 1, SCREEN_W - 10, currentY + 1, GxEPD_BLACK);
-    display.drawLine(10, currentY + 2, SCREEN_W - 10, currentY + 2, GxEPD_BLACK);
-    currentY += 3;  // Account for line thickness
-    
-    return currentY;  // Return total header height
+    uint32_t hash = fnv1a(model.updateDate, strlen(model.updateDate));
+    hash = fnv1a(&batteryPercent, sizeof(batteryPercent), hash);
+    hash = fnv1a(&version, sizeof(version), hash);
+    hash = fnv1a(&layout.page, sizeof(layout.page), hash);
+    hash = fnv1a(&layout.pageCount, sizeof(layout.pageCount), hash);
+    state.header = hash;
+    
+    for (int slot = 0; slot < layout.count; slot++) {
+        const DashboardModel::Plant& plant = model.plants[layout.first + slot];
+        DashboardLayout::Rect r = layout.cell(slot);
+        hash = fnv1a(plant.name, strlen(plant.name));
+        hash = fnv1a(&plant.moisture, sizeof(plant.moisture), hash);
+        hash = fnv1a(&r, sizeof(r), hash);  // Position and size
+        hash = fnv1a(&layout.compact, sizeof(layout.compact), hash);
+        state.cells[slot] = hash | 1;  // 0 is reserved for empty cells
+    }
 }
 
 /**
- * Draw a single plant moisture gauge
+ * Whether the frame uses red (critical plants or low battery)
  */
-void PlantMonitor::drawGauge(int x, int y, int w, int h, const char* name, int moisture)
+bool PlantMonitor::frameHasRed() const
 {
-    const int centerX = x + w / 2;
-    
-    // Calculate gauge radius based on available height
-    // Reserve space: 10% top padding, 30% for percentage+LOW, 20% for name, 40% for gauge
-    int topPadding = h * 0.10;
-    int gaugeSpace = h * 0.40;
-    
-    const int radius = min(gaugeSpace, w / 2 - 10);  // Fit within width too
-    const int centerY = y + topPadding + radius;     // Position gauge
-    
-    // Determine color based on moisture level
-    uint16_t valueColor = (moisture < MOISTURE_LOW_THRESHOLD) ? GxEPD_RED : GxEPD_BLACK;
-    
-    int16_t tbx, tby;
-    uint16_t tbw, tbh;
-    
-    // Draw gauge background arc (180 degrees) - thick and smooth
-    int arcThickness = max(6, radius / 8);  // Scale thickness with radius
-    for (int r = radius - arcThickness; r <= radius; r++) {
-        drawSmoothArc(display, centerX, centerY, r, 180, 360, GxEPD_BLACK);
+    if (batteryPercent < BATTERY_LOW_THRESHOLD) {
+        return true;
     }
-    
-    // Draw moisture level arc - very thick and smooth
-    if (moisture > 0) {
-        int endAngle = 180 + (moisture * 180 / 100);
-        int valueThickness = max(8, radius / 6);
-        for (int r = radius - arcThickness - valueThickness; r <= radius - arcThickness - 1; r++) {
-            drawSmoothArc(display, centerX, centerY, r, 180, endAngle, valueColor);
+    for (int slot = 0; slot < layout.count; slot++) {
+        if (model.plants[layout.first + slot].moisture < MOISTURE_LOW_THRESHOLD) {
+            return true;
         }
     }
-    
-    // NO TICK MARKS - cleaner look!
-    
-    // Draw percentage value below gauge
-    int percentY = centerY + 5;  // Just below the gauge
-    display.setFont(&DejaVu_Sans_Bold_11);
-    display.setTextSize(2);
-    display.setTextColor(valueColor);
-    
-    String percentStr = String(moisture) + "%";
-    display.getTextBounds(percentStr.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
-    percentY += tbh;
-    display.setCursor(centerX - tbw / 2, percentY);
-    display.print(percentStr);
-    
-    // Draw status indicator
-    if (moisture < MOISTURE_LOW_THRESHOLD) {
-        display.setTextSize(1);
-        display.setTextColor(GxEPD_RED);
-        display.getTextBounds("LOW!", 0, 0, &tbx, &tby, &tbw, &tbh);
-        percentY += tbh + 2;
-        display.setCursor(centerX - tbw / 2, percentY);
-        display.print("LOW!");
+    return false;
+}
+
+/**
+ * Load widget fingerprints and refresh history from the RTC record
+ */
+void PlantMonitor::loadFrameState()
+{
+    if (!rtc_store_open(frameRecord, FRAME_STATE_MAGIC, FRAME_STATE_VERSION, FRAME_STATE_KEY) ||
+        frameRecord.data.version != FRAME_STATE_VERSION) {
+        memset(&frameRecord.data, 0, sizeof(frameRecord.data));
+        frameRecord.data.version = FRAME_STATE_VERSION;
+        refreshPolicy.reset(frameRecord.data.history);
+    } else if (rtc_store_restored(frameRecord.header)) {
+        // The copy in flash may describe an older frame than the panel shows
+        frameRecord.data.panelKnown = 0;
     }
+    frameState = frameRecord.data;
+}
+
+/**
+ * Store widget fingerprints in the RTC record (sealed before deep sleep)
+ */
+void PlantMonitor::saveFrameState()
+{
+    rtc_store_open(frameRecord, FRAME_STATE_MAGIC, FRAME_STATE_VERSION, FRAME_STATE_KEY);
+    frameRecord.data = frameState;
+}
+
+/**
+ * Forget stored fingerprints (panel content is about to be replaced)
+ * Refresh cost history is kept
+ */
+void PlantMonitor::invalidateFrameState()
+{
+    prerenderedHeader = 0;  // The buffer is redrawn as well
     
-    // Draw plant name at bottom of allocated space
-    display.setFont(&DejaVu_Sans_Bold_11);
-    display.setTextSize(1);
-    display.setTextColor(GxEPD_BLACK);
-    
-    String displayName = name;
-    display.getTextBounds(displayName.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
-    
-    // Smart abbreviation if needed
-    if (tbw > w - 4) {
-        if (displayName.indexOf(" ") > 0) {
-            int spacePos = displayName.indexOf(" ");
-            String firstName = displayName.substring(0, spacePos);
-            String lastName = displayName.substring(spacePos + 1);
-            displayName = firstName + " " + lastName.substring(0, 1) + ".";
-            display.getTextBounds(displayName.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
-            
-            if (tbw > w - 4) {
-                displayName = firstName;
-                display.getTextBounds(displayName.c_str(), 0, 0, &tbx, &tby, &tbw, &tbh);
-            }
-        }
+    if (frameState.panelKnown) {
+        frameState.panelKnown = 0;
+        saveFrameState();
     }
-    
-    int nameY = y + h - 5;  // 5px from bottom
-    display.setCursor(centerX - tbw / 2, nameY);
-    display.print(displayName);
 }
 
 /**
@@ -327,111 +426,16 @@ void PlantMonitor::drawGauge(int x, int y, int w, int h, const char* name, int m
  */
 void PlantMonitor::showConfigScreen(const char* ssid, const char* password)
 {
-    Serial.println("Displaying WiFi configuration screen...");
+    LOGI("Displaying WiFi configuration screen...");
     
+    invalidateFrameState();
+    DashboardRenderer<PanelDisplay> renderer(display);
     display.setFullWindow();
     display.firstPage();
     
     do {
-        display.fillScreen(GxEPD_WHITE);
-        display.setTextColor(GxEPD_BLACK);
-        
-        int16_t tbx, tby;
-        uint16_t tbw, tbh;
-        int currentY = 20;
-        
-        // Title - "Configuration Required"
-        display.setFont(&DejaVu_Sans_Bold_11);
-        display.setTextSize(2);
-        const char* title = "Configuration Required";
-        display.getTextBounds(title, 0, 0, &tbx, &tby, &tbw, &tbh);
-        currentY += tbh;
-        display.setCursor((SCREEN_W - tbw) / 2, currentY);
-        display.print(title);
-        
-        currentY += 10;
-        
-        // Instructions
-        display.setTextSize(1);
-        const char* instruction = "Connect to WiFi network:";
-        display.getTextBounds(instruction, 0, 0, &tbx, &tby, &tbw, &tbh);
-        currentY += tbh + 10;
-        display.setCursor((SCREEN_W - tbw) / 2, currentY);
-        display.print(instruction);
-        
-        // SSID
-        display.setTextSize(1);
-        currentY += tbh + 15;
-        display.getTextBounds("SSID:", 0, 0, &tbx, &tby, &tbw, &tbh);
-        display.setCursor(40, currentY);
-        display.print("SSID:");
-        
-        display.setFont(&DejaVu_Sans_Bold_11);
-        display.setCursor(100, currentY);
-        display.print(ssid);
-        
-        // Password
-        display.setFont(&DejaVu_Sans_Bold_11);
-        currentY += tbh + 10;
-        display.setCursor(40, currentY);
-        display.print("Pass:");
-        
-        display.setFont(&DejaVu_Sans_Bold_11);
-        display.setCursor(100, currentY);
-        display.print(password);
-        
-        // Generate QR code for WiFi connection
-        // WiFi QR code format: WIFI:T:WPA;S:<SSID>;P:<PASSWORD>;;
-        String qrData = "WIFI:T:WPA;S:";
-        qrData += ssid;
-        qrData += ";P:";
-        qrData += password;
-        qrData += ";;";
-        
-        // Create QR code - use version 5 for better compatibility
-        QRCode qrcode;
-        uint8_t qrcodeData[qrcode_getBufferSize(5)];
-        qrcode_initText(&qrcode, qrcodeData, 5, ECC_MEDIUM, qrData.c_str());
-        
-        // Draw QR code centered below the text
-        int qrSize = qrcode.size;
-        int scale = 4;  // Increase scale factor for better scanning
-        int qrPixelSize = qrSize * scale;
-        int qrX = (SCREEN_W - qrPixelSize) / 2;
-        int qrY = currentY + 20;
-        
-        // Draw white background first
-        int border = scale * 4;  // Larger white border for better scanning
-        display.fillRect(qrX - border, qrY - border, qrPixelSize + border * 2, qrPixelSize + border * 2, GxEPD_WHITE);
-        
-        for (uint8_t y = 0; y < qrSize; y++) {
-            for (uint8_t x = 0; x < qrSize; x++) {
-                if (qrcode_getModule(&qrcode, x, y)) {
-                    display.fillRect(qrX + x * scale, qrY + y * scale, scale, scale, GxEPD_BLACK);
-                } else {
-                    display.fillRect(qrX + x * scale, qrY + y * scale, scale, scale, GxEPD_WHITE);
-                }
-            }
-        }
-        
-        // Instructions at bottom
-        display.setFont(&DejaVu_Sans_Bold_11);
-        display.setTextSize(1);
-        currentY = qrY + qrPixelSize + 20;
-        const char* scanMsg = "Scan QR code to connect";
-        display.getTextBounds(scanMsg, 0, 0, &tbx, &tby, &tbw, &tbh);
-        currentY += tbh;
-        display.setCursor((SCREEN_W - tbw) / 2, currentY);
-        display.print(scanMsg);
-        
-        currentY += tbh + 5;
-        const char* urlMsg = "Then open: 192.168.4.1";
-        display.getTextBounds(urlMsg, 0, 0, &tbx, &tby, &tbw, &tbh);
-        currentY += tbh;
-        display.setCursor((SCREEN_W - tbw) / 2, currentY);
-        display.print(urlMsg);
-        
+        renderer.drawConfigScreen(ssid, password);
     } while (display.nextPage());
     
-    Serial.println("Configuration screen displayed");
+    LOGD("Configuration screen displayed");
 }
@@ -1,72 +1,119 @@
 #include "PowerManager.h"
 #include "Config.h"
+#include "Log.h"
+#include "PhaseTrace.h"
+#include "RtcStore.h"
 #include <esp_sleep.h>
 #include <driver/gpio.h>
 #include <Wire.h>
 #include <SPI.h>
+#include <string.h>
+
+namespace {
+    const uint32_t BATTERY_MAGIC = 0x42415431;  // "BAT1"
+    const uint16_t BATTERY_VERSION = 1;
+    
+    RTC_DATA_ATTR RtcRecord<BatteryGauge::History> batteryHistory;
+}
 
 /**
  * Constructor - initializes power management
  */
 PowerManager::PowerManager()
-    : deepSleepDisablePin(DEEPSLEEP_DISABLE_PIN), maxLipoFound(false)
+    : deepSleepDisablePin(DEEPSLEEP_DISABLE_PIN), busStarted(false), batteryPercent(50), i2cMicros(0)
 {
+    memset(&battery, 0, sizeof(battery));
+    
     // Configure deep sleep disable pin as input with pullup
     pinMode(deepSleepDisablePin, INPUT_PULLUP);
 }
 
 /**
- * Initialize battery sensor (separate from constructor to avoid boot crashes)
+ * Read the battery gauge (separate from constructor to avoid boot crashes)
  */
-void PowerManager::initBatterySensor()
+const BatteryGauge::Snapshot& PowerManager::readBattery()
 {
-    Serial.println("Initializing battery sensor...");
-    
     // Initialize I2C with explicit pins (GPIO21=SDA, GPIO22=SCL)
-    Wire.begin(21, 22);
-    Wire.setClock(100000); // Set to 100kHz for better stability
-    delay(200);  // Give I2C time to stabilize
-    
-    Serial.println("I2C bus initialized");
-    
-    // Test I2C bus before trying sensor initialization
-    Wire.beginTransmission(0x36); // MAX1704X default address
-    uint8_t error = Wire.endTransmission();
-    
-    if (error == 0) {
-        Serial.println("I2C device detected at 0x36");
-        
-        // Initialize MAX1704X sensor
-        if (maxlipo.begin()) {
-            maxLipoFound = true;
-            Serial.println("MAX1704X battery fuel gauge initialized!");
-            
-            // Wake up the sensor if it was sleeping
-            maxlipo.wake();
-            delay(100);  // Give sensor time to wake up
-            
-            // Print initial readings with error checking
-            float voltage = maxlipo.cellVoltage();
-            float percent = maxlipo.cellPercent();
-            float rate = maxlipo.chargeRate();
-            
-            // Validate readings are reasonable
-            if (voltage > 0 && voltage < 10 && percent >= 0 && percent <= 100) {
-                Serial.printf("Battery voltage: %.2fV\r\n", voltage);
-                Serial.printf("Battery percentage: %.1f%%\r\n", percent);
-                Serial.printf("Charge rate: %.2f%%/hr\r\n", rate);
-            } else {
-                Serial.println("Sensor readings seem invalid, will use fallback values");
-                maxLipoFound = false;
-            }
-        } else {
-            maxLipoFound = false;
-            Serial.println("MAX1704X sensor initialization failed");
-        }
+    bool firstRead = !busStarted;
+    if (!busStarted) {
+        Wire.begin(21, 22);
+        Wire.setClock(BATTERY_I2C_HZ);
+        busStarted = true;
+    }
+    
+    // All registers in one burst; the gauge needs no wake-up or settling
+    // time as it keeps tracking in hibernate
+    uint8_t burst[BatteryGauge::BURST_BYTES];
+    bool wasPresent = battery.present;
+    if (readGauge(burst)) {
+        battery = BatteryGauge::decode(burst);
     } else {
-        maxLipoFound = false;
-        Serial.println("No I2C device found at MAX1704X address - using placeholder values");
+        battery.present = false;
+    }
+    
+    if (!battery.present) {
+        if (firstRead || wasPresent) {
+            LOGW("No MAX17048 at 0x%02x - using placeholder values", BATTERY_I2C_ADDRESS);
+        }
+        batteryPercent = 50;
+        return battery;
+    }
+    
+    // Put in sleep mode by earlier firmware: this wake's readings predate it
+    if (battery.sleeping) {
+        LOGW("Battery gauge was asleep, readings are stale");
+        writeGauge(BatteryGauge::REG_CONFIG, battery.config & ~BatteryGauge::CONFIG_SLEEP);
+    }
+    
+    if (!rtc_store_open(batteryHistory, BATTERY_MAGIC, BATTERY_VERSION) || batteryHistory.data.shown > 100) {
+        BatteryGauge::reset(batteryHistory.data);
+    }
+    batteryPercent = BatteryGauge::filter(batteryHistory.data, battery.rawPercent);
+    LOGD("Battery: %.2fV, %.1f%% (shown %d%%), %.2f%%/hr", battery.voltage, battery.rawPercent,
+         batteryPercent, battery.chargeRate);
+    return battery;
+}
+
+/**
+ * Take the battery gauge out of forced hibernate
+ */
+void PowerManager::keepGaugeAwake()
+{
+    if (battery.present) {
+        writeGauge(BatteryGauge::REG_HIBRT, BatteryGauge::HIBRT_DEFAULT);
+    }
+}
+
+/**
+ * Read BURST_BYTES from the gauge's first register
+ */
+bool PowerManager::readGauge(uint8_t* burst)
+{
+    unsigned long start = micros();
+    Wire.beginTransmission(BATTERY_I2C_ADDRESS);
+    Wire.write(BatteryGauge::FIRST_REGISTER);
+    bool ok = Wire.endTransmission(false) == 0 &&
+              Wire.requestFrom((uint8_t)BATTERY_I2C_ADDRESS, (uint8_t)BatteryGauge::BURST_BYTES) == BatteryGauge::BURST_BYTES;
+    for (size_t i = 0; ok && i < BatteryGauge::BURST_BYTES; i++) {
+        burst[i] = Wire.read();
     }
+    i2cMicros += micros() - start;
+    return ok;
+}
+
+/**
+ * Write one gauge register
+ */
+bool PowerManager::writeGauge(uint8_t reg, uint16_t value)
+{
+    unsigned long start = micros();
+    Wire.beginTransmission(BATTERY_I2C_ADDRESS);
+    Wire.write(reg);
+    Wire.write((uint8_t)(value >> 8));
+    Wire.write((uint8_t)value);
+    bool ok = Wire.endTransmission() == 0;
+    i2cMicros += micros() - start;
+    return ok;
 }
 
 /**
@@ -74,8 +121,8 @@ void PowerManager::initBatterySensor()
  */
 float PowerManager::getBatteryVoltage()
 {
-    if (maxLipoFound) {
-        return maxlipo.cellVoltage();
+    if (battery.present) {
+        return battery.voltage;
     }
     // Fallback - returns fixed value if sensor not available
     return 3.9;
@@ -86,13 +133,8 @@ float PowerManager::getBatteryVoltage()
  */
 int PowerManager::getBatteryPercentage()
 {
-    if (maxLipoFound) {
-        float percent = maxlipo.cellPercent();
-        // Clamp to 0-100 range and convert to int
-        return (int)constrain(percent, 0.0, 100.0);
-    }
-    // Fallback - returns fixed value if sensor not available
-    return 50;
+    // Filtered; the fallback value if sensor not available
+    return batteryPercent;
 }
 
 /**
@@ -100,19 +142,27 @@ int PowerManager::getBatteryPercentage()
  */
 float PowerManager::getChargeRate()
 {
-    if (maxLipoFound) {
-        return maxlipo.chargeRate();
+    if (battery.present) {
+        return battery.chargeRate;
     }
     // Fallback - returns 0 if sensor not available
     return 0.0;
 }
 
 /**
- * Check if battery sensor (MAX1704X) is present and working
+ * Check if battery sensor (MAX17048) is present and working
  */
 bool PowerManager::isBatterySensorPresent()
 {
-    return maxLipoFound;
+    return battery.present;
+}
+
+/**
+ * I2C bus time since boot
+ */
+uint32_t PowerManager::getI2cMicros()
+{
+    return i2cMicros;
 }
 
 /**
@@ -125,36 +175,37 @@ bool PowerManager::isDeepSleepDisabled()
 }
 
 /**
- * Enter deep sleep mode for specified hours
+ * Enter deep sleep mode for specified seconds
  */
-void PowerManager::enterDeepSleep(int hours)
+void PowerManager::enterDeepSleep(uint32_t seconds)
 {
-    if (hours <= 0) {
-        Serial.println("Invalid sleep time, using default 1 hour");
-        hours = 1;
+    if (seconds == 0) {
+        LOGW("Invalid sleep time, using default 1 hour");
+        seconds = 3600;
     }
     
-    // Convert hours to microseconds
-    uint64_t sleepTimeMicros = (uint64_t)hours * 3600 * 1000000ULL;
+    TRACE_BEGIN(TRACE_SLEEP_PREP);
+    
+    // Convert seconds to microseconds
+    uint64_t sleepTimeMicros = (uint64_t)seconds * 1000000ULL;
     
-    Serial.printf("Entering deep sleep for %d hour(s)...\r\n", hours);
-    Serial.println("Preparing peripherals for deep sleep...");
+    LOGI("Entering deep sleep for %lu s...", (unsigned long)seconds);
+    LOGD("Preparing peripherals for deep sleep...");
     
-    // 1. Put battery gauge to deep sleep if present
-    if (maxLipoFound) {
-        Serial.println("Putting battery gauge to sleep...");
-        maxlipo.hibernate();
-        maxlipo.enableSleep(true);
-        maxlipo.sleep(true);
+    // 1. Keep the battery gauge in hibernate if present: it goes on tracking
+    // the charge (about 3 uA, vs 0.5 uA asleep) so the next wake reads it at once
+    if (battery.present) {
+        LOGD("Putting battery gauge in hibernate...");
+        writeGauge(BatteryGauge::REG_HIBRT, BatteryGauge::HIBRT_ALWAYS);
     }
     
     // 2. Shutdown I2C and SPI buses
-    Serial.println("Shutting down I2C and SPI buses...");
+    LOGD("Shutting down I2C and SPI buses...");
     Wire.end();
     SPI.end();
     
     // 3. Set all peripheral GPIOs to high-Z (floating input) to minimize leakage
-    Serial.println("Configuring GPIOs for low-power state...");
+    LOGD("Configuring GPIOs for low-power state...");
     
     // Display control pins
     const gpio_num_t displayPins[] = {
@@ -204,15 +255,18 @@ void PowerManager::enterDeepSleep(int hours)
     gpio_reset_pin(GPIO_NUM_4);
     pinMode(DEEPSLEEP_DISABLE_PIN, INPUT_PULLUP);
     
-    // 4. Disable RTC power domains for maximum power savings
-    Serial.println("Disabling RTC power domains...");
+    // 4. Disable RTC power domains for maximum power savings; slow memory
+    // stays powered for the state kept across sleep (RtcStore records,
+    // telemetry ring, phase trace): about 5 uA, see README
+    LOGD("Disabling RTC power domains...");
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_OFF);
-    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_OFF);
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_ON);
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_FAST_MEM, ESP_PD_OPTION_OFF);
     esp_sleep_pd_config(ESP_PD_DOMAIN_XTAL, ESP_PD_OPTION_OFF);
     
-    Serial.println("Deep sleep preparation complete!");
-    Serial.flush();
+    LOGI("Deep sleep preparation complete!");
+    log_flush(LOG_FLUSH_TIMEOUT_MS);
+    TRACE_END(TRACE_SLEEP_PREP);
     
     // 5. Configure wake up timer
     esp_sleep_enable_timer_wakeup(sleepTimeMicros);
@@ -0,0 +1,107 @@
+#include "RefreshPolicy.h"
+#include "Config.h"
+#include <string.h>
+
+/**
+ * Constructor
+ */
+RefreshPolicy::RefreshPolicy(const PanelCaps& caps)
+    : caps(caps)
+{
+}
+
+/**
+ * Reset history to the state of a panel with unknown content
+ */
+void RefreshPolicy::reset(History& history) const
+{
+    memset(&history, 0, sizeof(history));
+    history.redOnPanel = 1;  // Assume the worst until a full refresh
+    history.lastMode = REFRESH_FULL;
+}
+
+/**
+ * Decide how to push a frame to the panel
+ */
+RefreshPolicy::Decision RefreshPolicy::decide(const Frame& frame, const History& history) const
+{
+    if (!frame.panelKnown) {
+        return make(REFRESH_FULL, "panel content unknown", history);
+    }
+
+    if (!frame.changed) {
+        return make(REFRESH_SKIP, "content unchanged", history);
+    }
+
+    if (history.ghosting >= FULL_REFRESH_INTERVAL) {
+        return make(REFRESH_FULL, "ghosting budget exhausted", history);
+    }
+
+    bool largeChange = frame.dirtyArea * 100 > frame.screenArea * FULL_REFRESH_AREA_PCT;
+    if (caps.partial && !largeChange) {
+        return make(REFRESH_PARTIAL, "changed widgets only", history);
+    }
+
+    // Red pixels can only be drawn or removed by the tri-color waveform;
+    // black/white panels draw alerts in black
+    bool redInvolved = caps.red && (frame.hasRed || history.redOnPanel);
+    if (caps.mono && !redInvolved) {
+        return make(REFRESH_MONO, "no red content", history);
+    }
+
+    return make(REFRESH_FULL, largeChange ? "large change" : "no fast path", history);
+}
+
+/**
+ * Update history after the refresh has been performed
+ */
+void RefreshPolicy::record(History& history, const Decision& decision, uint32_t measuredMs, bool hasRed) const
+{
+    history.lastMode = decision.mode;
+    if (decision.mode == REFRESH_SKIP) {
+        return;
+    }
+
+    // Smooth measured cost so one slow BUSY wait does not skew estimates
+    uint16_t sample = measuredMs > 0xFFFF ? 0xFFFF : (uint16_t)measuredMs;
+    uint16_t& cost = history.costMs[decision.mode];
+    cost = (cost == 0) ? sample : (uint16_t)((cost * 3u + sample) / 4u);
+
+    if (decision.mode == REFRESH_FULL) {
+        history.ghosting = 0;
+    } else if (history.ghosting < 0xFF) {
+        history.ghosting++;
+    }
+    history.redOnPanel = hasRed ? 1 : 0;
+}
+
+/**
+ * Human readable name of a refresh mode
+ */
+const char* RefreshPolicy::modeName(RefreshMode mode)
+{
+    switch (mode) {
+        case REFRESH_SKIP:    return "skip";
+        case REFRESH_PARTIAL: return "partial";
+        case REFRESH_MONO:    return "mono";
+        case REFRESH_FULL:    return "full";
+        default:              return "unknown";
+    }
+}
+
+/**
+ * Build a decision with its estimated time cost
+ */
+RefreshPolicy::Decision RefreshPolicy::make(RefreshMode mode, const char* reason, const History& history) const
+{
+    uint32_t estimate = history.costMs[mode];
+    if (estimate == 0) {
+        switch (mode) {
+            case REFRESH_SKIP:    estimate = 0; break;
+            case REFRESH_PARTIAL:
+            case REFRESH_MONO:    estimate = caps.partialMs; break;
+            default:              estimate = caps.fullMs; break;
+        }
+    }
+    return {mode, reason, estimate};
+}
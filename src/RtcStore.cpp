@@ -0,0 +1,153 @@
+#include "RtcStore.h"
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include "Settings.h"
+#include "Log.h"
+#endif
+
+/**
+ * CRC32 (IEEE 802.3), bitwise: records are small and sealed once per wake
+ */
+uint32_t RtcStore::crc32(const void* data, size_t length, uint32_t crc)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+ * Whether a header and its data form an intact record of this layout
+ */
+bool RtcStore::valid(const RtcHeader& header, uint32_t magic, uint16_t version, size_t size)
+{
+    return header.magic == magic && header.version == version && header.size == size &&
+           header.crc == crc32(&header + 1, size);
+}
+
+/**
+ * Fresh header for a record of this layout
+ */
+void RtcStore::init(RtcHeader& header, uint32_t magic, uint16_t version, size_t size)
+{
+    memset(&header, 0, sizeof(header));
+    header.magic = magic;
+    header.version = version;
+    header.size = (uint16_t)size;
+}
+
+/**
+ * Seal the record: set the CRC of its data
+ */
+bool RtcStore::seal(RtcHeader& header, bool flush)
+{
+    header.crc = crc32(&header + 1, header.size);
+    if (header.crc == header.nvsCrc) {
+        header.pending = 0;
+        return false;
+    }
+    if (header.pending < UINT16_MAX) {
+        header.pending++;
+    }
+    return flush || header.pending >= RTC_NVS_WRITE_WAKES;
+}
+
+/**
+ * Record that the sealed data was copied to NVS
+ */
+void RtcStore::markCopied(RtcHeader& header)
+{
+    header.nvsCrc = header.crc;
+    header.pending = 0;
+}
+
+#if defined(ARDUINO)
+namespace {
+    const int MAX_RECORDS = 8;
+    
+    struct OpenRecord {
+        RtcHeader* header;
+        const char* nvsKey;
+        bool restored;
+    };
+    
+    // Records opened this wake (RAM, rebuilt every boot)
+    OpenRecord records[MAX_RECORDS];
+    int recordCount = 0;
+}
+
+/**
+ * Open a record on its first use this wake
+ */
+bool rtc_store_open(RtcHeader& header, uint32_t magic, uint16_t version, size_t size, const char* nvsKey)
+{
+    for (int i = 0; i < recordCount; i++) {
+        if (records[i].header == &header) {
+            return true;
+        }
+    }
+    
+    bool intact = RtcStore::valid(header, magic, version, size);
+    bool restored = false;
+    if (!intact && nvsKey) {
+        intact = settings_get_bytes(nvsKey, &header, sizeof(header) + size) &&
+                 RtcStore::valid(header, magic, version, size);
+        if (intact) {
+            LOGI("[RTC] %s restored from flash", nvsKey);
+            restored = true;
+        }
+    }
+    if (!intact) {
+        RtcStore::init(header, magic, version, size);
+    }
+    
+    if (recordCount < MAX_RECORDS) {
+        records[recordCount].header = &header;
+        records[recordCount].nvsKey = nvsKey;
+        records[recordCount].restored = restored;
+        recordCount++;
+    } else {
+        LOGW("[RTC] Too many records, %08lx is not sealed", (unsigned long)magic);
+    }
+    return intact;
+}
+
+/**
+ * Whether a record opened this wake came from its NVS copy
+ */
+bool rtc_store_restored(const RtcHeader& header)
+{
+    for (int i = 0; i < recordCount; i++) {
+        if (records[i].header == &header) {
+            return records[i].restored;
+        }
+    }
+    return false;
+}
+
+/**
+ * Seal the records opened this wake; copy them to NVS when due
+ */
+void rtc_store_seal(bool flush)
+{
+    for (int i = 0; i < recordCount; i++) {
+        RtcHeader& header = *records[i].header;
+        if (!RtcStore::seal(header, flush) || !records[i].nvsKey) {
+            continue;
+        }
+        
+        // The copy in flash records itself as current
+        uint16_t pending = header.pending;
+        RtcStore::markCopied(header);
+        settings_put_bytes(records[i].nvsKey, &header, sizeof(header) + header.size);
+        LOGD("[RTC] %s copied to flash (%u changed seals)", records[i].nvsKey, pending);
+    }
+}
+#endif
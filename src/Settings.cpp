@@ -88,6 +88,25 @@ void settings_put_bool(const char* key, bool value)
     prefs().putBool(key, value);
 }
 
+/**
+ * Get a binary blob from settings
+ */
+bool settings_get_bytes(const char* key, void* buffer, size_t length)
+{
+    if (!prefs().isKey(key) || prefs().getBytesLength(key) != length) {
+        return false;
+    }
+    return prefs().getBytes(key, buffer, length) == length;
+}
+
+/**
+ * Store a binary blob in settings
+ */
+void settings_put_bytes(const char* key, const void* buffer, size_t length)
+{
+    prefs().putBytes(key, buffer, length);
+}
+
 /**
  * Clear all settings (factory reset)
  */
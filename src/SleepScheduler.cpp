@@ -0,0 +1,196 @@
+#include "SleepScheduler.h"
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include "RtcStore.h"
+#include "Log.h"
+#endif
+
+namespace {
+    const int MINUTES_PER_DAY = 24 * 60;
+    const int RECENT_WAKES = 4;     // Window of the "data changing" rule
+    
+    uint32_t fnv1a(const void* data, size_t length, uint32_t hash = 2166136261u)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+    
+    int countBits(uint8_t bits)
+    {
+        int count = 0;
+        for (; bits; bits &= bits - 1) {
+            count++;
+        }
+        return count;
+    }
+}
+
+/**
+ * Constructor
+ */
+SleepScheduler::SleepScheduler(const Bounds& bounds)
+    : bounds(bounds)
+{
+    if (this->bounds.baseMinutes == 0) {
+        this->bounds.baseMinutes = 60;
+    }
+    if (this->bounds.maxMinutes < this->bounds.minMinutes) {
+        this->bounds.maxMinutes = this->bounds.minMinutes;
+    }
+}
+
+/**
+ * Reset history to a device without data yet
+ */
+void SleepScheduler::reset(History& history)
+{
+    memset(&history, 0, sizeof(history));
+}
+
+/**
+ * Fingerprint of the plant readings
+ */
+uint32_t SleepScheduler::fingerprint(const DashboardModel& model)
+{
+    uint32_t hash = fnv1a(&model.plantCount, sizeof(model.plantCount));
+    for (int i = 0; i < model.plantCount; i++) {
+        hash = fnv1a(model.plants[i].name, strlen(model.plants[i].name), hash);
+        hash = fnv1a(&model.plants[i].moisture, sizeof(model.plants[i].moisture), hash);
+    }
+    return hash;
+}
+
+/**
+ * Add the data received this wake to the history
+ */
+void SleepScheduler::record(History& history, uint32_t fingerprint)
+{
+    if (history.known) {
+        bool changed = fingerprint != history.fingerprint;
+        history.changes = (uint8_t)((history.changes << 1) | (changed ? 1 : 0));
+        if (history.compared < 8) {
+            history.compared++;
+        }
+        if (changed) {
+            history.unchanged = 0;
+        } else if (history.unchanged < 255) {
+            history.unchanged++;
+        }
+    }
+    history.fingerprint = fingerprint;
+    history.known = 1;
+}
+
+/**
+ * Sleep duration after this wake
+ */
+SleepScheduler::Decision SleepScheduler::decide(const Inputs& inputs, const History& history) const
+{
+    uint32_t minutes = bounds.baseMinutes;
+    const char* reason = "configured";
+    
+    // Data change frequency
+    int recent = history.compared < RECENT_WAKES ? history.compared : RECENT_WAKES;
+    int recentChanges = countBits(history.changes & ((1 << recent) - 1));
+    if (history.unchanged >= SLEEP_UNCHANGED_WAKES) {
+        uint32_t stretch = 1 + history.unchanged / SLEEP_UNCHANGED_WAKES;
+        minutes *= stretch < SLEEP_MAX_STRETCH ? stretch : SLEEP_MAX_STRETCH;
+        reason = "data unchanged";
+    } else if (recentChanges >= SLEEP_CHANGING_WAKES) {
+        minutes /= 2;
+        reason = "data changing";
+    }
+    
+    // Battery; charging wins over a low reading
+    if (inputs.gaugePresent) {
+        if (inputs.chargeRate >= SLEEP_CHARGING_RATE) {
+            minutes /= 2;
+            reason = "charging";
+        } else if (inputs.batteryPercent <= SLEEP_CRITICAL_BATTERY_PCT) {
+            minutes = bounds.maxMinutes;
+            reason = "battery critical";
+        } else if (inputs.batteryPercent <= SLEEP_LOW_BATTERY_PCT) {
+            minutes *= 2;
+            reason = "battery low";
+        }
+    }
+    
+    if (minutes < bounds.minMinutes) {
+        minutes = bounds.minMinutes;
+    } else if (minutes > bounds.maxMinutes) {
+        minutes = bounds.maxMinutes;
+    }
+    
+    // Do not wake during quiet hours; sleep until they end if allowed
+    if (inputs.minuteOfDay >= 0 && quiet((inputs.minuteOfDay + minutes) % MINUTES_PER_DAY)) {
+        uint32_t untilEnd = (bounds.quietEnd * 60 - inputs.minuteOfDay + MINUTES_PER_DAY) % MINUTES_PER_DAY;
+        if (untilEnd > minutes) {
+            minutes = untilEnd < bounds.maxMinutes ? untilEnd : bounds.maxMinutes;
+            reason = "quiet hours";
+        }
+    }
+    
+    Decision decision;
+    decision.minutes = (uint16_t)minutes;
+    decision.reason = reason;
+    return decision;
+}
+
+/**
+ * Whether a time of day falls into the quiet hours
+ */
+bool SleepScheduler::quiet(int minuteOfDay) const
+{
+    if (bounds.quietStart < 0 || bounds.quietEnd < 0 || bounds.quietStart == bounds.quietEnd) {
+        return false;
+    }
+    int start = bounds.quietStart * 60;
+    int end = bounds.quietEnd * 60;
+    if (start < end) {
+        return minuteOfDay >= start && minuteOfDay < end;
+    }
+    return minuteOfDay >= start || minuteOfDay < end;  // Over midnight
+}
+
+#if defined(ARDUINO)
+namespace {
+    const uint32_t SCHEDULE_MAGIC = 0x534c5031;  // "SLP1"
+    const uint16_t SCHEDULE_VERSION = 1;
+    
+    RTC_DATA_ATTR RtcRecord<SleepScheduler::History> schedule;
+    
+    void validate()
+    {
+        if (!rtc_store_open(schedule, SCHEDULE_MAGIC, SCHEDULE_VERSION) || schedule.data.compared > 8) {
+            SleepScheduler::reset(schedule.data);
+        }
+    }
+}
+
+/**
+ * Add the dashboard shown this wake to the history kept in RTC memory
+ */
+void sleep_schedule_record(const DashboardModel& model)
+{
+    validate();
+    SleepScheduler::record(schedule.data, SleepScheduler::fingerprint(model));
+}
+
+/**
+ * Sleep duration after this wake
+ */
+SleepScheduler::Decision sleep_schedule_next(const SleepScheduler::Bounds& bounds, const SleepScheduler::Inputs& inputs)
+{
+    validate();
+    SleepScheduler::Decision decision = SleepScheduler(bounds).decide(inputs, schedule.data);
+    LOGI("[Sleep] %u min (%s): battery %d%%, %.2f%%/h, data unchanged for %u wakes",
+         decision.minutes, decision.reason, inputs.batteryPercent, inputs.chargeRate,
+         schedule.data.unchanged);
+    return decision;
+}
+#endif
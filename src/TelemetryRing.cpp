@@ -0,0 +1,148 @@
+#include "TelemetryRing.h"
+#include "Config.h"
+#include <cstring>
+
+namespace {
+    const uint32_t TELEMETRY_MAGIC = 0x544c4d31;  // "TLM1"
+    const uint16_t TELEMETRY_LAYOUT = 3;          // Bumped when TelemetryEntry changes
+    
+    /**
+     * Metrics of one wake, packed
+     */
+    struct TelemetryEntry {
+        uint32_t freeHeap;
+        uint32_t wakeMs;
+        uint16_t batteryMv;
+        uint16_t sleepMinutes;
+        uint16_t i2cUs;
+        int16_t chargeRate;     // 0.01 %/h
+        uint8_t batteryPercent;
+        int8_t rssi;
+        char refresh;           // First letter of the mode name
+    };
+    
+    struct TelemetryLog {
+        uint32_t magic;
+        uint32_t firmware;      // Firmware that wrote the ring
+        uint16_t layout;        // TELEMETRY_LAYOUT of the entries
+        uint32_t nextWake;      // Wake number of the next entry
+        uint16_t head;          // Oldest entry
+        uint16_t count;
+        uint16_t sinceFlush;    // Wakes recorded since the last flush
+        bool fresh;             // Not flushed since the last reset
+        TelemetryEntry entries[TELEMETRY_RING_SIZE];
+    };
+    
+    RTC_DATA_ATTR TelemetryLog ring;
+    
+    bool valid()
+    {
+        return ring.magic == TELEMETRY_MAGIC && ring.firmware == FIRMWARE_VERSION &&
+               ring.layout == TELEMETRY_LAYOUT && ring.count <= TELEMETRY_RING_SIZE && ring.head < TELEMETRY_RING_SIZE;
+    }
+    
+    const TelemetryEntry& entry(int i)
+    {
+        return ring.entries[(ring.head + i) % TELEMETRY_RING_SIZE];
+    }
+    
+    /**
+     * Append one column of the batch
+     */
+    template <typename Format>
+    void appendColumn(String& out, const char* key, Format format)
+    {
+        out += ",\"";
+        out += key;
+        out += "\":[";
+        for (int i = 0; i < ring.count; i++) {
+            if (i > 0) {
+                out += ",";
+            }
+            out += format(entry(i));
+        }
+        out += "]";
+    }
+}
+
+/**
+ * Append the metrics of this wake
+ */
+void telemetry_record(const TelemetrySample& sample)
+{
+    if (!valid()) {
+        memset(&ring, 0, sizeof(ring));
+        ring.magic = TELEMETRY_MAGIC;
+        ring.firmware = FIRMWARE_VERSION;
+        ring.layout = TELEMETRY_LAYOUT;
+        ring.fresh = true;
+    }
+    
+    int index = (ring.head + ring.count) % TELEMETRY_RING_SIZE;
+    if (ring.count == TELEMETRY_RING_SIZE) {
+        ring.head = (ring.head + 1) % TELEMETRY_RING_SIZE;  // Overwrite the oldest
+    } else {
+        ring.count++;
+    }
+    
+    TelemetryEntry& next = ring.entries[index];
+    next.freeHeap = sample.freeHeap;
+    next.wakeMs = sample.wakeMs;
+    next.batteryMv = (uint16_t)constrain(sample.batteryVoltage * 1000.0f + 0.5f, 0.0f, 65535.0f);
+    next.chargeRate = (int16_t)constrain(sample.chargeRate * 100.0f, -32768.0f, 32767.0f);
+    next.batteryPercent = (uint8_t)constrain(sample.batteryPercent, 0, 255);
+    next.rssi = (int8_t)constrain(sample.rssi, -128, 127);
+    next.refresh = sample.refresh && sample.refresh[0] ? sample.refresh[0] : '-';
+    next.sleepMinutes = sample.sleepMinutes;
+    next.i2cUs = (uint16_t)(sample.i2cUs < 65535 ? sample.i2cUs : 65535);
+    
+    ring.nextWake++;
+    ring.sinceFlush++;
+}
+
+/**
+ * Whether this wake should publish the batch
+ */
+bool telemetry_due()
+{
+    return valid() && ring.count > 0 &&
+           (ring.fresh || ring.count == TELEMETRY_RING_SIZE || ring.sinceFlush >= TELEMETRY_BATCH_WAKES);
+}
+
+/**
+ * Queued entries as one compact JSON message
+ */
+bool telemetry_batch_json(String& out)
+{
+    if (!valid() || ring.count == 0) {
+        return false;
+    }
+    
+    out = "{\"wake\":" + String(ring.nextWake - ring.count) + ",\"n\":" + String(ring.count);
+    appendColumn(out, "mv", [](const TelemetryEntry& e) { return String(e.batteryMv); });
+    appendColumn(out, "pct", [](const TelemetryEntry& e) { return String(e.batteryPercent); });
+    appendColumn(out, "rate", [](const TelemetryEntry& e) { return String(e.chargeRate / 100.0f, 2); });
+    appendColumn(out, "rssi", [](const TelemetryEntry& e) { return String(e.rssi); });
+    appendColumn(out, "ms", [](const TelemetryEntry& e) { return String(e.wakeMs); });
+    appendColumn(out, "heap", [](const TelemetryEntry& e) { return String(e.freeHeap); });
+    appendColumn(out, "sleep", [](const TelemetryEntry& e) { return String(e.sleepMinutes); });
+    appendColumn(out, "i2c", [](const TelemetryEntry& e) { return String(e.i2cUs); });
+    
+    out += ",\"refresh\":\"";
+    for (int i = 0; i < ring.count; i++) {
+        out += entry(i).refresh;
+    }
+    out += "\"}";
+    return true;
+}
+
+/**
+ * Drop the published entries
+ */
+void telemetry_flushed()
+{
+    ring.head = 0;
+    ring.count = 0;
+    ring.sinceFlush = 0;
+    ring.fresh = false;
+}
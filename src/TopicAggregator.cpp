@@ -0,0 +1,218 @@
+#include "TopicAggregator.h"
+#include <ArduinoJson.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+    const unsigned int MAX_SENSOR_PAYLOAD = 160;
+
+    /**
+     * FNV-1a hash of a topic, the table key
+     */
+    uint32_t topicHash(const char* topic)
+    {
+        uint32_t hash = 2166136261u;
+        while (*topic) {
+            hash ^= (uint8_t)*topic++;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+}
+
+/**
+ * Constructor
+ */
+TopicAggregator::TopicAggregator()
+    : received(0),
+      dropped(0),
+      invalid(0),
+      filter("")
+{
+    table.clear();
+    memset(keys, 0, sizeof(keys));
+}
+
+/**
+ * Whether a topic filter contains MQTT wildcards
+ */
+bool TopicAggregator::isWildcard(const char* filter)
+{
+    return strchr(filter, '+') != nullptr || strchr(filter, '#') != nullptr;
+}
+
+/**
+ * MQTT topic filter match
+ */
+bool TopicAggregator::matches(const char* filter, const char* topic)
+{
+    while (*filter) {
+        if (*filter == '#') {
+            return true;
+        }
+        if (filter[0] == '/' && filter[1] == '#' && *topic == '\0') {
+            return true;  // "a/#" also matches its parent level "a"
+        }
+        if (*filter == '+') {
+            while (*topic && *topic != '/') {
+                topic++;
+            }
+            filter++;
+        } else {
+            if (*filter != *topic) {
+                return false;
+            }
+            filter++;
+            topic++;
+        }
+    }
+    return *topic == '\0';
+}
+
+/**
+ * Start a new collection window
+ */
+void TopicAggregator::begin(const char* filter)
+{
+    this->filter = filter;
+    received = 0;
+    dropped = 0;
+    invalid = 0;
+    table.clear();
+    memset(keys, 0, sizeof(keys));
+}
+
+/**
+ * Add a sensor message
+ */
+bool TopicAggregator::add(const char* topic, const uint8_t* payload, unsigned int length)
+{
+    if (!matches(filter, topic)) {
+        return false;
+    }
+    received++;
+    
+    // Sensor payloads are small, anything longer is not one
+    char text[MAX_SENSOR_PAYLOAD];
+    if (length == 0 || length >= sizeof(text)) {
+        invalid++;
+        return false;
+    }
+    memcpy(text, payload, length);
+    text[length] = '\0';
+    
+    char name[PLANT_NAME_LEN];
+    const char* updateDate = nullptr;
+    float moisture;
+    StaticJsonDocument<256> doc;
+    
+    if (text[0] == '{') {
+        if (deserializeJson(doc, text) || !doc["moisture"].is<float>()) {
+            invalid++;
+            return false;
+        }
+        moisture = doc["moisture"];
+        updateDate = doc["updateDate"];
+        const char* payloadName = doc["name"];
+        if (payloadName) {
+            strncpy(name, payloadName, sizeof(name) - 1);
+            name[sizeof(name) - 1] = '\0';
+        } else {
+            nameFromTopic(topic, name, sizeof(name));
+        }
+    } else {
+        char* end;
+        moisture = strtof(text, &end);
+        if (end == text) {
+            invalid++;  // "unknown", "unavailable", ...
+            return false;
+        }
+        nameFromTopic(topic, name, sizeof(name));
+    }
+    
+    // strtof takes "nan" and "inf" (ESPHome publishes "nan" for a failed read)
+    if (!isfinite(moisture)) {
+        invalid++;
+        return false;
+    }
+    int percent = moisture < 0 ? 0 : (moisture > 100 ? 100 : (int)moisture);
+    
+    uint32_t key = topicHash(topic);
+    int slot = 0;
+    while (slot < table.plantCount && keys[slot] != key) {
+        slot++;
+    }
+    
+    if (slot < table.plantCount) {
+        // Sensor seen before in this window: keep the newest reading
+        table.plants[slot].moisture = percent;
+    } else if (table.addPlant(name, percent)) {
+        keys[slot] = key;
+    } else {
+        dropped++;
+        return false;
+    }
+    
+    // Newest date reported by any sensor (ISO dates sort as strings)
+    if (updateDate && strcmp(updateDate, table.updateDate) > 0) {
+        table.setUpdateDate(updateDate);
+    }
+    return true;
+}
+
+/**
+ * Fill the dashboard with the collected sensors, sorted by name
+ * Retained messages arrive in broker order, sorting keeps the layout stable.
+ */
+void TopicAggregator::build(DashboardModel& model) const
+{
+    model = table;
+    for (int i = 1; i < model.plantCount; i++) {
+        DashboardModel::Plant plant = model.plants[i];
+        int j = i;
+        while (j > 0 && strcmp(model.plants[j - 1].name, plant.name) > 0) {
+            model.plants[j] = model.plants[j - 1];
+            j--;
+        }
+        model.plants[j] = plant;
+    }
+}
+
+/**
+ * Plant name from the topic level matched by the first wildcard
+ * "plants/ficus_lyrata/state" with "plants/+/state" gives "Ficus Lyrata"
+ */
+void TopicAggregator::nameFromTopic(const char* topic, char* name, unsigned int size) const
+{
+    // Skip the levels before the first wildcard
+    const char* f = filter;
+    const char* t = topic;
+    while (*f && *f != '+' && *f != '#') {
+        if (*f == '/') {
+            while (*t && *t != '/') {
+                t++;
+            }
+            if (*t) {
+                t++;
+            }
+        }
+        f++;
+    }
+    
+    unsigned int n = 0;
+    bool wordStart = true;
+    while (*t && *t != '/' && n < size - 1) {
+        char c = *t++;
+        if (c == '_' || c == '-') {
+            c = ' ';
+            wordStart = true;
+        } else if (wordStart) {
+            c = toupper((unsigned char)c);
+            wordStart = false;
+        }
+        name[n++] = c;
+    }
+    name[n] = '\0';
+}
@@ -0,0 +1,159 @@
+#include "WakeJitter.h"
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include "RtcStore.h"
+#include "Log.h"
+#endif
+
+namespace {
+    const uint8_t MAX_WIDEN = 4;    // Beyond any JITTER_MAX_WINDOW_S / JITTER_WINDOW_S in use
+    
+    uint32_t fnv1a(const void* data, size_t length, uint32_t hash = 2166136261u)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+}
+
+/**
+ * Reset to the base window without latency history
+ */
+void WakeJitter::reset(State& state)
+{
+    memset(&state, 0, sizeof(state));
+}
+
+/**
+ * Hash placing a node in the window
+ */
+uint32_t WakeJitter::nodeHash(uint64_t mac, const char* nodeName)
+{
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (uint8_t)(mac >> (8 * i));
+    }
+    uint32_t hash = fnv1a(nodeName, strlen(nodeName), fnv1a(bytes, sizeof(bytes)));
+    
+    // Final mix: MACs of one batch differ in a few low bits only
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/**
+ * Add the connect latency of this wake and adapt the window
+ */
+void WakeJitter::observe(State& state, uint32_t connectMs)
+{
+    if (connectMs > UINT16_MAX) {
+        connectMs = UINT16_MAX;
+    }
+    state.connectMs = state.connectMs ? (uint16_t)((3u * state.connectMs + connectMs) / 4) : (uint16_t)connectMs;
+    
+    // Narrowing puts the load back, so it waits for a long calm stretch
+    if (state.connectMs < JITTER_SLOW_CONNECT_MS / 2) {
+        if (state.calm < UINT8_MAX) {
+            state.calm++;
+        }
+    } else {
+        state.calm = 0;
+    }
+    
+    // One step at a time, then wait for the fleet's latency to follow
+    if (state.hold > 0) {
+        state.hold--;
+        return;
+    }
+    if (state.connectMs > JITTER_SLOW_CONNECT_MS && state.widen < MAX_WIDEN) {
+        state.widen++;
+        state.hold = JITTER_HOLD_WAKES;
+    } else if (state.calm >= JITTER_CALM_WAKES && state.widen > 0) {
+        state.widen--;
+        state.calm = 0;
+        state.hold = JITTER_HOLD_WAKES;
+    }
+}
+
+/**
+ * Current window
+ */
+uint32_t WakeJitter::window(const State& state, uint32_t baseS, uint32_t maxS)
+{
+    uint32_t windowS = baseS << state.widen;
+    return windowS < maxS ? windowS : maxS;
+}
+
+/**
+ * Offset of a node in [0, windowS)
+ */
+uint32_t WakeJitter::offset(uint32_t hash, uint32_t windowS)
+{
+    return (uint32_t)(((uint64_t)hash * windowS) >> 32);
+}
+
+#if defined(ARDUINO)
+namespace {
+    const uint32_t JITTER_MAGIC = 0x4a495431;  // "JIT1"
+    const uint16_t JITTER_VERSION = 1;
+    
+    RTC_DATA_ATTR RtcRecord<WakeJitter::State> jitter;
+    
+    void validate()
+    {
+        if (!rtc_store_open(jitter, JITTER_MAGIC, JITTER_VERSION) || jitter.data.widen > MAX_WIDEN) {
+            WakeJitter::reset(jitter.data);
+        }
+    }
+}
+
+/**
+ * Add the connect latency of this wake to the history kept in RTC memory
+ */
+void jitter_observe(uint32_t connectMs)
+{
+    validate();
+    uint8_t widen = jitter.data.widen;
+    WakeJitter::observe(jitter.data, connectMs);
+    if (jitter.data.widen != widen) {
+        LOGI("[Jitter] Connect %lu ms (smoothed %u ms): wake window %s",
+             (unsigned long)connectMs, jitter.data.connectMs, jitter.data.widen > widen ? "widened" : "narrowed");
+    }
+}
+
+/**
+ * Window after the publish slot, adapted to the connect latency
+ */
+uint32_t jitter_window(uint32_t periodS)
+{
+    validate();
+    uint32_t maxS = periodS < JITTER_MAX_WINDOW_S ? periodS : JITTER_MAX_WINDOW_S;
+    return WakeJitter::window(jitter.data, JITTER_WINDOW_S, maxS);
+}
+
+/**
+ * Offset of this node in a window
+ */
+uint32_t jitter_offset(const char* nodeName, uint32_t windowS)
+{
+    uint32_t offsetS = WakeJitter::offset(WakeJitter::nodeHash(ESP.getEfuseMac(), nodeName), windowS);
+    LOGD("[Jitter] Offset %lu s of %lu s", (unsigned long)offsetS, (unsigned long)windowS);
+    return offsetS;
+}
+
+/**
+ * History kept in RTC memory
+ */
+const WakeJitter::State& jitter_state()
+{
+    validate();
+    return jitter.data;
+}
+#endif
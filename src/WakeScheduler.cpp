@@ -0,0 +1,255 @@
+#include "WakeScheduler.h"
+#include "Config.h"
+#include "Log.h"
+#include "MemoryProbe.h"
+
+/**
+ * Constructor
+ */
+WakeScheduler::WakeScheduler()
+    : count(0),
+      lastInline(-1),
+      doneBits(nullptr)
+{
+}
+
+/**
+ * Add a job
+ */
+int WakeScheduler::add(const char* name, Job job, void* context, uint32_t dependsOn, BaseType_t core)
+{
+    int id = addPhase(name, job, context, dependsOn);
+    if (id >= 0) {
+        phases[id].core = core;
+    }
+    return id;
+}
+
+/**
+ * Start all added jobs
+ */
+bool WakeScheduler::start()
+{
+    bool ok = true;
+    for (int i = 0; i < count; i++) {
+        Phase& phase = phases[i];
+        if (!phase.job || phase.started) {
+            continue;
+        }
+        phase.started = true;
+        if (xTaskCreatePinnedToCore(jobTask, phase.name, WAKE_TASK_STACK_SIZE, &phase, 1, nullptr, phase.core) != pdPASS) {
+            LOGW("[Wake] Failed to start %s task, running inline", phase.name);
+            run(phase);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/**
+ * Wait for a phase to finish
+ */
+bool WakeScheduler::join(int id, unsigned long timeoutMs)
+{
+    if (id < 0 || id >= count) {
+        return false;
+    }
+    
+    unsigned long startTime = millis();
+    EventBits_t bits = xEventGroupWaitBits(doneBits, bit(id), pdFALSE, pdTRUE, pdMS_TO_TICKS(timeoutMs));
+    phases[id].joinMs += millis() - startTime;
+    
+    if (!(bits & bit(id))) {
+        LOGW("[Wake] %s not done after %lu ms", phases[id].name, timeoutMs);
+        return false;
+    }
+    return phases[id].ok;
+}
+
+/**
+ * Begin a phase run on the calling task
+ */
+int WakeScheduler::begin(const char* name, uint32_t dependsOn)
+{
+    if (lastInline >= 0) {
+        dependsOn |= bit(lastInline);
+    }
+    int id = addPhase(name, nullptr, nullptr, dependsOn);
+    if (id < 0) {
+        return -1;
+    }
+    
+    // The previous inline phase ran on this task, so only jobs can be pending
+    uint32_t pending = lastInline >= 0 ? dependsOn & ~bit(lastInline) : dependsOn;
+    if (pending) {
+        xEventGroupWaitBits(doneBits, pending, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    lastInline = id;
+    phases[id].startMs = millis();
+    return id;
+}
+
+/**
+ * Add a phase run elsewhere
+ */
+int WakeScheduler::track(const char* name, uint32_t dependsOn)
+{
+    return addPhase(name, nullptr, nullptr, dependsOn);
+}
+
+/**
+ * Mark a tracked phase as started
+ */
+void WakeScheduler::enter(int id)
+{
+    if (id >= 0 && id < count) {
+        phases[id].startMs = millis();
+    }
+}
+
+/**
+ * End an inline or tracked phase
+ */
+void WakeScheduler::end(int id, bool ok)
+{
+    if (id < 0 || id >= count) {
+        return;
+    }
+    Phase& phase = phases[id];
+    phase.endMs = millis();
+    phase.ok = ok;
+    phase.done = true;
+    memory_probe_sample(phase.name);
+    xEventGroupSetBits(doneBits, bit(id));
+}
+
+/**
+ * Print the phase timeline and the critical path
+ */
+void WakeScheduler::report() const
+{
+    LOGD("[Wake] phase        start    end  took  join");
+    for (int i = 0; i < count; i++) {
+        const Phase& phase = phases[i];
+        if (phase.done) {
+            LOGD("[Wake] %-10s %6lu %6lu %5lu %5lu%s", phase.name, phase.startMs, phase.endMs,
+                 phase.endMs - phase.startMs, phase.joinMs, phase.ok ? "" : " failed");
+        } else {
+            LOGD("[Wake] %-10s %6lu      -     -     -", phase.name, phase.startMs);
+        }
+    }
+    
+    // Walk back from the phase that finished last along the dependencies
+    // that released each phase
+    int last = -1;
+    for (int i = 0; i < count; i++) {
+        if (phases[i].done && (last < 0 || phases[i].endMs > phases[last].endMs)) {
+            last = i;
+        }
+    }
+    if (last < 0) {
+        return;
+    }
+    
+    int path[MAX_PHASES];
+    int length = 0;
+    for (int id = last; id >= 0 && length < MAX_PHASES; id = latestDependency(id)) {
+        path[length++] = id;
+    }
+    
+    String line;
+    for (int i = length - 1; i >= 0; i--) {
+        const Phase& phase = phases[path[i]];
+        line += phase.name;
+        line += " ";
+        line += String(phase.endMs - phase.startMs);
+        if (i > 0) {
+            line += " -> ";
+        }
+    }
+    LOGI("[Wake] critical path (done at %lu ms): %s", criticalPathMs(), line.c_str());
+}
+
+/**
+ * End time of the critical path
+ */
+unsigned long WakeScheduler::criticalPathMs() const
+{
+    unsigned long last = 0;
+    for (int i = 0; i < count; i++) {
+        if (phases[i].done && phases[i].endMs > last) {
+            last = phases[i].endMs;
+        }
+    }
+    return last;
+}
+
+/**
+ * Add a phase to the table
+ */
+int WakeScheduler::addPhase(const char* name, Job job, void* context, uint32_t dependsOn)
+{
+    if (count >= MAX_PHASES) {
+        LOGW("[Wake] Too many phases, %s not tracked", name);
+        return -1;
+    }
+    if (!doneBits) {
+        doneBits = xEventGroupCreate();
+    }
+    
+    Phase& phase = phases[count];
+    phase.name = name;
+    phase.job = job;
+    phase.context = context;
+    phase.dependsOn = dependsOn;
+    phase.core = tskNO_AFFINITY;
+    phase.startMs = 0;
+    phase.endMs = 0;
+    phase.joinMs = 0;
+    phase.ok = false;
+    phase.started = false;
+    phase.done = false;
+    phase.owner = this;
+    return count++;
+}
+
+/**
+ * Run a job once its dependencies are done
+ */
+void WakeScheduler::run(Phase& phase)
+{
+    if (phase.dependsOn) {
+        xEventGroupWaitBits(doneBits, phase.dependsOn, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    phase.startMs = millis();
+    phase.ok = phase.job(phase.context);
+    phase.endMs = millis();
+    phase.done = true;
+    memory_probe_sample(phase.name);
+    xEventGroupSetBits(doneBits, bit(&phase - phases));
+}
+
+/**
+ * Job task body
+ */
+void WakeScheduler::jobTask(void* param)
+{
+    Phase* phase = static_cast<Phase*>(param);
+    phase->owner->run(*phase);
+    vTaskDelete(nullptr);
+}
+
+/**
+ * Dependency of a phase that finished last
+ */
+int WakeScheduler::latestDependency(int id) const
+{
+    int latest = -1;
+    for (int i = 0; i < count; i++) {
+        if ((phases[id].dependsOn & bit(i)) && phases[i].done &&
+            (latest < 0 || phases[i].endMs > phases[latest].endMs)) {
+            latest = i;
+        }
+    }
+    return latest;
+}
@@ -0,0 +1,346 @@
+#include "WallClock.h"
+#include <string.h>
+#include <math.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include <time.h>
+#include <sys/time.h>
+#include <esp_sntp.h>
+#include "RtcStore.h"
+#include "Log.h"
+#endif
+
+namespace {
+    int64_t floorDiv(int64_t a, int64_t b)
+    {
+        int64_t q = a / b;
+        return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+    }
+}
+
+/**
+ * Fresh state: clock not set, no drift estimate
+ */
+void WallClock::reset(ClockState& state)
+{
+    memset(&state, 0, sizeof(state));
+    state.source = CLOCK_UNSET;
+}
+
+/**
+ * Seconds to add to the clock after a deep sleep
+ */
+int64_t WallClock::sleepCorrection(const ClockState& state, int64_t now)
+{
+    if (state.sleptAt <= 0 || now <= state.sleptAt) {
+        return 0;
+    }
+    return (int64_t)llround((double)(now - state.sleptAt) * state.drift);
+}
+
+/**
+ * Record a time reference and refine the drift estimate
+ */
+bool WallClock::sync(ClockState& state, int64_t measured, int64_t actual, ClockSource source)
+{
+    if (source == CLOCK_PAYLOAD) {
+        if (state.source == CLOCK_SNTP) {
+            return false;
+        }
+        if (measured >= actual) {
+            // Consistent with the publish time; enough for an unset clock
+            // that survived a reset
+            if (state.source == CLOCK_UNSET) {
+                state.source = CLOCK_PAYLOAD;
+            }
+            return false;
+        }
+    }
+    
+    // The error left after the corrections since the last sync is what the
+    // estimate is still off by; only measured between two server syncs (a
+    // publish time is late by an unknown data age)
+    int64_t elapsed = measured - state.syncedAt;
+    if (source == CLOCK_SNTP && state.source == CLOCK_SNTP && state.syncedAt > 0 && elapsed >= CLOCK_DRIFT_MIN_S) {
+        float residual = (float)(actual - measured) / (float)elapsed;
+        float drift = state.drift + CLOCK_DRIFT_WEIGHT * residual;
+        state.drift = drift < -CLOCK_DRIFT_MAX ? -CLOCK_DRIFT_MAX : (drift > CLOCK_DRIFT_MAX ? CLOCK_DRIFT_MAX : drift);
+        state.settled = fabsf(residual) <= CLOCK_DRIFT_SETTLED;
+    }
+    
+    state.syncedAt = actual;
+    state.source = source;
+    if (state.syncs < UINT16_MAX) {
+        state.syncs++;
+    }
+    return true;
+}
+
+/**
+ * Whether to start an SNTP sync this wake
+ */
+bool WallClock::syncDue(const ClockState& state, int64_t now)
+{
+    if (state.source != CLOCK_SNTP) {
+        return true;
+    }
+    int64_t since = now - state.syncedAt;
+    return since >= CLOCK_RESYNC_HOURS * 3600LL || (!state.settled && since >= CLOCK_DRIFT_MIN_S);
+}
+
+/**
+ * Sleep until the wake slot nearest now + sleepS
+ */
+uint32_t WallClock::alignedSleep(const ClockState& state, int64_t now, uint32_t sleepS, const WakeCadence& cadence)
+{
+    if (sleepS == 0) {
+        return sleepS;
+    }
+    
+    int64_t period = cadence.periodS ? cadence.periodS : sleepS;
+    int64_t wake;
+    if (state.source == CLOCK_SNTP) {
+        // Slots follow the publisher when its phase is known, else a grid of
+        // the sleep interval from the epoch; both shifted by the node's offset
+        int64_t slot = cadence.offsetS;
+        if (cadence.periodS && state.lastPublish > 0) {
+            slot += state.lastPublish + cadence.delayS;
+        }
+        wake = slot + floorDiv(now + sleepS - slot + period / 2, period) * period;
+    } else if (!state.shifted) {
+        // A clock set from publish times reads behind by the data age it was
+        // set with, so slots planned on it land at random in the hour. The
+        // offset shifts the phase of the free-running wakes once instead.
+        wake = now + sleepS + cadence.offsetS;
+    } else {
+        return sleepS;
+    }
+    
+    int64_t earliest = now + cadence.minS;
+    int64_t latest = now + cadence.maxS;
+    while (wake < earliest) {
+        wake += period;
+    }
+    while (wake > latest && wake - period >= earliest) {
+        wake -= period;
+    }
+    return (uint32_t)(wake - now);
+}
+
+/**
+ * Sleep timer request for a sleep of sleepS seconds of true time
+ */
+uint32_t WallClock::timerSleep(const ClockState& state, uint32_t sleepS)
+{
+    uint32_t timer = (uint32_t)lround(sleepS / (1.0 + state.drift));
+    return timer > 0 ? timer : 1;
+}
+
+/**
+ * Name of a clock source
+ */
+const char* WallClock::sourceName(uint8_t source)
+{
+    switch (source) {
+        case CLOCK_PAYLOAD: return "payload";
+        case CLOCK_SNTP:    return "sntp";
+        default:            return "unset";
+    }
+}
+
+#if defined(ARDUINO)
+namespace {
+    const uint32_t CLOCK_MAGIC = 0x434c4b31;  // "CLK1"
+    const uint16_t CLOCK_VERSION = 2;
+    
+    // RTC only: after a power loss the times kept are meaningless
+    RTC_DATA_ATTR RtcRecord<ClockState> wallClock;
+    
+    // SNTP result, handed from the lwIP task to clock_update()
+    volatile bool syncPending = false;
+    volatile int64_t syncMeasured = 0;
+    volatile int64_t syncActual = 0;
+    
+    int64_t now()
+    {
+        return (int64_t)time(nullptr);
+    }
+    
+    void setClock(int64_t seconds)
+    {
+        struct timeval tv;
+        tv.tv_sec = (time_t)seconds;
+        tv.tv_usec = 0;
+        settimeofday(&tv, nullptr);
+    }
+    
+    bool valid()
+    {
+        const ClockState& state = wallClock.data;
+        return rtc_store_open(wallClock, CLOCK_MAGIC, CLOCK_VERSION) && state.source <= CLOCK_SNTP && state.settled <= 1 &&
+               state.shifted <= 1 && isfinite(state.drift) && fabsf(state.drift) <= CLOCK_DRIFT_MAX;
+    }
+}
+
+/**
+ * SNTP result (lwIP task)
+ * Replaces the IDF default, which only sets the time, so the clock reading
+ * just before the update is known.
+ */
+extern "C" void sntp_sync_time(struct timeval* tv)
+{
+    syncMeasured = now();
+    settimeofday(tv, nullptr);
+    syncActual = tv->tv_sec;
+    syncPending = true;
+    sntp_set_sync_status(SNTP_SYNC_STATUS_COMPLETED);
+}
+
+/**
+ * Restore the state kept in RTC memory and correct the time slept
+ */
+void clock_begin(const char* timezone)
+{
+    if (!valid()) {
+        WallClock::reset(wallClock.data);
+    }
+    ClockState& state = wallClock.data;
+    
+    setenv("TZ", timezone, 1);
+    tzset();
+    
+    // The time survives deep sleep but not a power cycle
+    if (now() < CLOCK_VALID_AFTER) {
+        state.source = CLOCK_UNSET;
+    } else if (state.source != CLOCK_UNSET) {
+        int64_t correction = WallClock::sleepCorrection(state, now());
+        if (correction != 0) {
+            setClock(now() + correction);
+        }
+        LOGD("[Clock] %s time, %+lld s drift correction (%.0f ppm)", WallClock::sourceName(state.source),
+             (long long)correction, state.drift * 1e6f);
+    }
+    state.sleptAt = 0;
+}
+
+/**
+ * Start an SNTP sync if the clock is unset or due for one
+ */
+void clock_start_sync()
+{
+    if (!WallClock::syncDue(wallClock.data, now())) {
+        return;
+    }
+    
+    LOGD("[Clock] SNTP sync with %s", CLOCK_NTP_SERVER);
+    if (sntp_enabled()) {
+        sntp_stop();
+    }
+    sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    sntp_setservername(0, (char*)CLOCK_NTP_SERVER);
+    sntp_init();
+}
+
+/**
+ * Publish time of the received payload
+ */
+void clock_from_payload(uint32_t timestamp)
+{
+    if (timestamp < CLOCK_VALID_AFTER) {
+        return;
+    }
+    ClockState& state = wallClock.data;
+    state.lastPublish = timestamp;
+    
+    // The payload was published before it was received: a lower bound only
+    int64_t measured = now();
+    if (WallClock::sync(state, measured, timestamp, CLOCK_PAYLOAD)) {
+        setClock(timestamp);
+        LOGI("[Clock] Set from the payload publish time, %lld s later (drift %.0f ppm)",
+             (long long)(timestamp - measured), state.drift * 1e6f);
+    }
+}
+
+/**
+ * Fold a completed SNTP sync into the state
+ */
+void clock_update()
+{
+    if (!syncPending) {
+        return;
+    }
+    syncPending = false;
+    
+    int64_t measured = syncMeasured;
+    int64_t actual = syncActual;
+    WallClock::sync(wallClock.data, measured, actual, CLOCK_SNTP);
+    LOGI("[Clock] SNTP sync: clock was %+lld s off, drift %.0f ppm", (long long)(actual - measured),
+         wallClock.data.drift * 1e6f);
+}
+
+/**
+ * Local time of day in minutes
+ */
+int clock_minute_of_day()
+{
+    if (wallClock.data.source == CLOCK_UNSET) {
+        return -1;
+    }
+    time_t t = time(nullptr);
+    struct tm local;
+    localtime_r(&t, &local);
+    return local.tm_hour * 60 + local.tm_min;
+}
+
+/**
+ * Align the chosen sleep to the publisher
+ */
+uint32_t clock_plan_sleep(uint32_t sleepS, const WakeCadence& cadence)
+{
+    clock_update();
+    ClockState& state = wallClock.data;
+    int64_t t = now();
+    
+    uint32_t seconds = WallClock::alignedSleep(state, t, sleepS, cadence);
+    state.nextWake = state.source != CLOCK_UNSET ? t + seconds : 0;
+    if (state.source != CLOCK_SNTP && sleepS > 0) {
+        state.shifted = 1;  // Free-running wakes keep the phase from here
+    }
+    if (seconds != sleepS) {
+        LOGI("[Clock] Sleep of %lu s moved to %lu s, to the node's wake slot",
+             (unsigned long)sleepS, (unsigned long)seconds);
+    }
+    return seconds;
+}
+
+/**
+ * Sleep timer request for the planned wake; remembers when sleep began
+ */
+uint32_t clock_sleep_timer(uint32_t sleepS)
+{
+    clock_update();  // A late SNTP answer would be lost in deep sleep
+    ClockState& state = wallClock.data;
+    if (state.source == CLOCK_UNSET || state.nextWake == 0) {
+        state.sleptAt = 0;
+        return sleepS;
+    }
+    
+    // Time spent since planning (radio off, panel hibernate) is taken off
+    int64_t t = now();
+    int64_t remaining = state.nextWake - t;
+    state.sleptAt = t;
+    uint32_t timer = WallClock::timerSleep(state, remaining > 0 ? (uint32_t)remaining : 1);
+    LOGD("[Clock] Sleep timer %lu s for a wake in %lld s (drift %.0f ppm)",
+         (unsigned long)timer, (long long)remaining, state.drift * 1e6f);
+    return timer;
+}
+
+/**
+ * State kept in RTC memory
+ */
+const ClockState& clock_state()
+{
+    return wallClock.data;
+}
+#endif
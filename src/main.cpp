@@ -6,9 +6,10 @@
  * - WiFi configuration portal with custom parameters
  * - MQTT subscription for plant data
  * - Persistent settings storage (Preferences)
- * - Deep sleep with configurable duration
+ * - Deep sleep adjusted to battery, charging and data changes
  * - Deep sleep disable via GPIO0 (for configuration)
  * - Battery monitoring and LWT publishing
+ * - Always-on mode (mains powered): live re-render on new data
  *
  * Hardware:
  *  - Display: Waveshare 4.2" e-Paper Rev V2 (400x300, Black/White/Red)
@@ -28,40 +29,263 @@
 #include "NetworkManager.h"
 #include "PowerManager.h"
 #include "PlantMonitor.h"
+#include "PayloadIngest.h"
+#include "DashboardCache.h"
+#include "TopicAggregator.h"
+#include "WakeScheduler.h"
+#include "DisplayTask.h"
 #include "OtaManager.h"
+#include "LiveDashboard.h"
+#include "PhaseTrace.h"
+#include "MemoryProbe.h"
+#include "TelemetryRing.h"
+#include "Log.h"
+#include "EnergyModel.h"
+#include "SleepScheduler.h"
+#include "WallClock.h"
+#include "WakeJitter.h"
+#include "RtcStore.h"
 
 // Global instances
 PlantMonitor monitor;
 NetworkManager network;
 PowerManager power;
 
+// Dashboard content (cached across deep sleep) and the payload received
+// this wake, kept off the loop task stack
+DashboardModel dashboard;
+DashboardModel payload;
+PayloadIngest ingest(payload);
+
+// Per-sensor readings when the configured topic is a wildcard
+TopicAggregator aggregator;
+
+// Hardware bring-up of this wake
+WakeScheduler wake;
+
+// Panel driver, run off the loop task
+DisplayTask displayTask;
+
+// Always-on mode: messages are merged into the dashboard as they arrive
+// (payload is the parse scratch once setup() is done) and loop() renders
+LiveDashboard live(dashboard, payload);
+DashboardModel liveFrame;           // Model being rendered by the display task
+bool alwaysOn = false;
+String liveNode;
+String liveTopic;
+String liveStatusTopic;
+String liveOtaTopic;
+int liveBatteryPercent = 0;
+uint32_t liveRender = 0;            // Ticket of the last render
+uint32_t liveCachedRenders = 0;     // Renders when the cache was last saved
+unsigned long lastBatteryPoll = 0;
+unsigned long lastTelemetry = 0;
+volatile bool otaPending = false;
+
+// Retained status (LWT and always-on telemetry), kept off the loop task
+// stack: about 35 top-level fields and the stack_free object, whose task
+// names are copied
+const size_t STATUS_JSON_CAPACITY = JSON_OBJECT_SIZE(40) + JSON_OBJECT_SIZE(MEMORY_PROBE_TASKS) +
+                                    MEMORY_PROBE_TASKS * sizeof(MemoryProbeStack::task);
+StaticJsonDocument<STATUS_JSON_CAPACITY> statusDoc;
+
+/**
+ * Collect a sensor message (wildcard topic mode)
+ */
+void onSensorMessage(const char* topic, const uint8_t* data, unsigned int length, void* context)
+{
+    static_cast<TopicAggregator*>(context)->add(topic, data, length);
+}
+
+/**
+ * Message handler of the always-on mode (network task)
+ */
+void onLiveMessage(const char* topic, const uint8_t* data, unsigned int length, void* context)
+{
+    if (liveOtaTopic == topic) {
+        // Installed by the next boot; the empty message is our own clear
+        if (length > 0) {
+            otaPending = true;
+        }
+        return;
+    }
+    LiveDashboard::onMessage(topic, data, length, context);
+}
+
+/**
+ * Status fields of the LWT and the always-on telemetry
+ */
+void fillStatus(JsonDocument& doc, int batteryPercent, int sleepHours)
+{
+    doc["battery_percentage"] = batteryPercent;
+    doc["battery_voltage"] = power.getBatteryVoltage();
+    doc["charge_rate"] = power.getChargeRate();
+    doc["battery_sensor_present"] = power.isBatterySensorPresent();
+    doc["i2c_us"] = power.getI2cMicros();
+    doc["rssi"] = WiFi.RSSI();
+    doc["sleep_time"] = sleepHours;
+    doc["firmware_version"] = FIRMWARE_VERSION;
+    doc["free_heap"] = ESP.getFreeHeap();
+    doc["always_on"] = alwaysOn;
+}
+
+/**
+ * Lowest heap and stack headroom seen so far
+ */
+void fillMemory(JsonDocument& doc)
+{
+    const MemoryProbeReport& memory = memory_probe_report();
+    doc["heap_min"] = memory.heapMin;
+    doc["heap_min_phase"] = memory.heapMinPhase;
+    doc["heap_min_ever"] = memory.heapMinEver;
+    doc["heap_block_min"] = memory.blockMin;
+    JsonObject stackFree = doc.createNestedObject("stack_free");
+    for (int i = 0; i < memory.stackCount; i++) {
+        stackFree[memory.stacks[i].task] = memory.stacks[i].minFree;
+    }
+}
+
+/**
+ * Modelled charge of the last cycle and the battery life it projects
+ */
+void fillEnergy(JsonDocument& doc, int batteryPercent)
+{
+    const EnergyState& energy = energy_state();
+    if (energy.cycles == 0) {
+        return;
+    }
+    doc["energy_mah"] = roundf(energy.cycleMah * energy.scale * 1000) / 1000;
+    doc["energy_ma"] = roundf(EnergyModel::averageMa(energy) * 1000) / 1000;
+    doc["energy_scale"] = roundf(energy.scale * 100) / 100;
+    doc["battery_days"] = roundf(EnergyModel::projectedDays(energy, batteryPercent, ENERGY_BATTERY_MAH) * 10) / 10;
+}
+
+/**
+ * Sleep interval and limits from the settings
+ */
+SleepScheduler::Bounds sleepBounds(int sleepHours)
+{
+    SleepScheduler::Bounds bounds;
+    bounds.baseMinutes = (sleepHours > 0 ? sleepHours : DEFAULT_SLEEP_HOURS) * 60;
+    bounds.minMinutes = settings_get_int("sleep_min", SLEEP_MIN_MINUTES);
+    bounds.maxMinutes = settings_get_int("sleep_max", SLEEP_MAX_MINUTES);
+    bounds.quietStart = settings_get_int("quiet_start", SLEEP_QUIET_START);
+    bounds.quietEnd = settings_get_int("quiet_end", SLEEP_QUIET_END);
+    return bounds;
+}
+
+/**
+ * Publisher cadence from the settings, with this node's offset: spread
+ * after the publish slot, or over the whole sleep without a publisher
+ */
+WakeCadence wakeCadence(const SleepScheduler::Bounds& bounds, uint32_t sleepS, const char* nodeName)
+{
+    WakeCadence cadence;
+    cadence.periodS = settings_get_int("publish_period", CLOCK_PUBLISH_PERIOD_MIN) * 60;
+    cadence.delayS = CLOCK_PUBLISH_DELAY_S;
+    cadence.offsetS = jitter_offset(nodeName, cadence.periodS ? jitter_window(cadence.periodS) : sleepS);
+    cadence.minS = bounds.minMinutes * 60;
+    cadence.maxS = bounds.maxMinutes * 60;
+    return cadence;
+}
+
+/**
+ * Wake pipeline jobs, run concurrently by the wake scheduler
+ */
+bool wakeWiFi(void* context)
+{
+    network.startWiFi();
+    return network.waitFor(NET_BIT_WIFI, WIFI_CONNECT_TIMEOUT);
+}
+
+bool wakeBattery(void* context)
+{
+    TRACE_SCOPE(TRACE_BATTERY);
+    return power.readBattery().present;
+}
+
+/**
+ * Display task executor, traced as wake phases
+ */
+void runDisplayCommand(const DisplayCommand& command, void* context)
+{
+    wake.enter(command.phase);
+    switch (command.type) {
+        case DISPLAY_INIT:
+            monitor.init();
+            break;
+        case DISPLAY_PRERENDER:
+            monitor.prerender(command.batteryPercent);
+            break;
+        case DISPLAY_RENDER:
+            monitor.updateDisplay(*command.model, command.batteryPercent);
+            break;
+        case DISPLAY_UPGRADE_SCREEN:
+            monitor.showUpgradeScreen();
+            break;
+        case DISPLAY_HIBERNATE:
+            monitor.sleep();
+            break;
+    }
+    wake.end(command.phase);
+}
+
+/**
+ * Queue a display command, running it inline if the display task is unavailable
+ * @return Ticket for waitDisplay()
+ */
+uint32_t postDisplay(DisplayCommandType type, int phase, const DashboardModel* model = nullptr, int batteryPercent = 0)
+{
+    DisplayCommand command = {type, model, batteryPercent, phase};
+    uint32_t ticket = displayTask.post(command);
+    if (ticket == 0) {
+        LOGW("Display task unavailable, running command inline");
+        runDisplayCommand(command, nullptr);
+    }
+    return ticket;
+}
+
+/**
+ * Wait for a display command
+ */
+bool waitDisplay(uint32_t ticket)
+{
+    return ticket == 0 || displayTask.wait(ticket, DISPLAY_COMMAND_TIMEOUT);
+}
+
 void setup()
 {
+#if PHASE_TRACE
+    trace_init();
+#endif
     Serial.begin(115200);
     // Set proper line ending mode for clean serial output
     Serial.setDebugOutput(false);
+    log_init();
     
-    Serial.println("\n=== Plant Moisture Monitor ===\n");
-    Serial.println("Firmware: WiFi + MQTT + Deep Sleep");
-    Serial.println();
+    LOGI("\n=== Plant Moisture Monitor ===\n");
+    LOGI("Firmware: WiFi + MQTT + Deep Sleep");
     
     // Give pins time to stabilize after boot
     delay(100);
     
     // Initialize settings system
-    settings_init();
+    {
+        TRACE_SCOPE(TRACE_SETTINGS);
+        settings_init();
+    }
     
     // Check if deep sleep is disabled (GPIO4 LOW) - check EARLY before I2C init
     bool deepSleepDisabled = power.isDeepSleepDisabled();
-    Serial.printf("\nGPIO4 state: %s\r\n", deepSleepDisabled ? "LOW (config mode)" : "HIGH (normal mode)");
-    Serial.printf("Config needed: %s\r\n\n", deepSleepDisabled ? "YES (GPIO4 forced)" : "checking settings...");
-    
-    // Initialize battery sensor after Serial is ready
-    power.initBatterySensor();
+    LOGI("\nGPIO4 state: %s", deepSleepDisabled ? "LOW (config mode)" : "HIGH (normal mode)");
+    LOGI("Config needed: %s", deepSleepDisabled ? "YES (GPIO4 forced)" : "checking settings...");
     
     // Get node name
     String nodeName = settings_get_string("node_name", DEFAULT_NODE_NAME);
-    Serial.printf("Node: %s\r\n", nodeName.c_str());
+    LOGI("Node: %s", nodeName.c_str());
+    
+    // Time kept through deep sleep, corrected for the sleep clock's drift
+    clock_begin(settings_get_string("timezone", CLOCK_TIMEZONE).c_str());
     
     // Check if we have configuration
     // WiFi credentials are stored by WiFiManager, we just check our custom settings
@@ -76,9 +300,9 @@ void setup()
     // Start config portal if needed or if deep sleep is disabled
     if (deepSleepDisabled || needsConfig) {
         if (deepSleepDisabled) {
-            Serial.println("Deep sleep disabled - entering config mode");
+            LOGI("Deep sleep disabled - entering config mode");
         } else {
-            Serial.println("No configuration found - entering config mode");
+            LOGI("No configuration found - entering config mode");
         }
         
         // Generate a random password for the AP
@@ -89,8 +313,8 @@ void setup()
             apPassword += charset[random(0, sizeof(charset) - 1)];
         }
         
-        Serial.printf("AP SSID: %s\r\n", nodeName.c_str());
-        Serial.printf("AP Password: %s\r\n", apPassword.c_str());
+        LOGI("AP SSID: %s", nodeName.c_str());
+        LOGI("AP Password: %s", apPassword.c_str());
         
         // Initialize and show configuration screen on e-paper display
         monitor.init();
@@ -98,44 +322,64 @@ void setup()
         
         // Start config portal with generated password
         if (network.startConfigPortal(nodeName.c_str(), apPassword.c_str(), 300)) {
-            Serial.println("Configuration saved! Restarting...");
+            LOGI("Configuration saved! Restarting...");
             delay(1000);
+            log_flush(LOG_FLUSH_TIMEOUT_MS);
             ESP.restart();
         } else {
-            Serial.println("Config portal timeout or cancelled");
+            LOGW("Config portal timeout or cancelled");
+            log_flush(LOG_FLUSH_TIMEOUT_MS);
             ESP.restart();
         }
     }
     
-    Serial.println("\n=== Starting Normal Operation ===\n");
+    LOGI("\n=== Starting Normal Operation ===\n");
     
-    // Connect to WiFi
-    if (!network.connectWiFi()) {
-        Serial.println("WiFi connection failed! Restarting...");
-        ESP.restart();
-    }
+    // The cached dashboard is the best guess of this wake's header
+    bool cached = dashboard_cache_load(dashboard);
+    monitor.expect(dashboard);
     
-    // Get battery info for LWT
-    float batteryVoltage = power.getBatteryVoltage();
+    // Panel work runs on the display task, in order, while setup() goes on
+    // with the network
+    displayTask.begin(runDisplayCommand, nullptr);
+    int displayPhase = wake.track("display");
+    postDisplay(DISPLAY_INIT, displayPhase);
+    
+    // WiFi association and the fuel gauge snapshot start meanwhile; each is joined
+    // where its result is first needed
+    int wifiPhase = wake.add("wifi", wakeWiFi, nullptr);
+    int batteryPhase = wake.add("battery", wakeBattery, nullptr);
+    wake.start();
+    
+    // Battery sensor absence is not an error (fallback values are used)
+    wake.join(batteryPhase, WAKE_JOIN_TIMEOUT);
+    
+    // Battery level shown in the header
     int batteryPercent = power.getBatteryPercentage();
-    float chargeRate = power.getChargeRate();
-    bool batterySensorPresent = power.isBatterySensorPresent();
     
-    // Get system info for LWT
-    int wifiRssi = WiFi.RSSI();
+    // Header is pre-rendered while the network is busy
+    int prerenderPhase = wake.track("prerender", WakeScheduler::bit(batteryPhase) | WakeScheduler::bit(displayPhase));
+    postDisplay(DISPLAY_PRERENDER, prerenderPhase, nullptr, batteryPercent);
+    
+    if (!wake.join(wifiPhase, WIFI_CONNECT_TIMEOUT + WAKE_JOIN_TIMEOUT)) {
+        LOGE("WiFi connection failed! Restarting...");
+        log_flush(LOG_FLUSH_TIMEOUT_MS);
+        ESP.restart();
+    }
+    LOGI("WiFi connected to: %s", WiFi.SSID().c_str());
+    clock_start_sync();
+    
+    // Mains powered displays keep the session open instead of sleeping
     int sleepHours = settings_get_int("sleep_hours", DEFAULT_SLEEP_HOURS);
-    uint32_t freeHeap = ESP.getFreeHeap();
+    alwaysOn = settings_get_bool("always_on", false);
+    if (!alwaysOn) {
+        energy_begin(batteryPercent, power.isBatterySensorPresent());
+    }
     
     // Prepare LWT message
-    StaticJsonDocument<384> lwtDoc;
-    lwtDoc["battery_percentage"] = batteryPercent;
-    lwtDoc["battery_voltage"] = batteryVoltage;
-    lwtDoc["charge_rate"] = chargeRate;
-    lwtDoc["battery_sensor_present"] = batterySensorPresent;
-    lwtDoc["rssi"] = wifiRssi;
-    lwtDoc["sleep_time"] = sleepHours;
-    lwtDoc["firmware_version"] = FIRMWARE_VERSION;
-    lwtDoc["free_heap"] = freeHeap;
+    JsonDocument& lwtDoc = statusDoc;
+    lwtDoc.clear();
+    fillStatus(lwtDoc, batteryPercent, sleepHours);
     String lwtPayload;
     serializeJson(lwtDoc, lwtPayload);
     
@@ -144,123 +388,413 @@ void setup()
     network.setMQTTLastWill(lwtTopic.c_str(), lwtPayload.c_str());
     
     // Connect to MQTT
+    int mqttPhase = wake.begin("mqtt", WakeScheduler::bit(wifiPhase));
     String clientId = nodeName + "-" + String(ESP.getEfuseMac(), HEX);
-    if (!network.connectMQTT(clientId.c_str())) {
-        Serial.println("MQTT connection failed! Restarting...");
+    if (!network.startMQTT(clientId.c_str()) ||
+        !network.waitFor(NET_BIT_MQTT, MQTT_CONNECT_TIMEOUT)) {
+        LOGE("MQTT connection failed! Restarting...");
+        log_flush(LOG_FLUSH_TIMEOUT_MS);
         ESP.restart();
     }
+    wake.end(mqttPhase);
+    
+    // Connect latency tells whether the fleet's wakes need spreading further
+    unsigned long connectMs = millis() - wake.startedAt(wifiPhase);
+    if (!alwaysOn) {
+        jitter_observe(connectMs);
+    }
     
     // Check for OTA update first
+    int otaPhase = wake.begin("ota");
     String otaTopic = "displays/" + nodeName + "/rx";
-    Serial.printf("Checking for OTA update on: %s\r\n", otaTopic.c_str());
+    LOGI("Checking for OTA update on: %s", otaTopic.c_str());
     network.subscribeMQTT(otaTopic.c_str());
     
     String otaMessage = network.getLastRetainedMessage(5000);
     if (otaMessage.length() > 0) {
-        Serial.println("OTA update message received!");
+        LOGI("OTA update message received!");
         
         // Clear the retained message immediately
         network.publishMQTT(otaTopic.c_str(), "", true);
-        Serial.println("Cleared OTA retained message");
+        LOGD("Cleared OTA retained message");
         
-        // Initialize display and show upgrade screen
-        monitor.init();
-        monitor.showUpgradeScreen();
+        // Show upgrade screen while the update downloads
+        uint32_t upgradeScreen = postDisplay(DISPLAY_UPGRADE_SCREEN, -1);
         
         // Process OTA update
         OtaManager ota;
         if (ota.processUpdate(otaMessage)) {
-            Serial.println("OTA update successful - rebooting...");
+            LOGI("OTA update successful - rebooting...");
+            waitDisplay(upgradeScreen);
             delay(1000);
+            log_flush(LOG_FLUSH_TIMEOUT_MS);
             ESP.restart();
         } else {
-            Serial.println("OTA update failed - continuing normal operation");
-            // Display will be reinitialized below for normal operation
+            LOGW("OTA update failed - continuing normal operation");
+            // Dashboard is redrawn below
         }
     } else {
-        Serial.println("No OTA update pending");
+        LOGI("No OTA update pending");
     }
+    wake.end(otaPhase);
     
-    // Subscribe to configured topic
+    // Subscribe to configured topic; the branches below pick the model to show
+    int ingestPhase = wake.begin("ingest");
+    const DashboardModel* shown = nullptr;
+    bool dataReceived = false;  // shown holds readings, not a status screen
     String subscribeTopic = settings_get_string("mqtt_topic", "");
-    if (subscribeTopic.length() > 0) {
-        Serial.printf("Subscribing to: %s\r\n", subscribeTopic.c_str());
+    if (subscribeTopic.length() > 0 && TopicAggregator::isWildcard(subscribeTopic.c_str())) {
+        LOGI("Subscribing to sensor topics: %s", subscribeTopic.c_str());
         network.subscribeMQTT(subscribeTopic.c_str());
         
-        // Wait for retained message
-        Serial.println("Waiting for retained message...");
-        String message = network.getLastRetainedMessage(10000);
+        // One retained message per sensor, collected into a fixed table
+        aggregator.begin(subscribeTopic.c_str());
+        unsigned long ingestStart = millis();
+        network.collectRetainedMessages(onSensorMessage, &aggregator, AGGREGATE_WINDOW_MS, AGGREGATE_IDLE_MS);
+        unsigned long ingestMs = millis() - ingestStart;
+        {
+            TRACE_SCOPE(TRACE_PARSE);
+            aggregator.build(dashboard);
+        }
         
-        if (message.length() > 0) {
-            Serial.println("Received plant data from MQTT");
-            
-            // Parse JSON message
-            StaticJsonDocument<1024> doc;
-            DeserializationError error = deserializeJson(doc, message);
+        LOGI("Sensors: %u messages, %d plants, %u dropped, %u invalid in %lu ms",
+             aggregator.received, dashboard.plantCount, aggregator.dropped,
+             aggregator.invalid, ingestMs);
+        lwtDoc["sensors"] = aggregator.received;
+        lwtDoc["sensors_dropped"] = aggregator.dropped;
+        lwtDoc["ingest_ms"] = ingestMs;
+        
+        if (dashboard.plantCount > 0) {
+            // Next wake pre-renders the header of this dashboard
+            dashboard_cache_save(dashboard);
+            shown = &dashboard;
+            dataReceived = true;
+        } else {
+            LOGW("No sensor messages received");
+            payload.setStatus("Waiting...", "No Data");
+            shown = &payload;
+        }
+    } else if (subscribeTopic.length() > 0) {
+        // Every payload is written to the parser stream before its topic is
+        // known, so the OTA topic must not deliver into the dashboard payload
+        network.unsubscribeMQTT(otaTopic.c_str());
+        
+        LOGI("Subscribing to: %s", subscribeTopic.c_str());
+        network.subscribeMQTT(subscribeTopic.c_str());
+        
+        // Wait for retained message, parsed while it streams in
+        LOGD("Waiting for retained message...");
+        bool received = ingest.begin(nodeName.c_str()) &&
+                        network.streamRetainedMessage(subscribeTopic.c_str(), ingest, 10000) &&
+                        ingest.receivedBytes() > 0;
+        
+        if (received) {
+            LOGI("Received plant data from MQTT");
             
-            if (!error) {
-                // Initialize display before use
-                monitor.init();
+            // Wait for the parser to complete the payload model
+            if (ingest.finish()) {
+                clock_from_payload(payload.timestamp);
+                
+                // Snapshots replace the cached dashboard, deltas are merged into it
+                unsigned long mergeStart = micros();
+                bool applied = dashboard.applyUpdate(payload);
+                unsigned long mergeUs = micros() - mergeStart;
+                
+                LOGD("%s seq %lu (base %lu): %lu bytes, merged in %lu us",
+                     payload.delta ? "Delta" : "Snapshot",
+                     (unsigned long)payload.seq, (unsigned long)payload.base,
+                     (unsigned long)ingest.receivedBytes(), mergeUs);
+                
+                if (applied) {
+                    dashboard_cache_save(dashboard);
+                    dataReceived = true;
+                } else {
+                    // Delta against a state we do not have: ask the publisher
+                    // for a snapshot, which arrives as the next retained message
+                    LOGW("Delta base %lu does not match cached seq %lu, requesting snapshot",
+                         (unsigned long)payload.base, (unsigned long)dashboard.seq);
+                    String resyncTopic = "displays/" + nodeName + RESYNC_TOPIC_SUFFIX;
+                    String request = "{\"seq\":" + String(dashboard.seq) + "}";
+                    network.publishMQTT(resyncTopic.c_str(), request.c_str(), false);
+                    
+                    if (!cached) {
+                        dashboard.setStatus("Waiting...", "Resync");
+                    }
+                }
                 
                 // Update display with MQTT data
-                monitor.updateDisplay(doc, batteryPercent);
-                Serial.println("Display updated successfully!");
+                shown = &dashboard;
             } else {
-                Serial.printf("JSON parse error: %s\r\n", error.c_str());
-                Serial.println("Using fallback display message");
+                LOGW("Using fallback display message");
                 
                 // Fallback: show error on display
-                monitor.init();
-                
-                StaticJsonDocument<512> fallbackDoc;
-                fallbackDoc["updateDate"] = "ERROR";
-                JsonArray plants = fallbackDoc.createNestedArray("plants");
-                JsonObject plant = plants.createNestedObject();
-                plant["name"] = "JSON Error";
-                plant["moisture"] = 0;
-                
-                monitor.updateDisplay(fallbackDoc, batteryPercent);
+                payload.setStatus("ERROR", "JSON Error");
+                shown = &payload;
             }
         } else {
-            Serial.println("No retained message received");
+            LOGW("No retained message received");
+            ingest.finish();
             
             // Show "Waiting for data" message
-            monitor.init();
-            
-            StaticJsonDocument<512> fallbackDoc;
-            fallbackDoc["updateDate"] = "Waiting...";
-            JsonArray plants = fallbackDoc.createNestedArray("plants");
-            JsonObject plant = plants.createNestedObject();
-            plant["name"] = "No Data";
-            plant["moisture"] = 0;
-            
-            monitor.updateDisplay(fallbackDoc, batteryPercent);
+            payload.setStatus("Waiting...", "No Data");
+            shown = &payload;
         }
     } else {
-        Serial.println("No MQTT topic configured!");
+        LOGE("No MQTT topic configured!");
     }
+    wake.end(ingestPhase);
     
-    // Publish LWT (online status)
-    network.publishMQTT(lwtTopic.c_str(), lwtPayload.c_str(), true);
+    // How often the data changes sets the sleep duration
+    if (dataReceived && !alwaysOn) {
+        sleep_schedule_record(dashboard);
+    }
+    
+    // Render on the display task, then hibernate the panel; both are queued
+    // now so the hibernate does not wait for the network teardown
+    uint32_t rendered = 0;
+    if (shown) {
+        int renderPhase = wake.track("render", WakeScheduler::bit(prerenderPhase) | WakeScheduler::bit(ingestPhase));
+        rendered = postDisplay(DISPLAY_RENDER, renderPhase, shown, batteryPercent);
+    }
+    uint32_t hibernated = alwaysOn ? 0 : postDisplay(DISPLAY_HIBERNATE, -1);
+    
+    // Refresh statistics are needed for the LWT
+    if (shown) {
+        if (waitDisplay(rendered)) {
+            LOGI("Display updated successfully!");
+        } else {
+            LOGW("Display update timed out");
+        }
+    }
+    
+    // Where the wake latency went
+    wake.report();
+    lwtDoc["wake_ms"] = wake.criticalPathMs();
+    
+    // Add refresh statistics of this wake to the LWT
+    const PlantMonitor::RefreshStats& refreshStats = monitor.getRefreshStats();
+    lwtDoc["refresh"] = refreshStats.mode;
+    lwtDoc["spi_bytes"] = refreshStats.spiBytes;
+    lwtDoc["refresh_ms"] = refreshStats.refreshMs;
+    
+    // Memory headroom of this wake
+    memory_probe_sample("lwt");
+    memory_probe_print();
+    fillMemory(lwtDoc);
+    if (!alwaysOn) {
+        fillEnergy(lwtDoc, batteryPercent);
+    }
+    
+    // Next sleep from the battery, charging and how often the data changes,
+    // moved to shortly after the publisher's next slot
+    SleepScheduler::Decision nextSleep = {0, nullptr};
+    uint32_t sleepSeconds = 0;
+    if (!alwaysOn) {
+        clock_update();
+        SleepScheduler::Bounds bounds = sleepBounds(sleepHours);
+        SleepScheduler::Inputs inputs;
+        inputs.batteryPercent = batteryPercent;
+        inputs.gaugePresent = power.isBatterySensorPresent();
+        inputs.chargeRate = power.getChargeRate();
+        inputs.minuteOfDay = clock_minute_of_day();
+        nextSleep = sleep_schedule_next(bounds, inputs);
+        WakeCadence cadence = wakeCadence(bounds, nextSleep.minutes * 60UL, nodeName.c_str());
+        sleepSeconds = clock_plan_sleep(nextSleep.minutes * 60UL, cadence);
+        lwtDoc["sleep_min"] = (sleepSeconds + 30) / 60;
+        lwtDoc["sleep_reason"] = nextSleep.reason;
+        
+        const ClockState& clock = clock_state();
+        lwtDoc["clock"] = WallClock::sourceName(clock.source);
+        lwtDoc["drift_ppm"] = (int32_t)lroundf(clock.drift * 1e6f);
+        if (clock.nextWake > 0) {
+            lwtDoc["next_wake"] = (uint32_t)clock.nextWake;
+        }
+        lwtDoc["jitter_s"] = cadence.offsetS;
+        lwtDoc["connect_ms"] = jitter_state().connectMs;
+    }
+    lwtPayload = "";
+    serializeJson(lwtDoc, lwtPayload);
+    
+    // Metrics of this wake are batched in the telemetry ring; the batch and
+    // the retained status go out together every TELEMETRY_BATCH_WAKES wakes
+    bool publishStatus = true;
+    if (!alwaysOn) {
+        TelemetrySample sample;
+        sample.batteryVoltage = power.getBatteryVoltage();
+        sample.batteryPercent = batteryPercent;
+        sample.chargeRate = power.getChargeRate();
+        sample.rssi = WiFi.RSSI();
+        sample.wakeMs = millis();
+        sample.freeHeap = ESP.getFreeHeap();
+        sample.refresh = refreshStats.mode;
+        sample.sleepMinutes = (sleepSeconds + 30) / 60;
+        sample.i2cUs = power.getI2cMicros();
+        telemetry_record(sample);
+
+        publishStatus = telemetry_due();
+        String batch;
+        if (publishStatus && telemetry_batch_json(batch)) {
+            String telemetryTopic = "displays/" + nodeName + TELEMETRY_TOPIC_SUFFIX;
+            if (network.publishMQTT(telemetryTopic.c_str(), batch.c_str(), false)) {
+                telemetry_flushed();
+            }
+        }
+    }
     
-    // Put display to sleep
-    monitor.sleep();
+    // Publish LWT (online status)
+    if (publishStatus) {
+        network.publishMQTT(lwtTopic.c_str(), lwtPayload.c_str(), true);
+    }
+
+#if PHASE_TRACE
+    // Where the previous wake went, sleep preparation included
+    String trace;
+    if (trace_previous_json(trace)) {
+        String traceTopic = "displays/" + nodeName + TRACE_TOPIC_SUFFIX;
+        network.publishMQTT(traceTopic.c_str(), trace.c_str(), false);
+    }
+#endif
+
+#if LOG_CRASH_TAIL
+    // Last lines before a panic or watchdog reset, kept until the next crash
+    String crash;
+    if (log_crash_tail(crash)) {
+        String crashTopic = "displays/" + nodeName + LOG_CRASH_TOPIC_SUFFIX;
+        network.publishMQTT(crashTopic.c_str(), crash.c_str(), true);
+    }
+#endif
+
+    if (alwaysOn) {
+        // Stay connected; loop() renders new data and runs the timers
+        liveNode = nodeName;
+        liveTopic = subscribeTopic;
+        liveStatusTopic = lwtTopic;
+        liveOtaTopic = otaTopic;
+        liveBatteryPercent = batteryPercent;
+        power.keepGaugeAwake();
+        live.begin(liveNode.c_str(), TopicAggregator::isWildcard(liveTopic.c_str()) ? &aggregator : nullptr);
+        network.listen(onLiveMessage, &live);
+        network.subscribeMQTT(liveOtaTopic.c_str());  // Dropped while the payload streamed
+        lastBatteryPoll = lastTelemetry = millis();
+        LOGI("\n=== Always-On Mode: listening for updates ===\n");
+        return;
+    }
     
-    // Disconnect from MQTT and WiFi
+    // Disconnect from MQTT and WiFi while the panel hibernates
     network.disconnectMQTT();
     network.disconnectWiFi();
+    unsigned long radioOffMs = millis();
+    waitDisplay(hibernated);
+    
+    LOGI("\n=== Operation Complete ===\n");
+    LOGD("Loop task stack free (min): %u bytes", (unsigned)uxTaskGetStackHighWaterMark(NULL));
+    LOGI("Entering deep sleep for %lu s (%s)...", (unsigned long)sleepSeconds, nextSleep.reason);
+    LOGI("To enter config mode, connect GPIO4 to GND before reset");
     
-    Serial.println("\n=== Operation Complete ===\n");
-    Serial.printf("Entering deep sleep for %d hour(s)...\r\n", sleepHours);
-    Serial.println("To enter config mode, connect GPIO4 to GND before reset");
-    Serial.flush();
+    // Charge of this wake and the sleep that follows
+    EnergyPhases phases;
+    phases.awakeMs = millis() + ENERGY_BOOT_MS;
+    phases.radioMs = radioOffMs - wake.startedAt(wifiPhase);
+    phases.panelMs = refreshStats.refreshMs;
+    phases.lightSleepMs = 0;  // Not used by the firmware (yet)
+    phases.deepSleepS = sleepSeconds;
+    energy_account(phases);
+    uint32_t timerSeconds = clock_sleep_timer(sleepSeconds);
+    
+    // State kept across sleep; copied to flash now if the battery may not
+    // last until the next coalesced write
+    rtc_store_seal(power.isBatterySensorPresent() && batteryPercent <= SLEEP_CRITICAL_BATTERY_PCT);
+    log_flush(LOG_FLUSH_TIMEOUT_MS);
     
     // Enter deep sleep
-    power.enterDeepSleep(sleepHours);
+    power.enterDeepSleep(timerSeconds);
 }
 
 void loop()
 {
-    // Should never reach here due to deep sleep
-    delay(1000);
+    if (!alwaysOn) {
+        // Should never reach here due to deep sleep
+        delay(1000);
+        return;
+    }
+    
+    unsigned long now = millis();
+    uint32_t status = network.status();
+    if (status & NET_BIT_FAILED) {
+        LOGE("Network connection lost! Restarting...");
+        log_flush(LOG_FLUSH_TIMEOUT_MS);
+        ESP.restart();
+    }
+    if (otaPending) {
+        LOGI("OTA update message received - restarting to install");
+        log_flush(LOG_FLUSH_TIMEOUT_MS);
+        ESP.restart();
+    }
+    
+    // Subscriptions are lost when the network task reconnects; the retained
+    // messages sent again are identical and do not trigger a render
+    if ((status & NET_BIT_MQTT) && !(status & NET_BIT_SUBSCRIBED)) {
+        network.subscribeMQTT(liveOtaTopic.c_str());
+        if (liveTopic.length() > 0) {
+            network.subscribeMQTT(liveTopic.c_str());
+        }
+    }
+    
+    // Snapshot request when a delta did not apply (published here, the
+    // handler runs on the network task)
+    uint32_t seq;
+    if (live.takeResync(seq)) {
+        String resyncTopic = "displays/" + liveNode + RESYNC_TOPIC_SUFFIX;
+        String request = "{\"seq\":" + String(seq) + "}";
+        network.publishMQTT(resyncTopic.c_str(), request.c_str(), false);
+    }
+    
+    if (now - lastBatteryPoll >= LIVE_BATTERY_POLL_MS) {
+        lastBatteryPoll = now;
+        power.readBattery();
+        int percent = power.getBatteryPercentage();
+        if (percent != liveBatteryPercent) {
+            liveBatteryPercent = percent;
+            live.invalidate(now);
+        }
+    }
+    
+    // One render at a time; changes arriving meanwhile are coalesced into the next
+    if ((liveRender == 0 || displayTask.done(liveRender)) && live.due(now)) {
+        live.take(liveFrame, now);
+        LOGI("[Live] Rendering %d plants (%lu messages)",
+             liveFrame.plantCount, (unsigned long)live.messages);
+        liveRender = postDisplay(DISPLAY_RENDER, -1, &liveFrame, liveBatteryPercent);
+    }
+    
+    if (now - lastTelemetry >= LIVE_TELEMETRY_MS) {
+        lastTelemetry = now;
+        
+        // Cached for the next boot, at most once per telemetry interval
+        if (live.renders != liveCachedRenders && displayTask.done(liveRender)) {
+            dashboard_cache_save(liveFrame);
+            liveCachedRenders = live.renders;
+            
+            // Mains powered: a power loss is the likely reset, so no coalescing
+            rtc_store_seal(true);
+        }
+        
+        JsonDocument& doc = statusDoc;
+        doc.clear();
+        fillStatus(doc, liveBatteryPercent, settings_get_int("sleep_hours", DEFAULT_SLEEP_HOURS));
+        const PlantMonitor::RefreshStats& refreshStats = monitor.getRefreshStats();
+        doc["refresh"] = refreshStats.mode;
+        doc["spi_bytes"] = refreshStats.spiBytes;
+        doc["refresh_ms"] = refreshStats.refreshMs;
+        doc["messages"] = live.messages;
+        doc["renders"] = live.renders;
+        doc["uptime_s"] = now / 1000;
+        memory_probe_sample("telemetry");
+        fillMemory(doc);
+        String telemetry;
+        serializeJson(doc, telemetry);
+        network.publishMQTT(liveStatusTopic.c_str(), telemetry.c_str(), true);
+    }
+    
+    delay(LIVE_LOOP_MS);
 }
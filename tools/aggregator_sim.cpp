@@ -0,0 +1,136 @@
+/***
+ * Topic aggregator check (host)
+ *
+ * Feeds TopicAggregator the retained messages of a wildcard subscription
+ * the way the firmware's collection window does and checks the dashboard
+ * it builds: MQTT filter matching ('+', '#' and its parent level), bare
+ * number and JSON payloads, values that are not finite numbers ("nan",
+ * "inf", a JSON overflow) or not numbers at all, names from the topic,
+ * repeated sensors, sorting and the MAX_PLANTS table limit. Exits non-zero
+ * on a mismatch.
+ *
+ * Build and run: make sim-aggregator
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "TopicAggregator.h"
+
+namespace {
+    int failures = 0;
+    
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            printf("  FAIL: %s\n", what);
+            failures++;
+        }
+    }
+    
+    bool add(TopicAggregator& aggregator, const char* topic, const char* payload)
+    {
+        return aggregator.add(topic, reinterpret_cast<const uint8_t*>(payload), strlen(payload));
+    }
+    
+    void matching()
+    {
+        printf("\nTopic filters\n");
+        struct Case {
+            const char* filter;
+            const char* topic;
+            bool match;
+        };
+        const Case cases[] = {
+            {"plants/+/state", "plants/ficus/state", true},
+            {"plants/+/state", "plants/ficus/attributes", false},
+            {"plants/+/state", "plants/ficus/state/raw", false},
+            {"plants/+/state", "plants//state", true},
+            {"plants/#", "plants/ficus/state", true},
+            {"plants/#", "plants", true},
+            {"plants/#", "plantsx", false},
+            {"plants/+/#", "plants/ficus", true},
+            {"#", "anything/at/all", true},
+            {"plants/ficus", "plants/ficus", true},
+            {"plants/ficus", "plants/ficus/state", false},
+        };
+        for (const Case& c : cases) {
+            bool match = TopicAggregator::matches(c.filter, c.topic);
+            printf("    %-16s %-26s %s\n", c.filter, c.topic, match ? "match" : "-");
+            expect(match == c.match, "MQTT topic filter semantics");
+        }
+        expect(TopicAggregator::isWildcard("plants/+/state") && TopicAggregator::isWildcard("plants/#") &&
+               !TopicAggregator::isWildcard("plants/all"), "wildcard detection");
+    }
+    
+    void payloads()
+    {
+        printf("\nPayloads\n");
+        static TopicAggregator aggregator;
+        aggregator.begin("plants/+/state");
+        
+        expect(add(aggregator, "plants/ficus_lyrata/state", "67.5"), "bare number");
+        expect(add(aggregator, "plants/monstera/state", "{\"moisture\":41,\"name\":\"Big Monstera\",\"updateDate\":\"2025-10-03 22:30\"}"),
+               "JSON object");
+        expect(add(aggregator, "plants/aloe-vera/state", "{\"moisture\":140}"), "JSON value above 100");
+        expect(add(aggregator, "plants/cactus/state", "-3"), "negative value");
+        expect(!add(aggregator, "plants/basil/state", "nan"), "nan rejected");
+        expect(!add(aggregator, "plants/basil/state", "-inf"), "inf rejected");
+        expect(!add(aggregator, "plants/basil/state", "{\"moisture\":1e999}"), "JSON overflow rejected");
+        expect(!add(aggregator, "plants/basil/state", "unavailable"), "text rejected");
+        expect(!add(aggregator, "plants/basil/state", "{\"name\":\"Basil\"}"), "JSON without moisture rejected");
+        expect(!add(aggregator, "plants/basil/state", ""), "empty payload rejected");
+        expect(!add(aggregator, "plants/basil/attributes", "50"), "other topic ignored");
+        expect(add(aggregator, "plants/ficus_lyrata/state", "70"), "sensor publishing again");
+        
+        DashboardModel model;
+        aggregator.build(model);
+        for (int i = 0; i < model.plantCount; i++) {
+            printf("    %-14s %3d%%\n", model.plants[i].name, model.plants[i].moisture);
+        }
+        printf("    received %u, invalid %u, dropped %u, date \"%s\"\n",
+               aggregator.received, aggregator.invalid, aggregator.dropped, model.updateDate);
+        
+        expect(model.plantCount == 4, "four plants");
+        expect(aggregator.received == 11 && aggregator.invalid == 6, "invalid payloads counted");
+        expect(strcmp(model.plants[0].name, "Aloe Vera") == 0 && model.plants[0].moisture == 100,
+               "name from the topic, value clamped to 100");
+        expect(strcmp(model.plants[1].name, "Big Monstera") == 0 && model.plants[1].moisture == 41,
+               "name from the payload");
+        expect(strcmp(model.plants[2].name, "Cactus") == 0 && model.plants[2].moisture == 0, "value clamped to 0");
+        expect(strcmp(model.plants[3].name, "Ficus Lyrata") == 0 && model.plants[3].moisture == 70,
+               "repeated sensor keeps one entry with the newest reading");
+        expect(strcmp(model.updateDate, "2025-10-03 22:30") == 0, "newest date of the sensors");
+    }
+    
+    void tableLimit()
+    {
+        printf("\nTable limit (%d plants)\n", MAX_PLANTS);
+        static TopicAggregator aggregator;
+        aggregator.begin("garden/#");
+        
+        int stored = 0;
+        for (int i = 0; i < MAX_PLANTS + 5; i++) {
+            char topic[32];
+            snprintf(topic, sizeof(topic), "garden/bed_%02d/moisture", i);
+            stored += add(aggregator, topic, "50") ? 1 : 0;
+        }
+        expect(add(aggregator, "garden/bed_00/moisture", "55"), "known sensor still updated when full");
+        
+        DashboardModel model;
+        aggregator.build(model);
+        printf("    stored %d, dropped %u\n", stored, aggregator.dropped);
+        expect(stored == MAX_PLANTS && model.plantCount == MAX_PLANTS, "table holds MAX_PLANTS sensors");
+        expect(aggregator.dropped == 5, "sensors beyond the table counted as dropped");
+        expect(model.plants[0].moisture == 55, "update of a known sensor when full");
+    }
+}
+
+int main()
+{
+    matching();
+    payloads();
+    tableLimit();
+    
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}
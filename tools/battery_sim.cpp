@@ -0,0 +1,138 @@
+/***
+ * Battery gauge simulation (host)
+ *
+ * Decodes sample MAX17048 register bursts, then feeds two weeks of hourly
+ * gauge readings (a slow discharge with load and temperature noise, then a
+ * recharge) to the BatteryGauge filter and compares the percentage shown
+ * with the raw one: how often it changes direction, how often the red low
+ * battery indicator toggles, and how far it lags the true charge. Checks
+ * that the filter removes the flapping without lagging; exits non-zero on
+ * a mismatch.
+ *
+ * Build and run: make sim-battery
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "BatteryGauge.h"
+
+namespace {
+    const int WAKES = 14 * 24;          // Hourly for two weeks
+    const float START_PCT = 55.0f;
+    const float DRAIN_PCT_H = 0.15f;    // True discharge per hour
+    const float NOISE_PCT = 0.8f;       // Gauge noise (load, temperature), uniform +-
+    const int CHARGED_AT = 320;         // Wake at which the battery is recharged
+    const float CHARGED_PCT = 96.0f;
+    
+    int failures = 0;
+    
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            printf("  FAIL: %s\n", what);
+            failures++;
+        }
+    }
+    
+    struct Stats {
+        int reversals;      // Changes against the previous change's direction
+        int lowToggles;     // Red indicator switched on or off
+        float maxLag;       // Largest |shown - true| except right after the recharge
+    };
+    
+    float noise(uint32_t& rng)
+    {
+        rng = rng * 1103515245u + 12345u;
+        return ((int)((rng >> 8) % 2001) - 1000) / 1000.0f * NOISE_PCT;
+    }
+    
+    void count(Stats& stats, int shown, int& last, int& direction, float truePercent, bool afterCharge)
+    {
+        if (last >= 0 && shown != last) {
+            int step = shown > last ? 1 : -1;
+            if (direction != 0 && step != direction) {
+                stats.reversals++;
+            }
+            direction = step;
+            if ((shown < BATTERY_LOW_THRESHOLD) != (last < BATTERY_LOW_THRESHOLD)) {
+                stats.lowToggles++;
+            }
+        }
+        last = shown;
+        if (!afterCharge && fabsf(shown - truePercent) > stats.maxLag) {
+            stats.maxLag = fabsf(shown - truePercent);
+        }
+    }
+    
+    void decodeSamples()
+    {
+        printf("\nRegister bursts\n");
+        uint8_t burst[BatteryGauge::BURST_BYTES] = {0};
+        burst[0] = 0xc8; burst[1] = 0x00;       // VCELL: 4.000 V
+        burst[2] = 0x55; burst[3] = 0x80;       // SOC: 85.5 %
+        burst[6] = 0x00; burst[7] = 0x12;       // VERSION
+        burst[10] = 0x97; burst[11] = 0x1c;     // CONFIG: awake
+        burst[20] = 0xff; burst[21] = 0xf6;     // CRATE: -10 LSB
+        BatteryGauge::Snapshot gauge = BatteryGauge::decode(burst);
+        printf("  gauge: present %d, %.3f V, %.1f %%, %.2f %%/h, sleeping %d\n",
+               gauge.present, gauge.voltage, gauge.rawPercent, gauge.chargeRate, gauge.sleeping);
+        expect(gauge.present && fabsf(gauge.voltage - 4.0f) < 0.001f, "voltage decoded");
+        expect(fabsf(gauge.rawPercent - 85.5f) < 0.01f, "percentage decoded");
+        expect(fabsf(gauge.chargeRate + 2.08f) < 0.01f, "charge rate decoded (signed)");
+        expect(!gauge.sleeping, "awake gauge");
+        
+        burst[11] |= BatteryGauge::CONFIG_SLEEP;
+        expect(BatteryGauge::decode(burst).sleeping, "sleep mode detected");
+        
+        uint8_t floating[BatteryGauge::BURST_BYTES];
+        for (size_t i = 0; i < sizeof(floating); i++) {
+            floating[i] = 0xff;
+        }
+        expect(!BatteryGauge::decode(floating).present, "floating bus is no gauge");
+    }
+}
+
+int main()
+{
+    decodeSamples();
+    
+    printf("\nHourly wakes for two weeks, recharged at wake %d\n", CHARGED_AT);
+    Stats raw = {0, 0, 0};
+    Stats shown = {0, 0, 0};
+    int rawLast = -1, rawDirection = 0;
+    int shownLast = -1, shownDirection = 0;
+    BatteryGauge::History history;
+    BatteryGauge::reset(history);
+    uint32_t rng = 12345;
+    float truePercent = START_PCT;
+    int chargedShown = 0;
+    
+    for (int wake = 0; wake < WAKES; wake++) {
+        if (wake == CHARGED_AT) {
+            truePercent = CHARGED_PCT;
+        }
+        float reading = truePercent + noise(rng);
+        int percent = BatteryGauge::filter(history, reading);
+        bool afterCharge = wake == CHARGED_AT;
+        count(raw, (int)lroundf(reading), rawLast, rawDirection, truePercent, afterCharge);
+        count(shown, percent, shownLast, shownDirection, truePercent, afterCharge);
+        if (afterCharge) {
+            chargedShown = percent;
+        }
+        truePercent -= DRAIN_PCT_H;
+    }
+    
+    printf("  %-10s %3d reversals, %2d low indicator toggles, lag up to %.1f %%\n",
+           "raw", raw.reversals, raw.lowToggles, raw.maxLag);
+    printf("  %-10s %3d reversals, %2d low indicator toggles, lag up to %.1f %%\n",
+           "filtered", shown.reversals, shown.lowToggles, shown.maxLag);
+    printf("  shown right after the recharge: %d %%\n", chargedShown);
+    expect(shown.reversals * 10 <= raw.reversals, "filter removes 90% of the reversals");
+    expect(shown.lowToggles <= 2, "low indicator on once, off at the recharge");
+    expect(shown.maxLag <= 2.5f, "filtered percentage within 2.5% of the true charge");
+    expect(fabsf(chargedShown - CHARGED_PCT) <= NOISE_PCT + 0.5f, "recharge shown at once");
+    
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}
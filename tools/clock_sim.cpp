@@ -0,0 +1,174 @@
+/***
+ * Wall clock simulation (host)
+ *
+ * Follows a display through one simulated week. Its deep sleep clock runs
+ * SIM_DRIFT off; a publisher sends a payload every hour at a fixed phase,
+ * stamped with its publish time. Each wake connects, syncs over SNTP when
+ * due, reads the retained payload and plans the next sleep of about an
+ * hour, the way the firmware does with WallClock.
+ *
+ * Compares the age of the data shown per wake (after the first) for wakes
+ * on a free-running 1 h timer with wakes aligned to the publisher, with
+ * and without SNTP.
+ * Checks that the drift estimate converges and that aligned wakes see
+ * fresh data; exits non-zero on a mismatch. Without SNTP the clock is set
+ * from publish times, which lag by the data age, so wakes are not aligned
+ * and must fare as well as the free-running timer; two such displays
+ * powered on together must still wake their offsets apart.
+ *
+ * Build and run: make sim-clock
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "WallClock.h"
+#include "WakeJitter.h"
+
+namespace {
+    const double SIM_DRIFT = 0.02;          // Deep sleep clock runs 2% slow
+    const double PUBLISH_PHASE = 1234;      // Publisher phase within the hour (s)
+    const double PUBLISH_PERIOD = 3600;
+    const double START = 1760000000;        // Unix time of the first wake
+    const double CONNECT_S = 3;             // Boot to connected
+    const double AWAKE_S = 9;               // Boot to deep sleep
+    const uint32_t SLEEP_S = 3600;          // Sleep chosen by the scheduler
+    const double WEEK = 7 * 24 * 3600;
+    
+    int failures = 0;
+    
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            printf("  FAIL: %s\n", what);
+            failures++;
+        }
+    }
+    
+    enum Mode {
+        FREE_RUNNING,   // Fixed timer, no clock (before WallClock)
+        ALIGNED,        // Aligned to the publisher, SNTP daily
+        PAYLOAD_ONLY    // Publish period known, no time server
+    };
+    
+    struct Result {
+        int wakes;
+        int syncs;
+        double meanAge;     // Data age at the wake, seconds
+        double maxAge;
+        double drift;       // Final estimate
+        double lastWake;    // True time of the last wake
+    };
+    
+    /**
+     * Publish time of the payload retained at true time t
+     */
+    double lastPublish(double t)
+    {
+        return PUBLISH_PHASE + floor((t - PUBLISH_PHASE) / PUBLISH_PERIOD) * PUBLISH_PERIOD;
+    }
+    
+    Result run(const char* name, Mode mode, const char* node = "kitchen-display")
+    {
+        ClockState state;
+        WallClock::reset(state);
+        
+        WakeCadence cadence;
+        cadence.periodS = mode == FREE_RUNNING ? 0 : (uint32_t)PUBLISH_PERIOD;
+        cadence.delayS = CLOCK_PUBLISH_DELAY_S;
+        cadence.offsetS = WakeJitter::offset(WakeJitter::nodeHash(0x0000c40a24e0ull, node), JITTER_WINDOW_S);
+        cadence.minS = 15 * 60;
+        cadence.maxS = 24 * 3600;
+        
+        double trueTime = START;
+        double device = 0;  // Clock reading; unset after power-on
+        Result result = {0, 0, 0, 0, 0, 0};
+        double ageSum = 0;
+        
+        while (trueTime < START + WEEK) {
+            // Boot: correct the time slept
+            if (state.source != CLOCK_UNSET) {
+                device += (double)WallClock::sleepCorrection(state, (int64_t)device);
+            }
+            state.sleptAt = 0;
+            
+            // Connected: SNTP when due, then the retained payload
+            trueTime += CONNECT_S;
+            device += CONNECT_S;
+            if (mode == ALIGNED && WallClock::syncDue(state, (int64_t)device)) {
+                WallClock::sync(state, (int64_t)device, (int64_t)trueTime, CLOCK_SNTP);
+                device = trueTime;
+                result.syncs++;
+            }
+            double published = lastPublish(trueTime);
+            if (mode != FREE_RUNNING) {
+                state.lastPublish = (int64_t)published;
+                if (WallClock::sync(state, (int64_t)device, (int64_t)published, CLOCK_PAYLOAD)) {
+                    device = published;
+                }
+            }
+            
+            // The first wake comes at a random point of the hour
+            result.lastWake = trueTime;
+            double age = trueTime - published;
+            if (result.wakes++ > 0) {
+                ageSum += age;
+                if (age > result.maxAge) {
+                    result.maxAge = age;
+                }
+            }
+            
+            // Plan, then sleep on the RC clock
+            uint32_t sleepS = WallClock::alignedSleep(state, (int64_t)device, SLEEP_S, cadence);
+            int64_t nextWake = (int64_t)device + sleepS;
+            if (mode != FREE_RUNNING && state.source != CLOCK_SNTP) {
+                state.shifted = 1;  // As clock_plan_sleep
+            }
+            trueTime += AWAKE_S - CONNECT_S;
+            device += AWAKE_S - CONNECT_S;
+            uint32_t timer = SLEEP_S;
+            if (mode != FREE_RUNNING) {
+                state.sleptAt = (int64_t)device;
+                int64_t remaining = nextWake - (int64_t)device;
+                timer = WallClock::timerSleep(state, remaining > 0 ? (uint32_t)remaining : 1);
+            }
+            device += timer;
+            trueTime += timer * (1 + SIM_DRIFT);
+        }
+        
+        result.meanAge = ageSum / (result.wakes - 1);
+        result.drift = state.drift;
+        printf("  %-28s %3d wakes, %3d SNTP syncs, data age mean %5.0f s, max %5.0f s, drift %+.4f\n",
+               name, result.wakes, result.syncs, result.meanAge, result.maxAge, result.drift);
+        return result;
+    }
+}
+
+int main()
+{
+    printf("\nOne week, deep sleep clock %+.0f%%, publisher hourly at :%02d:%02d\n",
+           SIM_DRIFT * 100, (int)PUBLISH_PHASE / 60, (int)PUBLISH_PHASE % 60);
+    Result free = run("free-running 1 h timer", FREE_RUNNING);
+    Result aligned = run("aligned, SNTP daily", ALIGNED);
+    Result payload = run("payload time only", PAYLOAD_ONLY);
+    Result neighbour = run("payload time only, 2nd node", PAYLOAD_ONLY, "hallway-display");
+    
+    double latest = CONNECT_S + CLOCK_PUBLISH_DELAY_S + JITTER_WINDOW_S;
+    expect(fabs(aligned.drift - SIM_DRIFT) < 0.001, "drift estimate within 0.1% of the clock's");
+    expect(aligned.maxAge < latest + SIM_DRIFT * SLEEP_S, "aligned (SNTP): every wake right after a publish");
+    expect(payload.meanAge < free.meanAge * 1.05, "payload time only: as fresh as free-running (within 5%)");
+    
+    // Powered on together: the offsets stay between the two nodes' wakes
+    uint32_t offsetA = WakeJitter::offset(WakeJitter::nodeHash(0x0000c40a24e0ull, "kitchen-display"), JITTER_WINDOW_S);
+    uint32_t offsetB = WakeJitter::offset(WakeJitter::nodeHash(0x0000c40a24e0ull, "hallway-display"), JITTER_WINDOW_S);
+    double apart = fabs(fmod(neighbour.lastWake - payload.lastWake, SLEEP_S * (1 + SIM_DRIFT)));
+    printf("  offsets %lu s and %lu s, last wakes %.0f s apart\n",
+           (unsigned long)offsetA, (unsigned long)offsetB, apart);
+    expect(offsetA != offsetB && fabs(apart - fabs((double)offsetA - (double)offsetB) * (1 + SIM_DRIFT)) < 2,
+           "payload time only: nodes keep their offset apart");
+    expect(aligned.meanAge < free.meanAge / 10, "aligned data 10x fresher than free-running");
+    expect(aligned.wakes <= 7 * 24 + 1, "no extra wakes");
+    expect(aligned.syncs < 20, "SNTP mostly daily once the drift has settled");
+    
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+/***
+ * Display task check (host)
+ *
+ * Runs the native (std::thread) DisplayTask with an executor standing in
+ * for the panel glue and checks the interface main.cpp relies on: commands
+ * execute in the order posted, wait() returns as soon as its command is
+ * done (not at the timeout) and covers the commands queued before it, a
+ * command stuck in the panel times the wait out without losing it, and the
+ * destructor finishes what is queued. Exits non-zero on a mismatch.
+ *
+ * Build and run: make sim-display-task
+ */
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "DisplayTask.h"
+
+namespace {
+    const int COMMAND_MS = 30;      // Time each command takes in the executor
+    
+    int failures = 0;
+    
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            printf("  FAIL: %s\n", what);
+            failures++;
+        }
+    }
+    
+    /**
+     * Executor: records the commands it ran, optionally held at a gate
+     */
+    struct Panel {
+        std::mutex lock;
+        std::condition_variable opened;
+        bool gateClosed;
+        std::vector<int> ran;           // batteryPercent of each command, in execution order
+        std::atomic<int> running;       // Commands executing at once
+        std::atomic<bool> overlapped;   // Two commands executed at the same time
+        
+        Panel() : gateClosed(false), running(0), overlapped(false) {}
+        
+        static void execute(const DisplayCommand& command, void* context)
+        {
+            Panel* self = static_cast<Panel*>(context);
+            if (++self->running > 1) {
+                self->overlapped = true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(COMMAND_MS));
+            {
+                std::unique_lock<std::mutex> guard(self->lock);
+                self->opened.wait(guard, [&] { return !self->gateClosed; });
+                self->ran.push_back(command.batteryPercent);
+            }
+            self->running--;
+        }
+        
+        void setGate(bool closed)
+        {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                gateClosed = closed;
+            }
+            opened.notify_all();
+        }
+        
+        size_t count()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            return ran.size();
+        }
+    };
+    
+    DisplayCommand command(DisplayCommandType type, int tag)
+    {
+        DisplayCommand command;
+        command.type = type;
+        command.model = nullptr;
+        command.batteryPercent = tag;
+        command.phase = -1;
+        return command;
+    }
+    
+    long elapsedMs(std::chrono::steady_clock::time_point since)
+    {
+        return (long)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - since).count();
+    }
+    
+    void order()
+    {
+        printf("\nQueue order (wake sequence: init, prerender, render, hibernate)\n");
+        Panel panel;
+        DisplayTask display;
+        expect(display.post(command(DISPLAY_INIT, 0)) == 0, "no ticket before begin");
+        expect(display.begin(Panel::execute, &panel), "task started");
+        
+        uint32_t init = display.post(command(DISPLAY_INIT, 1));
+        uint32_t prerender = display.post(command(DISPLAY_PRERENDER, 2));
+        uint32_t render = display.post(command(DISPLAY_RENDER, 3));
+        uint32_t hibernate = display.post(command(DISPLAY_HIBERNATE, 4));
+        expect(init != 0 && prerender > init && render > prerender && hibernate > render, "increasing tickets");
+        expect(!display.done(hibernate), "posting does not wait for the panel");
+        
+        expect(display.wait(render, 1000), "render done");
+        expect(display.done(init) && display.done(prerender), "earlier commands done before it");
+        expect(display.wait(hibernate, 1000), "hibernate done");
+        
+        std::lock_guard<std::mutex> guard(panel.lock);
+        printf("    ran:");
+        for (int tag : panel.ran) {
+            printf(" %d", tag);
+        }
+        printf("\n");
+        expect(panel.ran == std::vector<int>({1, 2, 3, 4}), "executed in the order posted");
+        expect(!panel.overlapped, "one command at a time");
+        expect(!display.done(0) && !display.wait(0, 10), "ticket 0 is never done");
+    }
+    
+    void notification()
+    {
+        printf("\nCompletion notification (%d ms per command)\n", COMMAND_MS);
+        Panel panel;
+        DisplayTask display;
+        display.begin(Panel::execute, &panel);
+        
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        uint32_t ticket = display.post(command(DISPLAY_RENDER, 1));
+        bool done = display.wait(ticket, 5000);
+        long ms = elapsedMs(start);
+        printf("    wait returned after %ld ms (timeout 5000 ms)\n", ms);
+        expect(done, "render done");
+        expect(ms >= COMMAND_MS && ms < 1000, "woken by the completion, not the timeout");
+        
+        // Already done: no waiting at all
+        start = std::chrono::steady_clock::now();
+        expect(display.wait(ticket, 5000) && elapsedMs(start) < COMMAND_MS, "done ticket returns at once");
+    }
+    
+    void timeout()
+    {
+        printf("\nTimeout (panel BUSY stuck)\n");
+        Panel panel;
+        DisplayTask display;
+        display.begin(Panel::execute, &panel);
+        
+        panel.setGate(true);
+        uint32_t stuck = display.post(command(DISPLAY_RENDER, 1));
+        uint32_t next = display.post(command(DISPLAY_HIBERNATE, 2));
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool done = display.wait(stuck, 100);
+        long ms = elapsedMs(start);
+        printf("    wait returned %s after %ld ms (timeout 100 ms)\n", done ? "done" : "timed out", ms);
+        expect(!done && ms >= 100 && ms < 1000, "wait times out");
+        expect(!display.done(stuck) && !display.done(next), "stuck command and the ones after it not done");
+        
+        panel.setGate(false);
+        expect(display.wait(next, 1000), "queue resumes once the panel answers");
+        expect(panel.count() == 2, "no command lost");
+    }
+    
+    void shutdown()
+    {
+        printf("\nDestructor\n");
+        Panel panel;
+        {
+            DisplayTask display;
+            display.begin(Panel::execute, &panel);
+            for (int i = 1; i <= 3; i++) {
+                display.post(command(DISPLAY_RENDER, i));
+            }
+        }
+        printf("    %u of 3 queued commands ran\n", (unsigned)panel.count());
+        expect(panel.count() == 3, "queued commands finished before the thread exits");
+    }
+}
+
+int main()
+{
+    order();
+    notification();
+    timeout();
+    shutdown();
+    
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,249 @@
+/***
+ * Energy model (host)
+ *
+ * Runs the firmware's EnergyModel over recorded phase traces (the
+ * displays/<node>/trace messages, one JSON object per line, e.g. from
+ * `mosquitto_sub -t displays/<node>/trace`) and projects battery life for
+ * a configuration, so sleep interval or current changes can be evaluated
+ * before rollout. Without a trace file a built-in sample of three wakes
+ * (partial refresh, full refresh, unchanged data) is used.
+ *
+ * Each trace becomes one cycle:
+ *   awake  end of the last phase + ENERGY_BOOT_MS
+ *   radio  start of "wifi" until start of "sleep" (WiFi is off by then)
+ *   panel  sum of "panel" phases
+ *   sleep  --sleep-hours
+ *
+ * Options (defaults from Config.h):
+ *   --sleep-hours=N --capacity=MAH --battery=PCT --scale=X
+ *   --cpu-ma=X --radio-ma=X --panel-ma=X --light-sleep-ma=X --deep-sleep-ma=X
+ *
+ * Build and run: make model-energy [TRACE=file] [ENERGY_ARGS="--sleep-hours=2"]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "EnergyModel.h"
+
+namespace {
+    const char* const SAMPLE_TRACES[] = {
+        "{\"wake\":40,\"dropped\":0,\"phases\":[[\"settings\",61230,8120],[\"battery\",70110,41200],"
+        "[\"wifi\",72040,1820400],[\"dhcp\",1412300,480140],[\"mqtt\",1893400,96200],"
+        "[\"retained\",1990100,212300],[\"retained\",2203400,184100],[\"parse\",2215100,14200],"
+        "[\"draw\",2390200,31200],[\"panel\",2421500,640100],[\"render\",2389900,672100],"
+        "[\"sleep\",3102300,48100]]}",
+        "{\"wake\":41,\"dropped\":0,\"phases\":[[\"settings\",60980,8010],[\"battery\",69800,40900],"
+        "[\"wifi\",71800,2410300],[\"dhcp\",1890200,591900],[\"mqtt\",2482600,102400],"
+        "[\"retained\",2585400,208800],[\"retained\",2794600,190300],[\"parse\",2808100,14900],"
+        "[\"draw\",2985000,35100],[\"panel\",3020300,4012500],[\"render\",2984700,4048400],"
+        "[\"sleep\",7080200,47900]]}",
+        "{\"wake\":42,\"dropped\":0,\"phases\":[[\"settings\",61020,8050],[\"battery\",69900,41000],"
+        "[\"wifi\",71900,1710200],[\"dhcp\",1290100,492000],[\"mqtt\",1782600,95100],"
+        "[\"retained\",1878200,205100],[\"retained\",2083800,181200],[\"parse\",2095600,13800],"
+        "[\"render\",2262300,1200],[\"sleep\",2310900,47700]]}",
+    };
+    
+    struct Options {
+        EnergyCoefficients coefficients;
+        int sleepHours;
+        float capacityMah;
+        float batteryPercent;
+        float scale;
+        const char* traceFile;
+    };
+    
+    /**
+     * Phases of one trace message as a cycle, false if it has none
+     */
+    bool parseTrace(const char* json, int sleepHours, EnergyPhases& phases, unsigned long& wake)
+    {
+        const char* at = strstr(json, "\"wake\":");
+        wake = at ? strtoul(at + 7, nullptr, 10) : 0;
+        at = strstr(json, "\"phases\":[");
+        if (!at) {
+            return false;
+        }
+        at += 10;
+        
+        unsigned long endUs = 0, wifiUs = 0, sleepUs = 0, panelUs = 0;
+        bool any = false;
+        char name[16];
+        unsigned long start, duration;
+        int used;
+        while (sscanf(at, " [\"%15[^\"]\",%lu,%lu]%n", name, &start, &duration, &used) == 3) {
+            any = true;
+            if (start + duration > endUs) {
+                endUs = start + duration;
+            }
+            if (strcmp(name, "wifi") == 0 && wifiUs == 0) {
+                wifiUs = start;
+            } else if (strcmp(name, "sleep") == 0) {
+                sleepUs = start;
+            } else if (strcmp(name, "panel") == 0) {
+                panelUs += duration;
+            }
+            at += used;
+            if (*at == ',') {
+                at++;
+            }
+        }
+        if (!any) {
+            return false;
+        }
+        
+        unsigned long radioEndUs = sleepUs ? sleepUs : endUs;
+        phases.awakeMs = endUs / 1000 + ENERGY_BOOT_MS;
+        phases.radioMs = wifiUs && radioEndUs > wifiUs ? (radioEndUs - wifiUs) / 1000 : 0;
+        phases.panelMs = panelUs / 1000;
+        phases.lightSleepMs = 0;
+        phases.deepSleepS = sleepHours * 3600;
+        return true;
+    }
+    
+    bool option(const char* arg, const char* name, float& value)
+    {
+        size_t length = strlen(name);
+        if (strncmp(arg, name, length) != 0 || arg[length] != '=') {
+            return false;
+        }
+        value = strtof(arg + length + 1, nullptr);
+        return true;
+    }
+    
+    bool parseOptions(int argc, char** argv, Options& options)
+    {
+        options.coefficients = EnergyModel::defaultCoefficients();
+        options.sleepHours = DEFAULT_SLEEP_HOURS;
+        options.capacityMah = ENERGY_BATTERY_MAH;
+        options.batteryPercent = 100;
+        options.scale = 1.0f;
+        options.traceFile = nullptr;
+        
+        EnergyCoefficients& k = options.coefficients;
+        for (int i = 1; i < argc; i++) {
+            float sleepHours;
+            if (option(argv[i], "--sleep-hours", sleepHours)) {
+                options.sleepHours = (int)sleepHours;
+            } else if (option(argv[i], "--capacity", options.capacityMah) ||
+                       option(argv[i], "--battery", options.batteryPercent) ||
+                       option(argv[i], "--scale", options.scale) ||
+                       option(argv[i], "--cpu-ma", k.cpuMa) ||
+                       option(argv[i], "--radio-ma", k.radioMa) ||
+                       option(argv[i], "--panel-ma", k.panelMa) ||
+                       option(argv[i], "--light-sleep-ma", k.lightSleepMa) ||
+                       option(argv[i], "--deep-sleep-ma", k.deepSleepMa)) {
+                continue;
+            } else if (argv[i][0] != '-' && !options.traceFile) {
+                options.traceFile = argv[i];
+            } else {
+                fprintf(stderr, "unknown option: %s\n", argv[i]);
+                return false;
+            }
+        }
+        return options.sleepHours > 0 && options.capacityMah > 0;
+    }
+    
+    std::vector<std::string> readTraces(const char* path)
+    {
+        std::vector<std::string> traces;
+        if (!path) {
+            for (const char* trace : SAMPLE_TRACES) {
+                traces.push_back(trace);
+            }
+            return traces;
+        }
+        
+        FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+        if (!file) {
+            perror(path);
+            exit(1);
+        }
+        std::string line;
+        for (int c = fgetc(file); c != EOF; c = fgetc(file)) {
+            if (c == '\n') {
+                traces.push_back(line);
+                line.clear();
+            } else {
+                line += (char)c;
+            }
+        }
+        if (!line.empty()) {
+            traces.push_back(line);
+        }
+        if (file != stdin) {
+            fclose(file);
+        }
+        return traces;
+    }
+    
+    /**
+     * Account all traces at one sleep interval
+     */
+    EnergyState run(const EnergyModel& model, const std::vector<EnergyPhases>& cycles, int sleepHours, float scale)
+    {
+        EnergyState state;
+        EnergyModel::reset(state);
+        state.scale = scale;
+        for (EnergyPhases phases : cycles) {
+            phases.deepSleepS = sleepHours * 3600;
+            model.account(state, phases);
+        }
+        return state;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "usage: %s [--sleep-hours=N] [--capacity=MAH] [--battery=PCT] [--scale=X]\n"
+                        "       [--cpu-ma=X] [--radio-ma=X] [--panel-ma=X] [--light-sleep-ma=X]\n"
+                        "       [--deep-sleep-ma=X] [trace-file|-]\n", argv[0]);
+        return 2;
+    }
+    
+    const EnergyCoefficients& k = options.coefficients;
+    printf("Currents: cpu %.1f mA, radio +%.1f mA, panel +%.1f mA, light sleep %.2f mA, deep sleep %.3f mA\n",
+           k.cpuMa, k.radioMa, k.panelMa, k.lightSleepMa, k.deepSleepMa);
+    printf("Battery: %.0f mAh at %.0f%%, scale %.2f, sleep %d h\n\n",
+           options.capacityMah, options.batteryPercent, options.scale, options.sleepHours);
+    
+    EnergyModel model(k);
+    std::vector<EnergyPhases> cycles;
+    printf("%6s %8s %8s %8s %10s %10s\n", "wake", "awake", "radio", "panel", "awake mAh", "cycle mAh");
+    for (const std::string& trace : readTraces(options.traceFile)) {
+        EnergyPhases phases;
+        unsigned long wake;
+        if (!parseTrace(trace.c_str(), options.sleepHours, phases, wake)) {
+            continue;
+        }
+        cycles.push_back(phases);
+        
+        EnergyPhases awake = phases;
+        awake.deepSleepS = 0;
+        printf("%6lu %5lu ms %5lu ms %5lu ms %10.4f %10.4f\n", wake, (unsigned long)phases.awakeMs,
+               (unsigned long)phases.radioMs, (unsigned long)phases.panelMs,
+               model.cycleMah(awake) * options.scale, model.cycleMah(phases) * options.scale);
+    }
+    if (cycles.empty()) {
+        fprintf(stderr, "no traces\n");
+        return 1;
+    }
+    
+    EnergyState state = run(model, cycles, options.sleepHours, options.scale);
+    printf("\nAverage %.3f mA -> %.0f days\n", EnergyModel::averageMa(state),
+           EnergyModel::projectedDays(state, options.batteryPercent, options.capacityMah));
+    
+    printf("\n%11s %10s %8s\n", "sleep hours", "average", "days");
+    const int SLEEP_HOURS[] = {1, 2, 3, 4, 6, 8, 12, 24};
+    for (int hours : SLEEP_HOURS) {
+        EnergyState sweep = run(model, cycles, hours, options.scale);
+        printf("%11d %7.3f mA %8.0f%s\n", hours, EnergyModel::averageMa(sweep),
+               EnergyModel::projectedDays(sweep, options.batteryPercent, options.capacityMah),
+               hours == options.sleepHours ? "  <-" : "");
+    }
+    return 0;
+}
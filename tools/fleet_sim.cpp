@@ -0,0 +1,160 @@
+/***
+ * Fleet wake simulation (host)
+ *
+ * A fleet of displays flashed and powered on together, with the same
+ * node_name, wakes after every hourly publish for a day. The access point
+ * serves associations one at a time (AP_SERVICE_MS each, on top of the
+ * radio's own AP_BASE_MS) and the broker answers CONNECTs one at a time,
+ * so displays waking together queue behind each other.
+ *
+ * Compares the connect latency (WiFi start to CONNACK) of wakes without
+ * an offset, with the WakeJitter offset in a fixed window, and with the
+ * window adapting to the latency each node sees. Checks that the spread
+ * cuts the p99 and that adaptation helps a fleet too large for the base
+ * window; exits non-zero on a mismatch.
+ *
+ * Build and run: make sim-fleet
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "WakeJitter.h"
+
+namespace {
+    const double AP_BASE_MS = 900;          // Scan, auth, association, DHCP without contention
+    const double AP_SERVICE_MS = 250;       // AP time per association (serialized)
+    const double BROKER_BASE_MS = 60;       // TCP + CONNECT round trip
+    const double BROKER_SERVICE_MS = 40;    // Broker time per CONNECT (serialized)
+    const double BOOT_MS = 300;             // Wake to WiFi start
+    const double BOOT_SPREAD_MS = 100;      // Boot time variation between nodes
+    const int HOURS = 24;
+
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            printf("  FAIL: %s\n", what);
+            failures++;
+        }
+    }
+
+    enum Mode {
+        NO_OFFSET,
+        FIXED_WINDOW,
+        ADAPTIVE_WINDOW
+    };
+
+    struct Node {
+        uint32_t hash;
+        WakeJitter::State jitter;
+        uint32_t rng;
+    };
+
+    struct Arrival {
+        double startMs;     // WiFi start, ms after the publish slot
+        int node;
+    };
+
+    struct Result {
+        double p50;
+        double p99;
+        double max;
+        double meanOffsetS;
+        uint32_t maxWindowS;
+    };
+
+    bool earlier(const Arrival& a, const Arrival& b)
+    {
+        return a.startMs < b.startMs;
+    }
+
+    double percentile(std::vector<double> values, double p)
+    {
+        std::sort(values.begin(), values.end());
+        size_t index = (size_t)(p * values.size());
+        return values[index < values.size() ? index : values.size() - 1];
+    }
+
+    double bootMs(Node& node)
+    {
+        node.rng = node.rng * 1103515245u + 12345u;
+        return BOOT_MS + (node.rng >> 16) % (uint32_t)BOOT_SPREAD_MS;
+    }
+
+    Result run(const char* name, int nodeCount, Mode mode)
+    {
+        std::vector<Node> nodes(nodeCount);
+        for (int i = 0; i < nodeCount; i++) {
+            uint64_t mac = 0x0000c40a24e0ull | ((uint64_t)i << 40);  // One production batch
+            nodes[i].hash = WakeJitter::nodeHash(mac, "e-paper-display");
+            nodes[i].rng = (uint32_t)i * 2654435761u;
+            WakeJitter::reset(nodes[i].jitter);
+        }
+
+        std::vector<double> latencies;
+        double offsetSum = 0;
+        uint32_t maxWindow = 0;
+        for (int hour = 0; hour < HOURS; hour++) {
+            // Wake times after this hour's slot
+            std::vector<Arrival> arrivals(nodeCount);
+            for (int i = 0; i < nodeCount; i++) {
+                uint32_t windowS = WakeJitter::window(nodes[i].jitter, JITTER_WINDOW_S, JITTER_MAX_WINDOW_S);
+                uint32_t offsetS = mode == NO_OFFSET ? 0 : WakeJitter::offset(nodes[i].hash, windowS);
+                arrivals[i].startMs = offsetS * 1000.0 + bootMs(nodes[i]);
+                arrivals[i].node = i;
+                offsetSum += offsetS;
+                maxWindow = std::max(maxWindow, windowS);
+            }
+            std::sort(arrivals.begin(), arrivals.end(), earlier);
+
+            // Both servers first come, first served
+            double apFree = 0, brokerFree = 0;
+            for (const Arrival& arrival : arrivals) {
+                double associated = std::max(arrival.startMs + AP_BASE_MS, apFree + AP_SERVICE_MS);
+                apFree = associated;
+                double connected = std::max(associated + BROKER_BASE_MS, brokerFree + BROKER_SERVICE_MS);
+                brokerFree = connected;
+
+                double latency = connected - arrival.startMs;
+                latencies.push_back(latency);
+                if (mode == ADAPTIVE_WINDOW) {
+                    WakeJitter::observe(nodes[arrival.node].jitter, (uint32_t)latency);
+                }
+            }
+        }
+
+        Result result;
+        result.p50 = percentile(latencies, 0.50);
+        result.p99 = percentile(latencies, 0.99);
+        result.max = percentile(latencies, 1.0);
+        result.meanOffsetS = offsetSum / (HOURS * nodeCount);
+        result.maxWindowS = maxWindow;
+        printf("  %-24s connect p50 %6.0f ms, p99 %6.0f ms, max %6.0f ms; offset mean %4.0f s, window up to %3lu s\n",
+               name, result.p50, result.p99, result.max, result.meanOffsetS, (unsigned long)result.maxWindowS);
+        return result;
+    }
+}
+
+int main()
+{
+    printf("\n40 displays, hourly wakes for a day\n");
+    Result same = run("no offset", 40, NO_OFFSET);
+    Result spread = run("MAC hash, fixed window", 40, FIXED_WINDOW);
+    Result adapted = run("MAC hash, adaptive", 40, ADAPTIVE_WINDOW);
+    expect(spread.p99 < same.p99 / 5, "offset cuts the p99 connect time 5x");
+    expect(adapted.maxWindowS == JITTER_WINDOW_S, "small fleet: window not widened");
+
+    printf("\n400 displays, hourly wakes for a day\n");
+    Result bigSame = run("no offset", 400, NO_OFFSET);
+    Result bigSpread = run("MAC hash, fixed window", 400, FIXED_WINDOW);
+    Result bigAdapted = run("MAC hash, adaptive", 400, ADAPTIVE_WINDOW);
+    expect(bigSpread.p99 < bigSame.p99 / 5, "offset cuts the p99 connect time 5x");
+    expect(bigAdapted.maxWindowS > JITTER_WINDOW_S, "large fleet: window widened");
+    expect(bigAdapted.p99 < bigSpread.p99, "adaptive window beats the fixed one");
+
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}
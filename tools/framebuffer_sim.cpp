@@ -0,0 +1,206 @@
+/***
+ * Framebuffer rendering check (host)
+ *
+ * Builds the firmware's DashboardRenderer over the in-memory Framebuffer
+ * panel (EPD_PANEL_FRAMEBUFFER) against the host GFX stand-ins in
+ * tools/host, renders dashboards the way PlantMonitor composes a frame and
+ * checks pixels: the header separator at the measured height, alert red
+ * only in low plants' cells and on a low battery, gauges and bars inside
+ * their cells, window clipping and rotation. Writes the gauge dashboard to
+ * .pio/tools/dashboard.ppm; exits non-zero on a mismatch.
+ *
+ * Build and run: make sim-framebuffer
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "Config.h"
+#include "DashboardLayout.h"
+#include "DashboardRenderer.h"
+
+namespace {
+    typedef Framebuffer<400, 300> Panel;
+    
+    const int W = Panel::WIDTH;
+    const int H = Panel::HEIGHT;
+    
+    int failures = 0;
+    
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            printf("  FAIL: %s\n", what);
+            failures++;
+        }
+    }
+    
+    /**
+     * Pixels of a color in a rectangle of the buffer
+     */
+    int count(const Panel& panel, int x, int y, int w, int h, uint16_t color)
+    {
+        int n = 0;
+        for (int j = y; j < y + h; j++) {
+            for (int i = x; i < x + w; i++) {
+                if (i >= 0 && j >= 0 && i < W && j < H && panel.getPixel(i, j) == color) {
+                    n++;
+                }
+            }
+        }
+        return n;
+    }
+    
+    /**
+     * Render one frame like PlantMonitor (computeLayout, drawFrame), return its layout
+     */
+    DashboardLayout render(Panel& panel, const int* moisture, int plants, int battery, int page = 0)
+    {
+        DashboardRenderer<Panel> renderer(panel);
+        DashboardLayout layout = DashboardLayout::compute(plants, W, H, renderer.measureHeader("2025-10-03 22:30"), page);
+        if (layout.pageCount > 1) {
+            int headerHeight = renderer.measureHeader("2025-10-03 22:30", layout.page, layout.pageCount);
+            layout = DashboardLayout::compute(plants, W, H, headerHeight, page);
+        }
+        
+        panel.setFullWindow();
+        panel.fillScreen(GxEPD_WHITE);
+        int header = renderer.drawHeader("2025-10-03 22:30", battery, layout.page, layout.pageCount);
+        expect(header == layout.originY, "drawn header height matches the measured one");
+        
+        for (int slot = 0; slot < layout.count; slot++) {
+            char name[16];
+            snprintf(name, sizeof(name), "Plant %02d", layout.first + slot + 1);
+            DashboardLayout::Rect r = layout.cell(slot);
+            if (layout.compact) {
+                renderer.drawBar(r.x, r.y, r.w, r.h, name, moisture[layout.first + slot]);
+            } else {
+                renderer.drawGauge(r.x, r.y, r.w, r.h, name, moisture[layout.first + slot]);
+            }
+        }
+        return layout;
+    }
+    
+    /**
+     * Alert red appears in the cells of low plants and nowhere else
+     */
+    void checkCells(const Panel& panel, const DashboardLayout& layout, const int* moisture)
+    {
+        for (int slot = 0; slot < layout.count; slot++) {
+            DashboardLayout::Rect r = layout.cell(slot);
+            int value = moisture[layout.first + slot];
+            int red = count(panel, r.x, r.y, r.w, r.h, GxEPD_RED);
+            int black = count(panel, r.x, r.y, r.w, r.h, GxEPD_BLACK);
+            printf("    plant %2d  %3d%%  black %5d  red %5d\n", layout.first + slot + 1, value, black, red);
+            expect(black > 0, "widget drawn in its cell");
+            expect((red > 0) == (value < MOISTURE_LOW_THRESHOLD), "red only for low moisture");
+        }
+    }
+    
+    void writePpm(const Panel& panel, const char* path)
+    {
+        FILE* file = fopen(path, "wb");
+        if (file == nullptr) {
+            return;
+        }
+        fprintf(file, "P6\n%d %d\n255\n", W, H);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                uint16_t color = panel.getPixel(x, y);
+                unsigned char rgb[3] = {255, 255, 255};
+                if (color == GxEPD_BLACK) {
+                    rgb[0] = rgb[1] = rgb[2] = 0;
+                } else if (color == GxEPD_RED) {
+                    rgb[1] = rgb[2] = 0;
+                }
+                fwrite(rgb, 1, sizeof(rgb), file);
+            }
+        }
+        fclose(file);
+        printf("    wrote %s\n", path);
+    }
+    
+    void gauges(Panel& panel)
+    {
+        printf("\nGauges (6 plants, battery 80%%)\n");
+        const int moisture[] = {72, 15, 48, 100, 0, 34};
+        DashboardLayout layout = render(panel, moisture, 6, 80);
+        expect(!layout.compact && layout.pageCount == 1, "six plants fit as gauges on one page");
+        
+        // Three-pixel separator across the screen ending at the header height
+        int separator = layout.originY - 3;
+        expect(count(panel, 10, separator, W - 19, 3, GxEPD_BLACK) == (W - 19) * 3, "header separator line");
+        expect(count(panel, 0, 0, W, separator, GxEPD_BLACK) > 0, "header title and date drawn");
+        expect(count(panel, 0, 0, W, layout.originY, GxEPD_RED) == 0, "no red in the header with a charged battery");
+        
+        checkCells(panel, layout, moisture);
+        writePpm(panel, ".pio/tools/dashboard.ppm");
+    }
+    
+    void bars(Panel& panel)
+    {
+        printf("\nBars (%d plants, battery 5%%)\n", MAX_PLANTS);
+        int moisture[MAX_PLANTS];
+        for (int i = 0; i < MAX_PLANTS; i++) {
+            moisture[i] = (i * 37) % 100;
+        }
+        int pageCount = 1;
+        for (int page = 0; page < pageCount; page++) {
+            DashboardLayout layout = render(panel, moisture, MAX_PLANTS, 5, page);
+            printf("    %dx%d %s, page %d/%d\n", layout.cols, layout.rows, layout.compact ? "bars" : "gauges",
+                   layout.page + 1, layout.pageCount);
+            expect(layout.compact, "dense dashboard drawn as bars");
+            expect(count(panel, 0, 0, W, layout.originY, GxEPD_RED) > 0, "low battery drawn in red");
+            
+            // Paginated title ("PLANT MOISTURE n/m") measured like it is drawn
+            expect(count(panel, 10, layout.originY - 3, W - 19, 3, GxEPD_BLACK) == (W - 19) * 3,
+                   "separator at the measured height of the paginated header");
+            
+            checkCells(panel, layout, moisture);
+            pageCount = layout.pageCount;
+        }
+    }
+    
+    void windowAndRotation(Panel& panel)
+    {
+        printf("\nPartial window and rotation\n");
+        panel.setFullWindow();
+        panel.fillScreen(GxEPD_WHITE);
+        panel.setPartialWindow(40, 30, 80, 20);
+        panel.fillScreen(GxEPD_BLACK);
+        expect(count(panel, 0, 0, W, H, GxEPD_BLACK) == 80 * 20, "drawing clipped to the window");
+        expect(panel.getPixel(40, 30) == GxEPD_BLACK && panel.getPixel(119, 49) == GxEPD_BLACK,
+               "window corners drawn");
+        
+        panel.setFullWindow();
+        panel.fillScreen(GxEPD_WHITE);
+        panel.setRotation(1);
+        expect(panel.width() == H && panel.height() == W, "rotation swaps the drawing size");
+        panel.drawPixel(0, 0, GxEPD_BLACK);
+        panel.drawPixel(0, W - 1, GxEPD_RED);
+        expect(panel.getPixel(W - 1, 0) == GxEPD_BLACK, "rotation 1: top-left lands top-right");
+        expect(panel.getPixel(0, 0) == GxEPD_RED, "rotation 1: bottom-left lands top-left");
+        
+        panel.setPartialWindow(0, 0, 20, 10);
+        panel.fillScreen(GxEPD_BLACK);
+        expect(count(panel, W - 10, 0, 10, 20, GxEPD_BLACK) == 200, "rotated window maps to the buffer");
+        
+        panel.setRotation(2);
+        panel.setFullWindow();
+        panel.fillScreen(GxEPD_WHITE);
+        panel.drawPixel(0, 0, GxEPD_BLACK);
+        expect(panel.getPixel(W - 1, H - 1) == GxEPD_BLACK, "rotation 2: top-left lands bottom-right");
+        panel.setRotation(0);
+    }
+}
+
+int main()
+{
+    static Panel panel(FramebufferDriver(-1, -1, -1, -1));
+    
+    gauges(panel);
+    bars(panel);
+    windowAndRotation(panel);
+    
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}
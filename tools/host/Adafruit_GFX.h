@@ -0,0 +1,250 @@
+/***
+ * Host stand-in for Adafruit_GFX
+ *
+ * The drawing primitives and GFXfont text the rendering code uses, built
+ * on the subclass's drawPixel with the library's rotation, clipping and
+ * glyph placement rules, so a Framebuffer renders the same pixels as on
+ * the device.
+ * Used by: make sim-framebuffer
+ */
+
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+#include <stdlib.h>
+#include "Arduino.h"
+
+typedef struct {
+    uint16_t bitmapOffset;
+    uint8_t width;
+    uint8_t height;
+    uint8_t xAdvance;
+    int8_t xOffset;
+    int8_t yOffset;
+} GFXglyph;
+
+typedef struct {
+    uint8_t* bitmap;
+    GFXglyph* glyph;
+    uint16_t first;
+    uint16_t last;
+    uint8_t yAdvance;
+} GFXfont;
+
+class Adafruit_GFX {
+public:
+    Adafruit_GFX(int16_t w, int16_t h)
+        : WIDTH(w), HEIGHT(h), _width(w), _height(h), rotation(0),
+          cursor_x(0), cursor_y(0), textcolor(0xFFFF), textsize(1), wrap(true), gfxFont(nullptr)
+    {
+    }
+
+    virtual ~Adafruit_GFX() {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    void setRotation(uint8_t r)
+    {
+        rotation = r & 3;
+        _width = (rotation & 1) ? HEIGHT : WIDTH;
+        _height = (rotation & 1) ? WIDTH : HEIGHT;
+    }
+
+    uint8_t getRotation() const { return rotation; }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+    {
+        for (int16_t i = x; i < x + w; i++) {
+            for (int16_t j = y; j < y + h; j++) {
+                drawPixel(i, j, color);
+            }
+        }
+    }
+
+    virtual void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { fillRect(x, y, w, 1, color); }
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { fillRect(x, y, 1, h, color); }
+
+    /**
+     * Bresenham line, same steps as the library's writeLine
+     */
+    virtual void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+    {
+        bool steep = abs(y1 - y0) > abs(x1 - x0);
+        if (steep) {
+            swap(x0, y0);
+            swap(x1, y1);
+        }
+        if (x0 > x1) {
+            swap(x0, x1);
+            swap(y0, y1);
+        }
+
+        int16_t dx = x1 - x0;
+        int16_t dy = abs(y1 - y0);
+        int16_t err = dx / 2;
+        int16_t ystep = y0 < y1 ? 1 : -1;
+        for (; x0 <= x1; x0++) {
+            if (steep) {
+                drawPixel(y0, x0, color);
+            } else {
+                drawPixel(x0, y0, color);
+            }
+            err -= dy;
+            if (err < 0) {
+                y0 += ystep;
+                err += dx;
+            }
+        }
+    }
+
+    virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+    {
+        drawFastHLine(x, y, w, color);
+        drawFastHLine(x, y + h - 1, w, color);
+        drawFastVLine(x, y, h, color);
+        drawFastVLine(x + w - 1, y, h, color);
+    }
+
+    void setFont(const GFXfont* f) { gfxFont = f; }
+    void setTextColor(uint16_t c) { textcolor = c; }
+    void setTextSize(uint8_t s) { textsize = s > 0 ? s : 1; }
+    void setTextWrap(bool w) { wrap = w; }
+    void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+    int16_t getCursorX() const { return cursor_x; }
+    int16_t getCursorY() const { return cursor_y; }
+
+    /**
+     * Bounding box of a string printed at (x, y) with the current font
+     */
+    void getTextBounds(const char* str, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h)
+    {
+        int16_t minx = _width, miny = _height, maxx = -1, maxy = -1;
+        *x1 = x;
+        *y1 = y;
+        *w = *h = 0;
+        for (; *str; str++) {
+            charBounds(*str, &x, &y, &minx, &miny, &maxx, &maxy);
+        }
+        if (maxx >= minx) {
+            *x1 = minx;
+            *w = maxx - minx + 1;
+        }
+        if (maxy >= miny) {
+            *y1 = miny;
+            *h = maxy - miny + 1;
+        }
+    }
+
+    size_t print(const char* str)
+    {
+        size_t n = 0;
+        for (; *str; str++, n++) {
+            write(*str);
+        }
+        return n;
+    }
+
+    size_t print(const String& str) { return print(str.c_str()); }
+
+    size_t write(uint8_t c)
+    {
+        if (gfxFont == nullptr) {
+            return 1;  // The firmware always sets a font
+        }
+        if (c == '\n') {
+            cursor_x = 0;
+            cursor_y += textsize * gfxFont->yAdvance;
+        } else if (c != '\r' && c >= gfxFont->first && c <= gfxFont->last) {
+            const GFXglyph& glyph = gfxFont->glyph[c - gfxFont->first];
+            if (glyph.width > 0 && glyph.height > 0 && wrap &&
+                cursor_x + textsize * (glyph.xOffset + glyph.width) > _width) {
+                cursor_x = 0;
+                cursor_y += textsize * gfxFont->yAdvance;
+            }
+            drawChar(cursor_x, cursor_y, glyph, textcolor, textsize);
+            cursor_x += glyph.xAdvance * textsize;
+        }
+        return 1;
+    }
+
+protected:
+    const int16_t WIDTH;
+    const int16_t HEIGHT;
+    int16_t _width;
+    int16_t _height;
+    uint8_t rotation;
+
+private:
+    int16_t cursor_x;
+    int16_t cursor_y;
+    uint16_t textcolor;
+    uint8_t textsize;
+    bool wrap;
+    const GFXfont* gfxFont;
+
+    static void swap(int16_t& a, int16_t& b)
+    {
+        int16_t t = a;
+        a = b;
+        b = t;
+    }
+
+    void drawChar(int16_t x, int16_t y, const GFXglyph& glyph, uint16_t color, uint8_t size)
+    {
+        const uint8_t* bitmap = gfxFont->bitmap + glyph.bitmapOffset;
+        uint8_t bits = 0;
+        uint8_t bit = 0;
+        for (int16_t yy = 0; yy < glyph.height; yy++) {
+            for (int16_t xx = 0; xx < glyph.width; xx++) {
+                if (!(bit++ & 7)) {
+                    bits = *bitmap++;
+                }
+                if (bits & 0x80) {
+                    if (size == 1) {
+                        drawPixel(x + glyph.xOffset + xx, y + glyph.yOffset + yy, color);
+                    } else {
+                        fillRect(x + (glyph.xOffset + xx) * size, y + (glyph.yOffset + yy) * size, size, size, color);
+                    }
+                }
+                bits <<= 1;
+            }
+        }
+    }
+
+    void charBounds(unsigned char c, int16_t* x, int16_t* y,
+                    int16_t* minx, int16_t* miny, int16_t* maxx, int16_t* maxy)
+    {
+        if (gfxFont == nullptr) {
+            return;
+        }
+        if (c == '\n') {
+            *x = 0;
+            *y += textsize * gfxFont->yAdvance;
+            return;
+        }
+        if (c == '\r' || c < gfxFont->first || c > gfxFont->last) {
+            return;
+        }
+
+        const GFXglyph& glyph = gfxFont->glyph[c - gfxFont->first];
+        if (wrap && *x + (glyph.xOffset + glyph.width) * textsize > _width) {
+            *x = 0;
+            *y += textsize * gfxFont->yAdvance;
+        }
+        int16_t x1 = *x + glyph.xOffset * textsize;
+        int16_t y1 = *y + glyph.yOffset * textsize;
+        int16_t x2 = x1 + glyph.width * textsize - 1;
+        int16_t y2 = y1 + glyph.height * textsize - 1;
+        if (x1 < *minx) *minx = x1;
+        if (y1 < *miny) *miny = y1;
+        if (x2 > *maxx) *maxx = x2;
+        if (y2 > *maxy) *maxy = y2;
+        *x += glyph.xAdvance * textsize;
+    }
+};
+
+#endif // HOST_ADAFRUIT_GFX_H
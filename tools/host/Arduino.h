@@ -0,0 +1,79 @@
+/***
+ * Host stand-in for the parts of Arduino.h the rendering code uses
+ *
+ * String, min/max/constrain, PI and the PROGMEM accessors, enough to
+ * compile DashboardRenderer over a Framebuffer on the host.
+ * Used by: make sim-framebuffer
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_pointer(addr) (*(void* const*)(addr))
+
+template <typename T>
+T min(T a, T b) { return a < b ? a : b; }
+
+template <typename T>
+T max(T a, T b) { return a > b ? a : b; }
+
+template <typename T>
+T constrain(T value, T low, T high) { return value < low ? low : (value > high ? high : value); }
+
+/**
+ * Arduino String over std::string (the members the firmware calls)
+ */
+class String {
+public:
+    String(const char* text = "") : text(text ? text : "") {}
+    String(const std::string& text) : text(text) {}
+    explicit String(int value) : text(std::to_string(value)) {}
+    explicit String(long value) : text(std::to_string(value)) {}
+    explicit String(unsigned int value) : text(std::to_string(value)) {}
+    explicit String(unsigned long value) : text(std::to_string(value)) {}
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+
+    int indexOf(const char* needle) const
+    {
+        size_t pos = text.find(needle);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+
+    String substring(unsigned int from) const
+    {
+        return from < text.size() ? String(text.substr(from)) : String();
+    }
+
+    String substring(unsigned int from, unsigned int to) const
+    {
+        return from < to && from < text.size() ? String(text.substr(from, to - from)) : String();
+    }
+
+    String& operator+=(const String& other) { text += other.text; return *this; }
+    String& operator+=(const char* other) { text += other; return *this; }
+    String& operator+=(char c) { text += c; return *this; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.text + b.text); }
+    friend String operator+(const String& a, const char* b) { return String(a.text + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b.text); }
+
+private:
+    std::string text;
+};
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,13 @@
+/***
+ * Host stand-in for GxEPD2.h: the color constants
+ * Used by: make sim-framebuffer
+ */
+
+#ifndef HOST_GXEPD2_H
+#define HOST_GXEPD2_H
+
+#define GxEPD_BLACK 0x0000
+#define GxEPD_WHITE 0xFFFF
+#define GxEPD_RED   0xF800
+
+#endif // HOST_GXEPD2_H
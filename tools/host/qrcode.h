@@ -0,0 +1,29 @@
+/***
+ * Host stand-in for qrcode.h: declarations only
+ *
+ * Lets DashboardRenderer compile; the configuration screen (the only QR
+ * code user) is not drawn on the host, so nothing is defined.
+ * Used by: make sim-framebuffer
+ */
+
+#ifndef HOST_QRCODE_H
+#define HOST_QRCODE_H
+
+#include <stdint.h>
+
+#define ECC_MEDIUM 1
+
+typedef struct QRCode {
+    uint8_t version;
+    uint8_t size;
+    uint8_t ecc;
+    uint8_t mode;
+    uint8_t mask;
+    uint8_t* modules;
+} QRCode;
+
+uint16_t qrcode_getBufferSize(uint8_t version);
+int8_t qrcode_initText(QRCode* qrcode, uint8_t* modules, uint8_t version, uint8_t ecc, const char* data);
+bool qrcode_getModule(QRCode* qrcode, uint8_t x, uint8_t y);
+
+#endif // HOST_QRCODE_H
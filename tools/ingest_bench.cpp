@@ -0,0 +1,235 @@
+/***
+ * Payload ingestion benchmark (host)
+ *
+ * Compares peak RAM of the two ways of ingesting the plant payload while the
+ * payload grows: buffering the whole message and deserializing all of it
+ * (the old path), and streaming it through PAYLOAD_STREAM_BUFFER into the
+ * filtered dashboard document (PayloadIngest).
+ *
+ * Heap use is measured with a counting allocator behind the documents and
+ * the stream buffer, so the streamed peak is what the parse allocates, not
+ * the configured sizes. Payloads grow three ways: fields the dashboard
+ * ignores (history, metadata, the way a Home Assistant export tends to
+ * grow), the number of plants and the length of their names. Past
+ * DASHBOARD_JSON_CAPACITY the parse keeps the plants that fit. A last table
+ * grows a fleet payload (one section per display) and shows the filtered
+ * document of one display staying constant.
+ *
+ * Build and run: make bench-ingest
+ */
+
+#include <sstream>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ArduinoJson.h>
+#include "DashboardParser.h"
+
+namespace {
+    size_t heapInUse = 0;
+    size_t heapPeak = 0;
+    
+    /**
+     * Heap allocator counting the bytes in use and their high-water mark
+     */
+    struct CountingAllocator {
+        void* allocate(size_t size)
+        {
+            size_t* block = static_cast<size_t*>(malloc(sizeof(size_t) + size));
+            if (block == nullptr) {
+                return nullptr;
+            }
+            *block = size;
+            heapInUse += size;
+            if (heapInUse > heapPeak) {
+                heapPeak = heapInUse;
+            }
+            return block + 1;
+        }
+        
+        void deallocate(void* ptr)
+        {
+            if (ptr != nullptr) {
+                size_t* block = static_cast<size_t*>(ptr) - 1;
+                heapInUse -= *block;
+                free(block);
+            }
+        }
+        
+        void* reallocate(void* ptr, size_t size)
+        {
+            void* moved = allocate(size);
+            if (moved != nullptr && ptr != nullptr) {
+                size_t old = *(static_cast<size_t*>(ptr) - 1);
+                memcpy(moved, ptr, old < size ? old : size);
+                deallocate(ptr);
+            }
+            return moved;
+        }
+    };
+    
+    typedef BasicJsonDocument<CountingAllocator> CountedDocument;
+    
+    /**
+     * Payload with history samples per plant, names padded to nameLength
+     */
+    std::string makePayload(int plants, int nameLength, int historySamples)
+    {
+        std::string payload = "{\"seq\":42,\"updateDate\":\"2025-10-03 22:30\",\"source\":\"home-assistant\",\"plants\":[";
+        for (int i = 0; i < plants; i++) {
+            char name[16];
+            snprintf(name, sizeof(name), "Plant %02d", i + 1);
+            std::string padded(name);
+            if ((int)padded.size() < nameLength) {
+                padded.resize(nameLength, 'x');
+            }
+            
+            char plant[192];
+            snprintf(plant, sizeof(plant), "%s{\"name\":\"%s\",\"moisture\":%d,\"entity\":\"sensor.plant_%02d_moisture\",\"history\":[",
+                     i ? "," : "", padded.c_str(), (i * 37) % 100, i + 1);
+            payload += plant;
+            for (int s = 0; s < historySamples; s++) {
+                char sample[16];
+                snprintf(sample, sizeof(sample), "%s%d", s ? "," : "", (i + s) % 100);
+                payload += sample;
+            }
+            payload += "]}";
+        }
+        payload += "]}";
+        return payload;
+    }
+    
+    /**
+     * Fleet payload with a 6-plant section per display
+     */
+    std::string makeFleetPayload(int displays)
+    {
+        std::string payload = "{\"seq\":42,\"updateDate\":\"2025-10-03 22:30\",\"fleet\":{";
+        for (int d = 0; d < displays; d++) {
+            char section[64];
+            snprintf(section, sizeof(section), "%s\"display-%02d\":{\"plants\":[", d ? "," : "", d);
+            payload += section;
+            for (int i = 0; i < 6; i++) {
+                char plant[64];
+                snprintf(plant, sizeof(plant), "%s{\"name\":\"Plant %02d\",\"moisture\":%d}",
+                         i ? "," : "", d * 6 + i, (d * 6 + i) % 100);
+                payload += plant;
+            }
+            payload += "]}";
+        }
+        return payload + "}}";
+    }
+    
+    /**
+     * Result of one ingestion
+     */
+    struct Ingest {
+        size_t peak;            // Heap high-water mark (bytes)
+        size_t document;        // Document in use
+        int kept;               // Plants the model would take
+        const char* status;
+    };
+    
+    /**
+     * Old path: whole message in memory, every field deserialized
+     * The document is sized to the need measured on a first pass, the
+     * smallest the old path could have worked with.
+     */
+    Ingest buffered(const std::string& payload)
+    {
+        DynamicJsonDocument probe(payload.size() * 4 + 1024);
+        deserializeJson(probe, payload.c_str(), payload.size());
+        
+        heapInUse = heapPeak = 0;
+        CountingAllocator allocator;
+        char* message = static_cast<char*>(allocator.allocate(payload.size()));
+        memcpy(message, payload.data(), payload.size());
+        CountedDocument full(probe.memoryUsage());
+        DeserializationError error = deserializeJson(full, message, payload.size());
+        allocator.deallocate(message);
+        
+        Ingest result = {heapPeak, full.memoryUsage(), (int)full["plants"].size(), error ? error.c_str() : "ok"};
+        return result;
+    }
+    
+    /**
+     * Streamed path: bytes read incrementally through the stream buffer,
+     * only dashboard fields kept
+     * The payload text stands in for the socket and is not counted.
+     */
+    Ingest streamed(const std::string& payload, const char* nodeName, const char* section)
+    {
+        heapInUse = heapPeak = 0;
+        CountingAllocator allocator;
+        void* streamBuffer = allocator.allocate(PAYLOAD_STREAM_BUFFER);
+        std::istringstream input(payload);
+        CountedDocument filtered(DASHBOARD_JSON_CAPACITY);
+        DeserializationError error = dashboard_deserialize(filtered, nodeName, input);
+        allocator.deallocate(streamBuffer);
+        
+        // Same plants the model takes (DashboardParser.cpp)
+        bool truncated = error == DeserializationError::NoMemory && !filtered.isNull();
+        JsonVariantConst root = filtered.as<JsonVariantConst>();
+        JsonArrayConst plants = (section ? root["fleet"][section]["plants"] : root["plants"]).as<JsonArrayConst>();
+        int kept = 0;
+        for (JsonObjectConst plant : plants) {
+            if (kept == MAX_PLANTS || (truncated && !plant.containsKey("moisture"))) {
+                break;
+            }
+            kept++;
+        }
+        
+        Ingest result = {heapPeak, filtered.memoryUsage(), kept,
+                         truncated ? "partial" : (error ? error.c_str() : "ok")};
+        return result;
+    }
+}
+
+int main()
+{
+    printf("Parse buffer: %u bytes (DASHBOARD_JSON_CAPACITY), stream buffer: %u bytes\n",
+           (unsigned)DASHBOARD_JSON_CAPACITY, (unsigned)PAYLOAD_STREAM_BUFFER);
+    
+    printf("\nIgnored fields grow (%d plants, history samples per plant)\n", MAX_PLANTS);
+    printf("%8s %9s  %17s  %27s\n", "", "", "buffered (old)", "streamed (PayloadIngest)");
+    printf("%8s %9s  %8s %8s  %8s %8s %4s %4s\n",
+           "samples", "payload", "document", "peak", "document", "peak", "kept", "");
+    for (int samples = 0; samples <= 512; samples = samples ? samples * 2 : 4) {
+        std::string payload = makePayload(MAX_PLANTS, 8, samples);
+        Ingest old = buffered(payload);
+        Ingest now = streamed(payload, "e-paper-display", nullptr);
+        printf("%8d %9u  %8u %8u  %8u %8u %4d %s\n", samples, (unsigned)payload.size(),
+               (unsigned)old.document, (unsigned)old.peak,
+               (unsigned)now.document, (unsigned)now.peak, now.kept, now.status);
+    }
+    
+    printf("\nPlants and name length grow (no ignored fields)\n");
+    printf("%6s %5s %9s  %8s %8s  %8s %8s %4s %4s\n",
+           "plants", "name", "payload", "document", "peak", "document", "peak", "kept", "");
+    const int nameLengths[] = {8, PLANT_NAME_LEN - 1, 2 * PLANT_NAME_LEN};
+    for (int nameLength : nameLengths) {
+        for (int plants = 6; plants <= 4 * MAX_PLANTS; plants *= 2) {
+            std::string payload = makePayload(plants, nameLength, 0);
+            Ingest old = buffered(payload);
+            Ingest now = streamed(payload, "e-paper-display", nullptr);
+            printf("%6d %5d %9u  %8u %8u  %8u %8u %4d %s\n", plants, nameLength, (unsigned)payload.size(),
+                   (unsigned)old.document, (unsigned)old.peak,
+                   (unsigned)now.document, (unsigned)now.peak, now.kept, now.status);
+        }
+    }
+    
+    printf("\nFleet payload grows (6 plants per display, section of display-00)\n");
+    printf("%8s %9s  %8s %8s %4s %s\n", "displays", "payload", "document", "peak", "kept", "");
+    for (int displays = 1; displays <= 128; displays *= 2) {
+        std::string payload = makeFleetPayload(displays);
+        Ingest now = streamed(payload, "display-00", "display-00");
+        printf("%8d %9u  %8u %8u %4d %s\n", displays, (unsigned)payload.size(),
+               (unsigned)now.document, (unsigned)now.peak, now.kept, now.status);
+    }
+    
+    printf("\nPeak counts the heap allocated during the parse: the stream buffer and the\n"
+           "parse buffer when streamed, the message and a document just large enough\n"
+           "when buffered. \"partial\": the parse buffer filled, the plants that fit are kept.\n");
+    return 0;
+}
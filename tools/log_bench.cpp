@@ -0,0 +1,186 @@
+/***
+ * Logging benchmark (host)
+ *
+ * Runs the log calls of a typical wake (same messages and levels as the
+ * firmware) between sleeps standing in for WiFi, MQTT, the retained wait
+ * and the panel refresh, against a sink that blocks like the UART at
+ * 115200 baud. Each run is timed twice: lines written by the caller, as
+ * Serial.printf did, and queued for the log task, including the flush
+ * before deep sleep.
+ *
+ * The log level is a build flag, so `make bench-log` builds this file for
+ * a verbose (LOG_LEVEL 5) and a release (LOG_LEVEL 3) image and runs both.
+ * Payload dumps are truncated to LOG_LINE_MAX in both modes; the old
+ * Serial.printf of a 1 KB payload blocked for ~90 ms on its own.
+ *
+ * Build and run: make bench-log
+ */
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <stdio.h>
+#include <string.h>
+#include "Config.h"
+#include "Log.h"
+
+namespace {
+    const double UART_BAUD = 115200.0;
+    
+    unsigned long uartLines = 0;
+    unsigned long uartBytes = 0;
+    double uartBusyMs = 0;
+    
+    /**
+     * UART at 115200 baud, 8N1: 10 bits per byte, line ending included
+     */
+    void uartSink(const char* line, size_t length)
+    {
+        (void)line;
+        double ms = (length + 2) * 10 * 1000.0 / UART_BAUD;
+        uartLines++;
+        uartBytes += length + 2;
+        uartBusyMs += ms;
+        std::this_thread::sleep_for(std::chrono::microseconds((long)(ms * 1000)));
+    }
+    
+    void work(int ms)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+    
+    double since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    /**
+     * Log calls of one wake, with the time spent waiting between them
+     */
+    void runWake(const std::string& payload)
+    {
+        LOGI("\n=== Plant Moisture Monitor ===\n");
+        LOGI("Firmware: WiFi + MQTT + Deep Sleep");
+        work(100);
+        LOGI("\nGPIO4 state: %s", "HIGH (normal mode)");
+        LOGI("Config needed: %s", "checking settings...");
+        LOGI("Node: %s", "e-paper-display");
+        LOGI("\n=== Starting Normal Operation ===\n");
+        
+        LOGI("Initializing battery sensor...");
+        LOGD("I2C bus initialized");
+        LOGD("I2C device detected at 0x36");
+        work(20);
+        LOGI("MAX1704X battery fuel gauge initialized!");
+        LOGI("Battery voltage: %.2fV", 3.95);
+        LOGI("Battery percentage: %.1f%%", 85.0);
+        LOGI("Charge rate: %.2f%%/hr", -0.52);
+        
+        LOGD("Initializing display...");
+        LOGD("Display initialized");
+        LOGD("Header pre-rendered (%s, page %d/%d)", "2025-10-03 22:30", 1, 1);
+        LOGI("Connecting to WiFi using saved credentials...");
+        work(900);
+        LOGD("[Net] %s -> %s", "WIFI_CONNECTING", "WIFI_CONNECTED");
+        LOGI("WiFi connected to: %s", "greenhouse");
+        LOGI("IP address: %s", "192.168.1.42");
+        
+        LOGI("Connecting to MQTT broker: %s:%d", "192.168.1.10", 1883);
+        work(120);
+        LOGI("MQTT connected!");
+        LOGD("[Net] %s -> %s", "MQTT_CONNECTING", "READY");
+        LOGI("Checking for OTA update on: %s", "displays/e-paper-display/rx");
+        LOGD("Subscribing to topic: %s", "displays/e-paper-display/rx");
+        work(150);
+        LOGI("No OTA update pending");
+        
+        LOGI("Subscribing to: %s", "plants/dashboard");
+        LOGD("Subscribing to topic: %s", "plants/dashboard");
+        LOGD("Waiting for retained message...");
+        work(150);
+        LOGD("MQTT message received on topic %s: %u bytes", "plants/dashboard", (unsigned)payload.size());
+        LOGV("Payload: %s", payload.c_str());
+        LOGI("Received plant data from MQTT");
+        for (int i = 0; i < MAX_PLANTS; i++) {
+            LOGD("Plant %d: %s = %d%%", i + 1, "Calathea Orbifolia", (i * 37) % 100);
+        }
+        LOGI("Total plants: %d (parse buffer %u/%u bytes)", MAX_PLANTS, 1504u, 2128u);
+        work(15);
+        
+        LOGD("Layout: %dx%d %s of %dx%d, page %d/%d (plants %d-%d of %d)",
+             2, 12, "bars", 200, 24, 1, 1, 1, MAX_PLANTS, MAX_PLANTS);
+        work(600);
+        LOGI("[Refresh] %s (%s): estimated %lu ms, took %lu ms, %lu bytes%s",
+             "partial", "values changed", 620ul, 598ul, 15000ul, "");
+        LOGI("Display updated successfully!");
+        
+        const char* status = "{\"battery_voltage\":3.95,\"battery_percent\":85,\"charge_rate\":-0.52,"
+                             "\"rssi\":-61,\"firmware\":110,\"refresh\":\"partial\"}";
+        LOGD("Publishing to %s: %u bytes", "displays/e-paper-display/lwt", (unsigned)strlen(status));
+        LOGV("Payload: %s", status);
+        work(10);
+        
+        LOGI("\n=== Operation Complete ===\n");
+        LOGD("Loop task stack free (min): %u bytes", 12569u);
+        LOGI("Entering deep sleep for %d hour(s)...", 1);
+        LOGI("To enter config mode, connect GPIO4 to GND before reset");
+        LOGI("Entering deep sleep for %d hour(s)...", 1);
+        LOGD("Preparing peripherals for deep sleep...");
+        LOGD("Putting battery gauge to sleep...");
+        LOGD("Shutting down I2C and SPI buses...");
+        LOGD("Configuring GPIOs for low-power state...");
+        LOGD("Disabling RTC power domains...");
+        LOGI("Deep sleep preparation complete!");
+    }
+    
+    std::string makePayload()
+    {
+        std::string payload = "{\"updateDate\":\"2025-10-03 22:30\",\"plants\":[";
+        for (int i = 0; payload.size() < 1000; i++) {
+            char plant[64];
+            snprintf(plant, sizeof(plant), "%s{\"name\":\"Calathea Orbifolia %d\",\"moisture\":%d}",
+                     i ? "," : "", i + 1, (i * 37) % 100);
+            payload += plant;
+        }
+        return payload + "]}";
+    }
+    
+    double idleMs()
+    {
+        return 100 + 20 + 900 + 120 + 150 + 150 + 15 + 600 + 10;
+    }
+}
+
+int main()
+{
+    std::string payload = makePayload();
+    
+    // Lines written by the caller (Serial.printf)
+    log_set_sink(uartSink, true);
+    auto start = std::chrono::steady_clock::now();
+    runWake(payload);
+    double inlineMs = since(start);
+    unsigned long lines = uartLines;
+    unsigned long bytes = uartBytes;
+    double busyMs = uartBusyMs;
+    
+    // Lines queued for the log task, flushed before sleep
+    uartLines = 0;
+    log_set_sink(uartSink, false);
+    log_init();
+    start = std::chrono::steady_clock::now();
+    runWake(payload);
+    double queuedMs = since(start);
+    log_flush(LOG_FLUSH_TIMEOUT_MS);
+    double flushMs = since(start) - queuedMs;
+    
+    printf("LOG_LEVEL %d: %lu lines, %lu bytes, UART busy %.0f ms\n", LOG_LEVEL, lines, bytes, busyMs);
+    printf("  %-24s %8s %8s %8s\n", "", "wake", "logging", "flush");
+    printf("  %-24s %6.0f ms %6.0f ms %8s\n", "inline (Serial.printf)", inlineMs, inlineMs - idleMs(), "-");
+    printf("  %-24s %6.0f ms %6.0f ms %5.0f ms\n", "queued (log task)", queuedMs + flushMs,
+           queuedMs + flushMs - idleMs(), flushMs);
+    if (uartLines != lines) {
+        printf("  queued: %lu of %lu lines written (ring of %d full)\n", uartLines, lines, LOG_RING_SLOTS);
+    }
+    return 0;
+}
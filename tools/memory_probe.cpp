@@ -0,0 +1,194 @@
+/***
+ * Memory probe (host)
+ *
+ * Runs the loop task's dashboard work (MessagePack decode, delta merge,
+ * layout of every page) and the parser task's decode on threads with
+ * painted stacks of the firmware's configured sizes, sampling with the
+ * firmware's MemoryProbe at each phase boundary. Prints the per-phase
+ * table and the stack each thread used below its entry point.
+ *
+ * Host frames are not Xtensa frames (the windowed ABI uses more stack),
+ * so the numbers rank phases and show growth between builds; size the
+ * device stacks from the stack_free values of the LWT.
+ *
+ * Build and run: make probe-memory
+ */
+
+#include <pthread.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "MemoryProbe.h"
+#include "DashboardModel.h"
+#include "DashboardMsgPack.h"
+#include "DashboardLayout.h"
+
+namespace {
+    const uint32_t LOOP_STACK_SIZE = 16384;  // CONFIG_ARDUINO_LOOP_STACK_SIZE in platformio.ini
+    const int PLANTS = MAX_PLANTS;
+
+    /**
+     * Byte source over a buffer for the MessagePack decoder
+     */
+    struct BufferSource {
+        const uint8_t* pos;
+        const uint8_t* end;
+
+        int read() { return pos < end ? *pos++ : -1; }
+    };
+
+    void packString(std::vector<uint8_t>& out, const std::string& s)
+    {
+        if (s.size() < 32) {
+            out.push_back(0xa0 | s.size());
+        } else {
+            out.push_back(0xd9);
+            out.push_back(s.size());
+        }
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    void packArray(std::vector<uint8_t>& out, size_t count)
+    {
+        if (count < 16) {
+            out.push_back(0x90 | count);
+        } else {
+            out.push_back(0xdc);
+            out.push_back(count >> 8);
+            out.push_back(count & 0xff);
+        }
+    }
+
+    std::vector<uint8_t> makeMsgPack(int plants)
+    {
+        std::vector<uint8_t> out;
+        packArray(out, 3);
+        out.push_back(DASHBOARD_MSGPACK_VERSION);
+        packString(out, "2025-10-03 22:30");
+        packArray(out, plants);
+        for (int i = 0; i < plants; i++) {
+            char name[32];
+            snprintf(name, sizeof(name), "Calathea Orbifolia %d", i + 1);
+            packArray(out, 2);
+            packString(out, name);
+            out.push_back((i * 37) % 100);  // positive fixint
+        }
+        return out;
+    }
+
+    // Models are globals in the firmware too (kept off the loop task stack)
+    std::vector<uint8_t> payload;
+    DashboardModel dashboard;
+    DashboardModel update;
+
+    struct Task {
+        const char* name;
+        uint32_t size;
+        void (*body)();
+        uint8_t* stackTop;      // End of the painted region
+        uint32_t stackRegion;   // Painted bytes
+        uint32_t entryUsed;     // Thread descriptor, TLS and entry frames
+    };
+
+    void decode()
+    {
+        BufferSource source = {payload.data(), payload.data() + payload.size()};
+        uint32_t totalPlants;
+        if (!dashboard_decode_msgpack(source, update, totalPlants)) {
+            fprintf(stderr, "decode failed\n");
+            exit(1);
+        }
+    }
+
+    void loopBody()
+    {
+        decode();
+        memory_probe_sample("decode");
+
+        dashboard.applyUpdate(update);
+        memory_probe_sample("merge");
+
+        DashboardLayout layout = DashboardLayout::compute(dashboard.plantCount, 400, 300, 28, 0);
+        for (int page = 1; page < layout.pageCount; page++) {
+            DashboardLayout::compute(dashboard.plantCount, 400, 300, 28, page);
+        }
+        memory_probe_sample("layout");
+    }
+
+    void parserBody()
+    {
+        decode();
+        memory_probe_sample("parse");
+    }
+
+    void* taskMain(void* param)
+    {
+        Task* task = static_cast<Task*>(param);
+        pthread_setname_np(pthread_self(), task->name);
+
+        // glibc keeps the thread descriptor and TLS at the top of the stack
+        uint8_t marker;
+        task->entryUsed = task->stackTop - &marker;
+
+        task->body();
+        return nullptr;
+    }
+
+    /**
+     * Run a task body on a painted stack of at least the given size
+     */
+    bool run(Task& task)
+    {
+        size_t size = task.size < PTHREAD_STACK_MIN ? PTHREAD_STACK_MIN : task.size;
+        size += 16384;  // Room for the thread descriptor and TLS on top
+        uint8_t* stack = static_cast<uint8_t*>(aligned_alloc(4096, size));
+        memory_probe_paint(stack, size);
+        task.stackTop = stack + size;
+        task.stackRegion = size;
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstack(&attr, stack, size);
+        pthread_t thread;
+        bool ok = pthread_create(&thread, &attr, taskMain, &task) == 0 &&
+                  pthread_join(thread, nullptr) == 0;
+        pthread_attr_destroy(&attr);
+        free(stack);
+        return ok;
+    }
+}
+
+int main()
+{
+    payload = makeMsgPack(PLANTS);
+    printf("Payload: %d plants, %u bytes MessagePack\n\n", PLANTS, (unsigned)payload.size());
+
+    Task tasks[] = {
+        {"loopTask", LOOP_STACK_SIZE, loopBody, nullptr, 0, 0},
+        {"parser", PARSER_TASK_STACK_SIZE, parserBody, nullptr, 0, 0},
+    };
+    for (Task& task : tasks) {
+        if (!run(task)) {
+            fprintf(stderr, "failed to run %s\n", task.name);
+            return 1;
+        }
+    }
+
+    memory_probe_print();
+
+    printf("\n%-10s %8s %8s %8s\n", "task", "used", "stack", "headroom");
+    const MemoryProbeReport& report = memory_probe_report();
+    for (const Task& task : tasks) {
+        for (int i = 0; i < report.stackCount; i++) {
+            if (strcmp(report.stacks[i].task, task.name) == 0) {
+                uint32_t used = task.stackRegion - report.stacks[i].minFree - task.entryUsed;
+                printf("%-10s %8u %8u %7.0f%%\n", task.name, (unsigned)used, (unsigned)task.size,
+                       100.0 * (task.size - (double)used) / task.size);
+            }
+        }
+    }
+    return 0;
+}
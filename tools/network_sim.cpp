@@ -0,0 +1,224 @@
+/***
+ * Network state machine simulation (host)
+ *
+ * Drives NetworkStateMachine through scripted scenarios with a fake
+ * transport and a simulated clock: late WiFi, failing broker, dropped
+ * connections, timeouts and shutdown. Prints every transition and checks
+ * the resulting state and status bits; exits non-zero on a mismatch.
+ *
+ * Build and run: make sim-network
+ */
+
+#include <stdio.h>
+#include "NetworkStateMachine.h"
+
+namespace {
+    const uint32_t WIFI_TIMEOUT = 30000;
+    const uint32_t MQTT_TIMEOUT = 10000;
+    const uint32_t RETRY = 500;
+
+    /**
+     * Transport recording calls, with scripted broker behavior
+     */
+    struct FakeTransport : NetworkTransport {
+        int wifiBegins = 0;
+        int wifiEnds = 0;
+        int connectAttempts = 0;
+        int disconnects = 0;
+        int failConnects = 0;       // Connect attempts to refuse before accepting
+        bool brokerUp = true;       // Polls fail while false
+
+        void wifiBegin() override { wifiBegins++; }
+        void wifiEnd() override { wifiEnds++; }
+        bool mqttConnect() override
+        {
+            connectAttempts++;
+            if (failConnects > 0) {
+                failConnects--;
+                return false;
+            }
+            return true;
+        }
+        void mqttDisconnect() override { disconnects++; }
+        bool mqttPoll() override { return brokerUp; }
+    };
+
+    /**
+     * Simulated network task: advances time to the next step the machine
+     * asks for, or to the next scripted event
+     */
+    struct Sim {
+        FakeTransport transport;
+        NetworkStateMachine machine;
+        uint32_t now;
+        NetState last;
+
+        Sim() : machine(transport, WIFI_TIMEOUT, MQTT_TIMEOUT, RETRY), now(0), last(NET_IDLE) {}
+
+        void trace()
+        {
+            if (machine.state() != last) {
+                printf("  %6lu ms  %s -> %s\n", (unsigned long)now,
+                       NetworkStateMachine::stateName(last),
+                       NetworkStateMachine::stateName(machine.state()));
+                last = machine.state();
+            }
+        }
+
+        void event(NetEvent ev)
+        {
+            machine.handle(ev, now);
+            trace();
+        }
+
+        /**
+         * Run the machine until the given time (0 ms waits cost 1 ms, like
+         * a socket poll slice)
+         */
+        void runUntil(uint32_t end)
+        {
+            while ((int32_t)(end - now) > 0) {
+                uint32_t wait = machine.step(now);
+                trace();
+                if (wait == 0) {
+                    wait = 1;
+                }
+                now = (int32_t)(end - now) < (int32_t)wait ? end : now + wait;
+            }
+        }
+    };
+
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            printf("  FAIL: %s\n", what);
+            failures++;
+        }
+    }
+
+    void scenario(const char* name)
+    {
+        printf("\n%s\n", name);
+    }
+}
+
+int main()
+{
+    {
+        scenario("WiFi up after 2 s, MQTT requested before it");
+        Sim sim;
+        sim.event(NET_EV_START_WIFI);
+        sim.event(NET_EV_START_MQTT);
+        sim.runUntil(2000);
+        expect(sim.machine.state() == NET_WIFI_CONNECTING, "still waiting for WiFi");
+        sim.event(NET_EV_WIFI_UP);
+        sim.runUntil(2100);
+        expect(sim.machine.state() == NET_ONLINE, "online");
+        expect((sim.machine.bits() & (NET_BIT_WIFI | NET_BIT_MQTT)) == (NET_BIT_WIFI | NET_BIT_MQTT), "wifi+mqtt bits");
+        expect(sim.transport.connectAttempts == 1, "one connect attempt");
+    }
+    {
+        scenario("MQTT requested after WiFi is up");
+        Sim sim;
+        sim.event(NET_EV_START_WIFI);
+        sim.event(NET_EV_WIFI_UP);
+        sim.runUntil(100);
+        expect(sim.machine.state() == NET_WIFI_READY, "wifi ready");
+        sim.event(NET_EV_START_MQTT);
+        sim.runUntil(200);
+        expect(sim.machine.state() == NET_ONLINE, "online");
+    }
+    {
+        scenario("Broker refuses 3 connects, then accepts");
+        Sim sim;
+        sim.transport.failConnects = 3;
+        sim.event(NET_EV_START_WIFI);
+        sim.event(NET_EV_START_MQTT);
+        sim.event(NET_EV_WIFI_UP);
+        sim.runUntil(3000);
+        expect(sim.machine.state() == NET_ONLINE, "online after retries");
+        expect(sim.transport.connectAttempts == 4, "four connect attempts");
+    }
+    {
+        scenario("Broker never accepts: MQTT timeout");
+        Sim sim;
+        sim.transport.failConnects = 1000;
+        sim.event(NET_EV_START_WIFI);
+        sim.event(NET_EV_START_MQTT);
+        sim.event(NET_EV_WIFI_UP);
+        sim.runUntil(MQTT_TIMEOUT + 2000);
+        expect(sim.machine.state() == NET_FAILED, "failed");
+        expect((sim.machine.bits() & NET_BIT_FAILED) != 0, "failed bit");
+        expect((sim.machine.bits() & NET_BIT_MQTT) == 0, "no mqtt bit");
+    }
+    {
+        scenario("WiFi never comes up: WiFi timeout");
+        Sim sim;
+        sim.event(NET_EV_START_WIFI);
+        sim.runUntil(WIFI_TIMEOUT + 1000);
+        expect(sim.machine.state() == NET_FAILED, "failed");
+        expect(sim.transport.connectAttempts == 0, "no connect attempt");
+    }
+    {
+        scenario("Broker drops the connection, reconnect");
+        Sim sim;
+        sim.event(NET_EV_START_WIFI);
+        sim.event(NET_EV_START_MQTT);
+        sim.event(NET_EV_WIFI_UP);
+        sim.runUntil(100);
+        sim.transport.brokerUp = false;
+        sim.runUntil(101);
+        expect(sim.machine.state() == NET_MQTT_RETRY, "retrying");
+        expect((sim.machine.bits() & NET_BIT_MQTT) == 0, "mqtt bit cleared");
+        sim.transport.brokerUp = true;
+        sim.runUntil(1000);
+        expect(sim.machine.state() == NET_ONLINE, "online again");
+        expect(sim.transport.connectAttempts == 2, "two connect attempts");
+    }
+    {
+        scenario("WiFi drops while online, comes back");
+        Sim sim;
+        sim.event(NET_EV_START_WIFI);
+        sim.event(NET_EV_START_MQTT);
+        sim.event(NET_EV_WIFI_UP);
+        sim.runUntil(100);
+        sim.event(NET_EV_WIFI_DOWN);
+        expect(sim.machine.bits() == 0, "all bits cleared");
+        sim.runUntil(1500);
+        sim.event(NET_EV_WIFI_UP);
+        sim.runUntil(1600);
+        expect(sim.machine.state() == NET_ONLINE, "online again");
+    }
+    {
+        scenario("Stop while online, then restart");
+        Sim sim;
+        sim.event(NET_EV_START_WIFI);
+        sim.event(NET_EV_START_MQTT);
+        sim.event(NET_EV_WIFI_UP);
+        sim.runUntil(100);
+        sim.event(NET_EV_STOP);
+        expect(sim.machine.state() == NET_STOPPED, "stopped");
+        expect(sim.machine.bits() == NET_BIT_STOPPED, "only stopped bit");
+        expect(sim.transport.disconnects == 1 && sim.transport.wifiEnds == 1, "broker and WiFi disconnected");
+        sim.event(NET_EV_WIFI_DOWN);
+        expect(sim.machine.state() == NET_STOPPED, "disconnect event ignored");
+        sim.event(NET_EV_START_WIFI);
+        expect(sim.machine.state() == NET_WIFI_CONNECTING && sim.machine.bits() == 0, "restarted");
+    }
+    {
+        scenario("Clock wraps during MQTT retries");
+        Sim sim;
+        sim.now = 0xFFFFFF00u;
+        sim.transport.failConnects = 2;
+        sim.event(NET_EV_START_WIFI);
+        sim.event(NET_EV_START_MQTT);
+        sim.event(NET_EV_WIFI_UP);
+        sim.runUntil(2000);
+        expect(sim.machine.state() == NET_ONLINE, "online across the wrap");
+    }
+
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+/***
+ * Payload format benchmark (host)
+ *
+ * Compares the JSON and MessagePack plant payloads by size and by the time
+ * to decode them into the DashboardModel, for growing plant counts. Both
+ * go through the same code as the firmware: the filtered JSON deserializer
+ * and the positional MessagePack decoder.
+ *
+ * Build and run: make bench-parse
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <ArduinoJson.h>
+#include "DashboardParser.h"
+#include "DashboardMsgPack.h"
+
+namespace {
+    const int ITERATIONS = 2000;
+
+    /**
+     * Byte source over a buffer for the MessagePack decoder
+     */
+    struct BufferSource {
+        const uint8_t* pos;
+        const uint8_t* end;
+
+        int read() { return pos < end ? *pos++ : -1; }
+    };
+
+    void packString(std::vector<uint8_t>& out, const std::string& s)
+    {
+        if (s.size() < 32) {
+            out.push_back(0xa0 | s.size());
+        } else {
+            out.push_back(0xd9);
+            out.push_back(s.size());
+        }
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    void packArray(std::vector<uint8_t>& out, size_t count)
+    {
+        if (count < 16) {
+            out.push_back(0x90 | count);
+        } else {
+            out.push_back(0xdc);
+            out.push_back(count >> 8);
+            out.push_back(count & 0xff);
+        }
+    }
+
+    std::string plantName(int i)
+    {
+        static const char* names[] = {"Dracanea Reflexa", "Ficus Lyrata", "Monstera", "Calathea Orbifolia"};
+        char name[48];
+        snprintf(name, sizeof(name), "%s %d", names[i % 4], i + 1);
+        return name;
+    }
+
+    std::string makeJson(int plants)
+    {
+        std::string json = "{\"updateDate\":\"2025-10-03 22:30\",\"plants\":[";
+        for (int i = 0; i < plants; i++) {
+            char plant[96];
+            snprintf(plant, sizeof(plant), "%s{\"name\":\"%s\",\"moisture\":%d}",
+                     i ? "," : "", plantName(i).c_str(), (i * 37) % 100);
+            json += plant;
+        }
+        return json + "]}";
+    }
+
+    std::vector<uint8_t> makeMsgPack(int plants)
+    {
+        std::vector<uint8_t> out;
+        packArray(out, 3);
+        out.push_back(DASHBOARD_MSGPACK_VERSION);
+        packString(out, "2025-10-03 22:30");
+        packArray(out, plants);
+        for (int i = 0; i < plants; i++) {
+            packArray(out, 2);
+            packString(out, plantName(i));
+            out.push_back((i * 37) % 100);  // positive fixint
+        }
+        return out;
+    }
+
+    /**
+     * Same copy the firmware does after the filtered deserialization
+     */
+    bool decodeJson(const std::string& json, DashboardModel& model)
+    {
+        DynamicJsonDocument doc(DASHBOARD_JSON_CAPACITY);
+        if (dashboard_deserialize(doc, "e-paper-display", json.c_str(), json.size())) {
+            return false;
+        }
+        model.clear();
+        model.setUpdateDate(doc["updateDate"] | "");
+        for (JsonObjectConst plant : doc["plants"].as<JsonArrayConst>()) {
+            model.addPlant(plant["name"] | "", plant["moisture"] | 0);
+        }
+        return true;
+    }
+
+    bool decodeMsgPack(const std::vector<uint8_t>& packed, DashboardModel& model)
+    {
+        BufferSource source = {packed.data(), packed.data() + packed.size()};
+        uint32_t totalPlants;
+        return dashboard_decode_msgpack(source, model, totalPlants);
+    }
+
+    template <typename Decode>
+    double microsPerDecode(Decode decode)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; i++) {
+            decode();
+        }
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / ITERATIONS;
+    }
+}
+
+int main()
+{
+    printf("%6s  %8s %8s %6s  %9s %9s %7s  %5s\n",
+           "plants", "json B", "mpack B", "size", "json us", "mpack us", "speed", "match");
+    
+    const int counts[] = {1, 3, 6, 12, 24};
+    for (int plants : counts) {
+        std::string json = makeJson(plants);
+        std::vector<uint8_t> packed = makeMsgPack(plants);
+        
+        DashboardModel fromJson, fromPack;
+        bool ok = decodeJson(json, fromJson) && decodeMsgPack(packed, fromPack) &&
+                  memcmp(&fromJson, &fromPack, sizeof(DashboardModel)) == 0;
+        
+        double jsonUs = microsPerDecode([&]() { decodeJson(json, fromJson); });
+        double packUs = microsPerDecode([&]() { decodeMsgPack(packed, fromPack); });
+        
+        printf("%6d  %8u %8u %5.0f%%  %9.2f %9.2f %6.1fx  %5s\n",
+               plants, (unsigned)json.size(), (unsigned)packed.size(),
+               100.0 * packed.size() / json.size(), jsonUs, packUs, jsonUs / packUs,
+               ok ? "yes" : "NO");
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+/***
+ * Refresh policy simulation (host)
+ *
+ * Runs RefreshPolicy against the panel types the firmware builds for
+ * (black/white with fast partial refresh, tri-color, and the tri-color-like
+ * framebuffer with every fast path) and checks its decisions: skip and
+ * unknown-panel cases, the dirty-area threshold, the ghosting budget that
+ * forces a full refresh, the mono/full choice with and without red, and
+ * the smoothed cost estimate. Exits non-zero on a mismatch.
+ *
+ * Build and run: make sim-refresh
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "Config.h"
+#include "RefreshPolicy.h"
+
+namespace {
+    const uint32_t SCREEN_AREA = 400 * 300;
+
+    const RefreshPolicy::PanelCaps BLACK_WHITE = {true, true, false, 3000, 700};
+    const RefreshPolicy::PanelCaps TRI_COLOR = {false, false, true, 16000, 16000};
+    const RefreshPolicy::PanelCaps FAST_TRI_COLOR = {true, true, true, 16000, 700};
+
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            printf("  FAIL: %s\n", what);
+            failures++;
+        }
+    }
+
+    RefreshPolicy::Frame frame(uint32_t dirtyPct, bool hasRed)
+    {
+        RefreshPolicy::Frame frame;
+        frame.panelKnown = true;
+        frame.changed = dirtyPct > 0;
+        frame.dirtyArea = SCREEN_AREA * dirtyPct / 100;
+        frame.screenArea = SCREEN_AREA;
+        frame.hasRed = hasRed;
+        return frame;
+    }
+
+    /**
+     * Decide, print and record as if refreshed at the estimated cost
+     */
+    RefreshMode step(const RefreshPolicy& policy, RefreshPolicy::History& history, const RefreshPolicy::Frame& frame)
+    {
+        RefreshPolicy::Decision decision = policy.decide(frame, history);
+        printf("    dirty %3lu%%, red %d -> %-7s (%s, ~%lu ms)\n",
+               (unsigned long)(frame.screenArea ? frame.dirtyArea * 100 / frame.screenArea : 0), frame.hasRed,
+               RefreshPolicy::modeName(decision.mode), decision.reason, (unsigned long)decision.estimatedMs);
+        policy.record(history, decision, decision.estimatedMs, frame.hasRed);
+        return decision.mode;
+    }
+
+    void basics()
+    {
+        printf("\nSkip and unknown panel\n");
+        RefreshPolicy policy(BLACK_WHITE);
+        RefreshPolicy::History history;
+        policy.reset(history);
+
+        RefreshPolicy::Frame unknown = frame(5, false);
+        unknown.panelKnown = false;
+        expect(step(policy, history, unknown) == REFRESH_FULL, "unknown panel content: full");
+        expect(step(policy, history, frame(0, false)) == REFRESH_SKIP, "unchanged: skip");
+    }
+
+    void areaThreshold()
+    {
+        printf("\nDirty area threshold (%d%%)\n", FULL_REFRESH_AREA_PCT);
+        RefreshPolicy policy(BLACK_WHITE);
+        RefreshPolicy::History history;
+        policy.reset(history);
+        step(policy, history, frame(100, false));
+
+        expect(step(policy, history, frame(FULL_REFRESH_AREA_PCT, false)) == REFRESH_PARTIAL,
+               "at the threshold: partial");
+        expect(step(policy, history, frame(FULL_REFRESH_AREA_PCT + 1, false)) == REFRESH_MONO,
+               "above the threshold: whole-screen mono");
+    }
+
+    void ghostingBudget()
+    {
+        printf("\nGhosting budget (%d fast refreshes)\n", FULL_REFRESH_INTERVAL);
+        RefreshPolicy policy(BLACK_WHITE);
+        RefreshPolicy::History history;
+        policy.reset(history);
+        RefreshPolicy::Frame cleared = frame(100, false);
+        cleared.panelKnown = false;
+        expect(step(policy, history, cleared) == REFRESH_FULL, "start from a full refresh");
+
+        int fast = 0;
+        RefreshMode mode = REFRESH_PARTIAL;
+        while (fast <= FULL_REFRESH_INTERVAL && (mode = step(policy, history, frame(5, false))) != REFRESH_FULL) {
+            fast++;
+        }
+        expect(mode == REFRESH_FULL && fast == FULL_REFRESH_INTERVAL, "full refresh after the budget of fast ones");
+        expect(history.ghosting == 0, "full refresh resets the budget");
+        expect(step(policy, history, frame(5, false)) == REFRESH_PARTIAL, "fast refreshes resume");
+    }
+
+    void monoOrFull()
+    {
+        printf("\nMono or full: black/white panel\n");
+        RefreshPolicy blackWhite(BLACK_WHITE);
+        RefreshPolicy::History history;
+        blackWhite.reset(history);
+        step(blackWhite, history, frame(100, true));
+        expect(step(blackWhite, history, frame(80, true)) == REFRESH_MONO, "alerts in black: mono");
+
+        printf("\nMono or full: tri-color panel without fast refresh\n");
+        RefreshPolicy triColor(TRI_COLOR);
+        triColor.reset(history);
+        step(triColor, history, frame(100, false));
+        expect(step(triColor, history, frame(5, false)) == REFRESH_FULL, "no fast path: full");
+
+        printf("\nMono or full: tri-color panel with fast refresh\n");
+        RefreshPolicy fast(FAST_TRI_COLOR);
+        fast.reset(history);
+        step(fast, history, frame(100, true));
+        expect(step(fast, history, frame(80, true)) == REFRESH_FULL, "red in the frame: full");
+        expect(step(fast, history, frame(80, false)) == REFRESH_FULL, "red left on the panel: full");
+        expect(step(fast, history, frame(80, false)) == REFRESH_MONO, "no red anywhere: mono");
+    }
+
+    void costEstimate()
+    {
+        printf("\nCost estimate\n");
+        RefreshPolicy policy(TRI_COLOR);
+        RefreshPolicy::History history;
+        policy.reset(history);
+        RefreshPolicy::Decision decision = policy.decide(frame(100, false), history);
+        expect(decision.estimatedMs == TRI_COLOR.fullMs, "nominal time before any measurement");
+
+        policy.record(history, decision, 20000, false);
+        policy.record(history, decision, 16000, false);
+        decision = policy.decide(frame(100, false), history);
+        printf("    measured 20000 then 16000 ms -> estimate %lu ms\n", (unsigned long)decision.estimatedMs);
+        expect(decision.estimatedMs == 19000, "measured times smoothed 3:1");
+    }
+}
+
+int main()
+{
+    basics();
+    areaThreshold();
+    ghostingBudget();
+    monoOrFull();
+    costEstimate();
+
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+/***
+ * RTC store check (host)
+ *
+ * Exercises the RtcStore record checks and the NVS write coalescing the
+ * device runs in rtc_store_open and rtc_store_seal: the CRC against its
+ * check value, records rejected for another identifier, layout version or
+ * size, for data changed after sealing and for a flipped bit, and the
+ * flash copies of records changing every wake, never, or only once, with
+ * and without a flush. Exits non-zero on a mismatch.
+ *
+ * Build and run: make sim-rtc
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "RtcStore.h"
+
+namespace {
+    const uint32_t MAGIC = 0x53494d31;  // "SIM1"
+    const uint16_t VERSION = 3;
+    
+    struct State {
+        uint32_t counter;
+        uint8_t page;
+        char name[11];
+    };
+    
+    int failures = 0;
+    
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            printf("  FAIL: %s\n", what);
+            failures++;
+        }
+    }
+    
+    /**
+     * RTC memory and the NVS copy of one record
+     */
+    struct Device {
+        RtcRecord<State> rtc;
+        RtcRecord<State> flash;
+        bool flashed;
+        int flashWrites;
+        
+        Device() : flashed(false), flashWrites(0)
+        {
+            memset(&rtc, 0, sizeof(rtc));
+            memset(&flash, 0, sizeof(flash));
+        }
+        
+        /**
+         * rtc_store_open: RTC copy if intact, else the NVS copy, else reset
+         */
+        bool open()
+        {
+            if (RtcStore::valid(rtc.header, MAGIC, VERSION, sizeof(State))) {
+                return true;
+            }
+            if (flashed && RtcStore::valid(flash.header, MAGIC, VERSION, sizeof(State))) {
+                rtc = flash;
+                return true;
+            }
+            RtcStore::init(rtc.header, MAGIC, VERSION, sizeof(State));
+            memset(&rtc.data, 0, sizeof(rtc.data));
+            return false;
+        }
+        
+        /**
+         * rtc_store_seal for this record
+         */
+        void seal(bool flush)
+        {
+            if (RtcStore::seal(rtc.header, flush)) {
+                RtcStore::markCopied(rtc.header);
+                flash = rtc;
+                flashed = true;
+                flashWrites++;
+            }
+        }
+    };
+    
+    void checks()
+    {
+        printf("\nCRC and record checks\n");
+        const char* vector = "123456789";
+        uint32_t crc = RtcStore::crc32(vector, strlen(vector));
+        printf("    crc32(\"%s\") = %08lx\n", vector, (unsigned long)crc);
+        expect(crc == 0xcbf43926u, "CRC32 check value");
+        expect(RtcStore::crc32(vector + 4, 5, RtcStore::crc32(vector, 4)) == crc, "CRC32 continues across calls");
+        
+        Device device;
+        expect(!device.open(), "zeroed memory is not a record");
+        device.rtc.data.counter = 7;
+        device.seal(false);
+        expect(device.open(), "sealed record opens");
+        
+        RtcRecord<State> other = device.rtc;
+        expect(!RtcStore::valid(other.header, MAGIC + 1, VERSION, sizeof(State)), "other identifier rejected");
+        expect(!RtcStore::valid(other.header, MAGIC, VERSION + 1, sizeof(State)), "other layout version rejected");
+        expect(!RtcStore::valid(other.header, MAGIC, VERSION, sizeof(State) - 4), "other size rejected");
+        
+        other.data.counter++;
+        expect(!RtcStore::valid(other.header, MAGIC, VERSION, sizeof(State)), "change after sealing not trusted");
+        other = device.rtc;
+        other.data.name[3] ^= 0x10;
+        expect(!RtcStore::valid(other.header, MAGIC, VERSION, sizeof(State)), "flipped bit (brownout) rejected");
+    }
+    
+    /**
+     * Wakes of a record; change(wake) sets its data before sealing
+     */
+    int run(Device& device, int wakes, void (*change)(State&, int), bool flush)
+    {
+        int before = device.flashWrites;
+        for (int wake = 0; wake < wakes; wake++) {
+            device.open();
+            change(device.rtc.data, wake);
+            device.seal(flush);
+        }
+        return device.flashWrites - before;
+    }
+    
+    void everyWake(State& state, int wake) { state.counter = wake + 1; }
+    void never(State& state, int wake) { (void)state; (void)wake; }
+    void firstWake(State& state, int wake) { if (wake == 0) state.page = 1; }
+    
+    void coalescing()
+    {
+        const int WAKES = 10 * RTC_NVS_WRITE_WAKES;
+        printf("\nNVS copies over %d wakes (one per %d changed seals)\n", WAKES, RTC_NVS_WRITE_WAKES);
+        
+        Device device;
+        int writes = run(device, WAKES, everyWake, false);
+        printf("    changing every wake: %d writes\n", writes);
+        expect(writes == WAKES / RTC_NVS_WRITE_WAKES, "one copy per RTC_NVS_WRITE_WAKES changed seals");
+        
+        writes = run(device, WAKES, never, false);
+        printf("    unchanged:           %d writes\n", writes);
+        expect(writes == 0, "unchanged data not copied");
+        expect(device.flash.data.counter == (uint32_t)WAKES, "copy caught up with the data");
+        
+        Device once;
+        writes = run(once, WAKES, firstWake, false);
+        printf("    changed once:        %d writes\n", writes);
+        expect(writes == 1, "a single change is copied once the budget is reached");
+        
+        Device flushed;
+        writes = run(flushed, 3, everyWake, true);
+        printf("    flushed every wake:  %d writes\n", writes);
+        expect(writes == 3, "flush copies changed data right away");
+        expect(run(flushed, 3, never, true) == 0, "flush skips unchanged data");
+        
+        // Changed back to the copied data before the budget ran out
+        Device back;
+        run(back, RTC_NVS_WRITE_WAKES, everyWake, false);
+        back.open();
+        back.rtc.data.counter = 99;
+        back.seal(false);
+        back.open();
+        back.rtc.data.counter = RTC_NVS_WRITE_WAKES;
+        back.seal(false);
+        expect(back.rtc.header.pending == 0, "data equal to the copy clears the pending seals");
+    }
+    
+    void powerLoss()
+    {
+        printf("\nPower loss\n");
+        Device device;
+        run(device, RTC_NVS_WRITE_WAKES + 2, everyWake, false);
+        printf("    RTC counter %lu, flash counter %lu\n",
+               (unsigned long)device.rtc.data.counter, (unsigned long)device.flash.data.counter);
+        
+        memset(&device.rtc, 0xa5, sizeof(device.rtc));
+        expect(device.open(), "restored from the NVS copy");
+        expect(device.rtc.data.counter == RTC_NVS_WRITE_WAKES, "copy is at most RTC_NVS_WRITE_WAKES wakes old");
+        expect(device.rtc.header.pending == 0, "restored record matches its copy");
+        
+        device.flash.header.version++;
+        memset(&device.rtc, 0, sizeof(device.rtc));
+        expect(!device.open(), "copy of an older layout reset");
+    }
+}
+
+int main()
+{
+    checks();
+    coalescing();
+    powerLoss();
+    
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}
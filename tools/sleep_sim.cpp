@@ -0,0 +1,178 @@
+/***
+ * Sleep scheduler simulation (host)
+ *
+ * Feeds SleepScheduler synthetic histories: data that stops changing, data
+ * that changes every wake, charging, low and critical battery, bounds and
+ * quiet hours. Prints each decision and checks it; exits non-zero on a
+ * mismatch. A last run follows one simulated week with a publisher that
+ * only updates during the day, and counts the wakes.
+ *
+ * Build and run: make sim-sleep
+ */
+
+#include <stdio.h>
+#include "SleepScheduler.h"
+
+namespace {
+    int failures = 0;
+    
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            printf("  FAIL: %s\n", what);
+            failures++;
+        }
+    }
+    
+    void scenario(const char* name)
+    {
+        printf("\n%s\n", name);
+    }
+    
+    SleepScheduler::Bounds bounds(int baseMinutes, int quietStart = -1, int quietEnd = -1)
+    {
+        SleepScheduler::Bounds b;
+        b.baseMinutes = baseMinutes;
+        b.minMinutes = SLEEP_MIN_MINUTES;
+        b.maxMinutes = SLEEP_MAX_MINUTES;
+        b.quietStart = quietStart;
+        b.quietEnd = quietEnd;
+        return b;
+    }
+    
+    SleepScheduler::Inputs battery(int percent, float chargeRate = -0.5f, int minuteOfDay = -1)
+    {
+        SleepScheduler::Inputs inputs;
+        inputs.batteryPercent = percent;
+        inputs.gaugePresent = true;
+        inputs.chargeRate = chargeRate;
+        inputs.minuteOfDay = minuteOfDay;
+        return inputs;
+    }
+    
+    /**
+     * Record one wake with the given readings and decide its sleep
+     */
+    SleepScheduler::Decision wake(const SleepScheduler& scheduler, SleepScheduler::History& history,
+                                  uint32_t data, const SleepScheduler::Inputs& inputs)
+    {
+        SleepScheduler::record(history, data);
+        SleepScheduler::Decision decision = scheduler.decide(inputs, history);
+        printf("  data %-3lu -> %4u min (%s)\n", (unsigned long)data, decision.minutes, decision.reason);
+        return decision;
+    }
+    
+    /**
+     * Decide the sleep of a wake without data history
+     */
+    SleepScheduler::Decision decide(const SleepScheduler& scheduler, const SleepScheduler::Inputs& inputs)
+    {
+        SleepScheduler::History history;
+        SleepScheduler::reset(history);
+        SleepScheduler::Decision decision = scheduler.decide(inputs, history);
+        printf("  battery %3d%% %+5.1f%%/h, time %5d -> %4u min (%s)\n", inputs.batteryPercent,
+               inputs.chargeRate, inputs.minuteOfDay, decision.minutes, decision.reason);
+        return decision;
+    }
+}
+
+int main()
+{
+    {
+        scenario("Data stops changing: interval stretched up to 4x");
+        SleepScheduler scheduler(bounds(60));
+        SleepScheduler::History history;
+        SleepScheduler::reset(history);
+        expect(wake(scheduler, history, 1, battery(80)).minutes == 60, "first wake: configured");
+        for (int i = 0; i < 2; i++) {
+            wake(scheduler, history, 1, battery(80));
+        }
+        expect(history.unchanged == 2, "two unchanged wakes");
+        expect(wake(scheduler, history, 1, battery(80)).minutes == 120, "3 unchanged: 2x");
+        for (int i = 0; i < 8; i++) {
+            wake(scheduler, history, 1, battery(80));
+        }
+        expect(wake(scheduler, history, 1, battery(80)).minutes == 240, "12 unchanged: capped at 4x");
+        expect(wake(scheduler, history, 2, battery(80)).minutes == 60, "change: back to configured");
+    }
+    {
+        scenario("Data changes every wake: interval halved");
+        SleepScheduler scheduler(bounds(60));
+        SleepScheduler::History history;
+        SleepScheduler::reset(history);
+        SleepScheduler::Decision decision = {0, nullptr};
+        for (uint32_t data = 1; data <= 5; data++) {
+            decision = wake(scheduler, history, data, battery(80));
+        }
+        expect(decision.minutes == 30, "halved");
+        wake(scheduler, history, 5, battery(80));
+        expect(wake(scheduler, history, 5, battery(80)).minutes == 60, "2 of the last 4 changed: configured");
+    }
+    {
+        scenario("Battery: charging, low, critical, no gauge");
+        SleepScheduler scheduler(bounds(120));
+        expect(decide(scheduler, battery(50)).minutes == 120, "discharging: configured");
+        expect(decide(scheduler, battery(50, 4.0f)).minutes == 60, "charging: halved");
+        expect(decide(scheduler, battery(15)).minutes == 240, "low: doubled");
+        expect(decide(scheduler, battery(15, 2.0f)).minutes == 60, "charging wins over low");
+        expect(decide(scheduler, battery(8)).minutes == SLEEP_MAX_MINUTES, "critical: maximum");
+        SleepScheduler::Inputs noGauge = battery(8);
+        noGauge.gaugePresent = false;
+        expect(decide(scheduler, noGauge).minutes == 120, "no gauge: battery ignored");
+    }
+    {
+        scenario("Bounds");
+        SleepScheduler scheduler(bounds(20));
+        expect(decide(scheduler, battery(50, 4.0f)).minutes == SLEEP_MIN_MINUTES, "halved to the minimum");
+        SleepScheduler::Bounds b = bounds(60);
+        b.maxMinutes = 90;
+        SleepScheduler capped(b);
+        SleepScheduler::History history;
+        SleepScheduler::reset(history);
+        for (int i = 0; i < 12; i++) {
+            SleepScheduler::record(history, 1);
+        }
+        expect(wake(capped, history, 1, battery(50)).minutes == 90, "stretch capped at the maximum");
+    }
+    {
+        scenario("Quiet hours 22-7");
+        SleepScheduler scheduler(bounds(60, 22, 7));
+        expect(decide(scheduler, battery(80, -0.5f, 20 * 60)).minutes == 60, "20:00: wake at 21:00");
+        expect(decide(scheduler, battery(80, -0.5f, 21 * 60 + 30)).minutes == 570, "21:30: sleep until 07:00");
+        expect(decide(scheduler, battery(80, -0.5f, 2 * 60)).minutes == 300, "02:00: until 07:00");
+        expect(decide(scheduler, battery(80, -0.5f, 6 * 60 + 30)).minutes == 60, "06:30: wake at 07:30");
+        expect(decide(scheduler, battery(80, -0.5f)).minutes == 60, "clock not set: ignored");
+        SleepScheduler::Bounds b = bounds(60, 22, 7);
+        b.maxMinutes = 240;
+        SleepScheduler capped(b);
+        expect(decide(capped, battery(80, -0.5f, 21 * 60 + 30)).minutes == 240, "capped at the maximum");
+        SleepScheduler day(bounds(60, 9, 17));
+        expect(decide(day, battery(80, -0.5f, 8 * 60 + 30)).minutes == 510, "daytime window 9-17");
+    }
+    {
+        scenario("One week: publisher updates every 2 h from 08:00 to 20:00, quiet hours 23-6");
+        SleepScheduler scheduler(bounds(60, 23, 6));
+        SleepScheduler::History history;
+        SleepScheduler::reset(history);
+        int wakes = 0, changed = 0;
+        uint32_t last = 0;
+        for (int minute = 0; minute < 7 * 24 * 60; wakes++) {
+            int day = minute / (24 * 60);
+            int minuteOfDay = minute % (24 * 60);
+            int hour = minuteOfDay / 60;
+            int slot = hour < 8 ? -1 : (hour > 20 ? 6 : (hour - 8) / 2);
+            uint32_t data = slot < 0 ? (uint32_t)(day * 8) : (uint32_t)(day * 8 + slot + 1);
+            changed += data != last;
+            last = data;
+            SleepScheduler::record(history, data);
+            minute += scheduler.decide(battery(80, -0.5f, minuteOfDay), history).minutes;
+        }
+        printf("  %d wakes (%.1f per day, %d with new data), fixed 1 h interval: %d\n",
+               wakes, wakes / 7.0, changed, 7 * 24);
+        expect(changed == 7 * 8 - 1, "every update seen");
+        expect(wakes < 7 * 24 * 3 / 4, "fewer than 3/4 of the fixed-interval wakes");
+    }
+    
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}